@@ -0,0 +1,146 @@
+#!/bin/sh
+# generates the workloads of the benchmark suite into the target
+# directory (bench/build by default), the scale multiplies the
+# amount of work of the loops and the number of straight line
+# blocks sets the size of the assembler workload
+
+target=${1:-bench/build}
+scale=${2:-1}
+blocks=${3:-100000}
+
+mkdir -p "$target" || exit 1
+
+# tight arithmetic loop over the stack, counting down while
+# adding and subtracting (fused into superinstructions)
+cat > "$target/arith.mia" << EOT
+; tight arithmetic loop over the stack
+loadi $((10000000 * scale))
+
+start:
+    loadi 0
+    cmp 1
+    jeq end
+
+    loadi 3
+    add
+    loadi 4
+    sub
+    jmp start
+
+end:
+    pop
+EOT
+
+# deep recursion, each repetition descends one thousand calls
+# before returning all the way up (call and return heavy)
+cat > "$target/recurse.mia" << EOT
+; deep call and return recursion
+.text
+rloadi r2 $((10000 * scale))
+
+outer:
+    rloadi r1 1000
+    call descend 0
+    rsubi r2 1
+    rjnz r2 outer
+    halt
+
+descend:
+    rjnz r1 deeper
+    ret
+
+deeper:
+    rsubi r1 1
+    call descend 0
+    ret
+EOT
+
+# branch heavy loop, alternating between two paths on every
+# iteration so that both directions of the branches are taken
+cat > "$target/branch.mia" << EOT
+; branch heavy loop with alternating paths
+.text
+rloadi r1 $((5000000 * scale))
+rloadi r2 0
+rloadi r3 0
+
+loop:
+    rjnz r2 odd
+    raddi r3 3
+    rloadi r2 1
+    jmp next
+
+odd:
+    rsubi r3 1
+    rloadi r2 0
+
+next:
+    rsubi r1 1
+    rjnz r1 loop
+    rprint r3
+    halt
+EOT
+
+# print heavy loop, printing the counter and a string on every
+# iteration (output path throughput)
+cat > "$target/print.mia" << EOT
+; print heavy loop with integers and strings
+.data
+    message: db "Mingus benchmark output line"
+
+.text
+loadi $((2000000 * scale))
+
+start:
+    loadi 0
+    cmp 1
+    jeq end
+
+    print
+    load message
+    prints
+    pop
+
+    loadi 1
+    sub
+    jmp start
+
+end:
+    pop
+EOT
+
+# huge straight line program (no branches) used to measure the
+# throughput of the assembler, each block has four instructions
+awk -v blocks="$blocks" 'BEGIN {
+    print "; straight line program for assembler throughput"
+    for(block = 0; block < blocks; block++) {
+        printf "loadi %d\nloadi %d\nadd\npop\n", block % 1000, block % 7
+    }
+    print "halt"
+}' > "$target/straight.mia"
+
+# mixed program with comments, data elements, labels (forward and
+# backward references) and most of the mnemonics, used to measure
+# the throughput of the assembler on a representative input
+awk -v blocks="$blocks" 'BEGIN {
+    print "; mixed program for assembler throughput"
+    print ".data"
+    for(block = 0; block < 64; block++) {
+        printf "    message%d: db \"Mingus assembler message %d\" 10\n", block, block
+    }
+    print ".text"
+    print "rloadi r0 0"
+    for(block = 0; block < blocks; block++) {
+        printf "; block %d, never taken branches in both directions\n", block
+        printf "block%d:\n", block
+        printf "    rloadi r1 %d ; counter of the block\n", block % 1000
+        printf "    raddi r1 1\n"
+        printf "    rjnz r0 block%d\n", (block > 0 ? block - 1 : 0)
+        printf "    rjnz r1 next%d\n", block
+        printf "    rsubi r1 1\n"
+        printf "next%d:\n", block
+        printf "    rload r2 message%d\n", block % 64
+        printf "    loadi %d\n    loadi 7\n    add\n    pop\n", block % 1000
+    }
+    print "halt"
+}' > "$target/mixed.mia"
@@ -0,0 +1,234 @@
+/*
+ Mingus Virtual Machine
+ Copyright (c) 2008-2020 Hive Solutions Lda.
+
+ This file is part of Mingus Virtual Machine.
+
+ Mingus Virtual Machine is free software: you can redistribute it and/or modify
+ it under the terms of the Apache License as published by the Apache
+ Foundation, either version 2.0 of the License, or (at your option) any
+ later version.
+
+ Mingus Virtual Machine is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ Apache License for more details.
+
+ You should have received a copy of the Apache License along with
+ Mingus Virtual Machine. If not, see <http://www.apache.org/licenses/>.
+
+ __author__    = João Magalhães <joamag@hive.pt>
+ __version__   = 1.0.0
+ __revision__  = $LastChangedRevision$
+ __date__      = $LastChangedDate$
+ __copyright__ = Copyright (c) 2008-2020 João Magalhães
+ __license__   = Apache License, Version 2.0
+*/
+
+#include "stdafx.h"
+
+#include "mingus.h"
+#include "cache.h"
+
+#include <sys/stat.h>
+
+#ifndef _WIN32
+#define CACHE_LOCK(cache) pthread_mutex_lock(&cache->mutex)
+#define CACHE_UNLOCK(cache) pthread_mutex_unlock(&cache->mutex)
+#else
+#define CACHE_LOCK(cache)
+#define CACHE_UNLOCK(cache)
+#endif
+
+/**
+ * The nanoseconds of the modification time of the file
+ * described by the given stat information (if available).
+ */
+#if defined(__APPLE__)
+#define CACHE_MTIME_NSEC(information) ((long) (information).st_mtimespec.tv_nsec)
+#elif !defined(_WIN32)
+#define CACHE_MTIME_NSEC(information) ((long) (information).st_mtim.tv_nsec)
+#else
+#define CACHE_MTIME_NSEC(information) 0L
+#endif
+
+/**
+ * Verifies if the file described by the given stat information
+ * is the same (unchanged) file that was loaded into the entry.
+ */
+#define CACHE_SAME(entry, information) ((entry)->device == (unsigned long long) (information).st_dev &&\
+    (entry)->inode == (unsigned long long) (information).st_ino &&\
+    (entry)->mtime == (information).st_mtime && (entry)->mtime_nsec == CACHE_MTIME_NSEC(information) &&\
+    (entry)->size == (size_t) (information).st_size)
+
+static struct cache_entry_t *cache_find(struct cache_t *cache, char *path) {
+    struct cache_entry_t *entry;
+    get_value_string_hash_map(cache->map, (unsigned char *) path, (void **) &entry);
+    return entry;
+}
+
+static void cache_set(struct cache_entry_t *entry, struct stat *information, time_t now) {
+    entry->device = (unsigned long long) information->st_dev;
+    entry->inode = (unsigned long long) information->st_ino;
+    entry->mtime = information->st_mtime;
+    entry->mtime_nsec = CACHE_MTIME_NSEC(*information);
+    entry->size = (size_t) information->st_size;
+    entry->checked = now;
+}
+
+ERROR_CODE mingus_cache_create(struct cache_t **cache_pointer, unsigned char fuse) {
+    /* allocates the cache structure and populates
+    it with the default (empty) values */
+    struct cache_t *cache = (struct cache_t *) MALLOC(sizeof(struct cache_t));
+    if(cache == NULL) {
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem allocating cache"
+        );
+    }
+    if(IS_ERROR_CODE(create_hash_map(&cache->map, 0))) {
+        FREE(cache);
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem allocating cache"
+        );
+    }
+    cache->entries = NULL;
+    cache->count = 0;
+    cache->fuse = fuse;
+    cache->interval = MINGUS_CACHE_INTERVAL;
+    cache->hits = 0;
+    cache->misses = 0;
+#ifndef _WIN32
+    pthread_mutex_init(&cache->mutex, NULL);
+#endif
+
+    /* sets the cache in the pointer and returns with no error */
+    *cache_pointer = cache;
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE mingus_cache_delete(struct cache_t *cache) {
+    /* allocates space for the entry being released
+    and for the one that follows it */
+    struct cache_entry_t *entry;
+    struct cache_entry_t *next;
+
+    /* releases the references to the modules and the paths
+    of the complete set of entries and then the cache */
+    for(entry = cache->entries; entry != NULL; entry = next) {
+        next = entry->next;
+        mingus_module_release(entry->module);
+        FREE(entry->path);
+        FREE(entry);
+    }
+    delete_hash_map(cache->map);
+#ifndef _WIN32
+    pthread_mutex_destroy(&cache->mutex);
+#endif
+    FREE(cache);
+
+    /* returns with no error */
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE mingus_cache_get(struct cache_t *cache, char *path, struct module_t **module_pointer) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* allocates space for the length of the path, for the
+    information on the file and for the new module values */
+    size_t length;
+    time_t now = time(NULL);
+    struct stat information;
+    struct cache_entry_t *entry;
+    struct module_t *module;
+
+    /* tries to find the entry for the path, in case it's found
+    and it has been verified within the interval returns its
+    module with a new reference (no file system access) */
+    CACHE_LOCK(cache);
+    entry = cache_find(cache, path);
+    if(entry != NULL && now - entry->checked < cache->interval) {
+        *module_pointer = mingus_module_retain(entry->module);
+        cache->hits++;
+        CACHE_UNLOCK(cache);
+        RAISE_NO_ERROR;
+    }
+    CACHE_UNLOCK(cache);
+
+    /* retrieves the information on the file, that is used to
+    verify if the cached module is still valid */
+    if(stat(path, &information) != 0) {
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem accessing file %s",
+            path
+        );
+    }
+
+    /* in case the file is unchanged returns the module of the
+    entry with a new reference (no file read or decoding), the
+    entry is looked up again as the lock has been released */
+    CACHE_LOCK(cache);
+    entry = cache_find(cache, path);
+    if(entry != NULL && CACHE_SAME(entry, information)) {
+        entry->checked = now;
+        *module_pointer = mingus_module_retain(entry->module);
+        cache->hits++;
+        CACHE_UNLOCK(cache);
+        RAISE_NO_ERROR;
+    }
+    CACHE_UNLOCK(cache);
+
+    /* maps the file and creates the module from it (with no
+    lock held), the mapping is released with the module */
+    return_value = mingus_module_map(&module, path, cache->fuse);
+    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+
+    /* looks up the entry again, in case another thread has loaded
+    the same file in the meantime its module is kept (and the new
+    one released), otherwise the outdated module is replaced,
+    states using it keep it valid */
+    CACHE_LOCK(cache);
+    entry = cache_find(cache, path);
+    if(entry != NULL && CACHE_SAME(entry, information)) {
+        mingus_module_release(module);
+        entry->checked = now;
+        *module_pointer = mingus_module_retain(entry->module);
+        cache->hits++;
+        CACHE_UNLOCK(cache);
+        RAISE_NO_ERROR;
+    }
+    if(entry == NULL) {
+        length = strlen(path);
+        entry = (struct cache_entry_t *) MALLOC(sizeof(struct cache_entry_t));
+        if(entry != NULL) { entry->path = (char *) MALLOC(length + 1); }
+        if(entry == NULL || entry->path == NULL) {
+            if(entry != NULL) { FREE(entry); }
+            CACHE_UNLOCK(cache);
+            mingus_module_release(module);
+            RAISE_ERROR_M(
+                RUNTIME_EXCEPTION_ERROR_CODE,
+                (unsigned char *) "Problem allocating cache entry"
+            );
+        }
+        memcpy(entry->path, path, length + 1);
+        entry->next = cache->entries;
+        cache->entries = entry;
+        cache->count++;
+        set_value_string_hash_map(cache->map, (unsigned char *) entry->path, (void *) entry);
+    } else {
+        mingus_module_release(entry->module);
+    }
+    cache_set(entry, &information, now);
+    entry->module = module;
+    cache->misses++;
+
+    /* returns the module with a new reference, the
+    cache keeps its own reference to it */
+    *module_pointer = mingus_module_retain(module);
+    CACHE_UNLOCK(cache);
+    RAISE_NO_ERROR;
+}
@@ -0,0 +1,150 @@
+/*
+ Mingus Virtual Machine
+ Copyright (c) 2008-2020 Hive Solutions Lda.
+
+ This file is part of Mingus Virtual Machine.
+
+ Mingus Virtual Machine is free software: you can redistribute it and/or modify
+ it under the terms of the Apache License as published by the Apache
+ Foundation, either version 2.0 of the License, or (at your option) any
+ later version.
+
+ Mingus Virtual Machine is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ Apache License for more details.
+
+ You should have received a copy of the Apache License along with
+ Mingus Virtual Machine. If not, see <http://www.apache.org/licenses/>.
+
+ __author__    = João Magalhães <joamag@hive.pt>
+ __version__   = 1.0.0
+ __revision__  = $LastChangedRevision$
+ __date__      = $LastChangedDate$
+ __copyright__ = Copyright (c) 2008-2020 João Magalhães
+ __license__   = Apache License, Version 2.0
+*/
+
+#pragma once
+
+#include <time.h>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+/**
+ * Structure describing an entry of the module cache,
+ * the module loaded from a path, the values used to
+ * detect changes in the file (device, inode, modification
+ * time in nanoseconds and size) and the time of the last
+ * verification of the file.
+ */
+typedef struct cache_entry_t {
+    char *path;
+    unsigned long long device;
+    unsigned long long inode;
+    time_t mtime;
+    long mtime_nsec;
+    size_t size;
+    time_t checked;
+    struct module_t *module;
+    struct cache_entry_t *next;
+} cache_entry;
+
+/**
+ * Structure describing a (path keyed) cache of loaded
+ * modules, so that the modules are shared by all the
+ * states instead of being read and decoded each time.
+ */
+typedef struct cache_t {
+    /**
+     * The map associating the path of each entry with the
+     * entry, used for the lookups.
+     */
+    struct hash_map_t *map;
+
+    /**
+     * The (linked) list of entries in the cache, used to
+     * release all of them once the cache is deleted.
+     */
+    struct cache_entry_t *entries;
+
+    /**
+     * The number of entries currently in the cache.
+     */
+    size_t count;
+
+    /**
+     * If the fusion pass should be run on the modules
+     * loaded by the cache.
+     */
+    unsigned char fuse;
+
+    /**
+     * The minimum interval (in seconds) between verifications
+     * of the file of an entry, avoiding a file system access
+     * for each lookup (zero verifies on every lookup).
+     */
+    time_t interval;
+
+    /**
+     * The number of lookups served from the cache and
+     * the number of lookups that (re)loaded the module.
+     */
+    unsigned long long hits;
+    unsigned long long misses;
+
+#ifndef _WIN32
+    /**
+     * The mutex protecting the cache, so that it may be
+     * used from multiple threads, it's not held while a
+     * file is read and decoded (only for the lookups).
+     */
+    pthread_mutex_t mutex;
+#endif
+} cache;
+
+/**
+ * The default interval (in seconds) between verifications
+ * of the files of the modules in the cache.
+ */
+#define MINGUS_CACHE_INTERVAL 1
+
+/**
+ * Creates a new (empty) module cache.
+ *
+ * @param cache_pointer The pointer to the cache to be created.
+ * @param fuse If the fusion pass should be run on the modules.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_cache_create(struct cache_t **cache_pointer, unsigned char fuse);
+
+/**
+ * Deletes the module cache, releasing the references to
+ * its modules (modules in use by states remain valid).
+ *
+ * @param cache The cache to be deleted.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_cache_delete(struct cache_t *cache);
+
+/**
+ * Retrieves the module for the provided path, the file is only
+ * (re)loaded in case it's not in the cache or in case it has
+ * changed (device, inode, modification time or size) since it
+ * was loaded, the file is verified at most once per interval.
+ *
+ * The file is loaded with no lock held, so that the lookups of
+ * other threads are never blocked by it, in case two threads
+ * load the same file the first module inserted is kept.
+ *
+ * The module is returned with a new reference that must be
+ * released by the caller (mingus_module_release).
+ *
+ * @param cache The module cache.
+ * @param path The path to the object file of the module.
+ * @param module_pointer The pointer to be set with the module.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_cache_get(struct cache_t *cache, char *path, struct module_t **module_pointer);
@@ -0,0 +1,252 @@
+/*
+ Mingus Virtual Machine
+ Copyright (c) 2008-2020 Hive Solutions Lda.
+
+ This file is part of Mingus Virtual Machine.
+
+ Mingus Virtual Machine is free software: you can redistribute it and/or modify
+ it under the terms of the Apache License as published by the Apache
+ Foundation, either version 2.0 of the License, or (at your option) any
+ later version.
+
+ Mingus Virtual Machine is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ Apache License for more details.
+
+ You should have received a copy of the Apache License along with
+ Mingus Virtual Machine. If not, see <http://www.apache.org/licenses/>.
+
+ __author__    = João Magalhães <joamag@hive.pt>
+ __version__   = 1.0.0
+ __revision__  = $LastChangedRevision$
+ __date__      = $LastChangedDate$
+ __copyright__ = Copyright (c) 2008-2020 João Magalhães
+ __license__   = Apache License, Version 2.0
+*/
+
+#include "stdafx.h"
+
+#include "mingus.h"
+#include "counters.h"
+
+static const char *counter_names[MINGUS_COUNTER_COUNT] = MINGUS_COUNTER_NAMES;
+
+#ifdef MINGUS_COUNTERS
+
+/**
+ * The type and configuration (perf_event_open) of each
+ * of the events, in the order of the events enumeration.
+ */
+static const unsigned int counter_types[MINGUS_COUNTER_COUNT] = {
+    PERF_TYPE_SOFTWARE,
+    PERF_TYPE_HARDWARE,
+    PERF_TYPE_HARDWARE,
+    PERF_TYPE_HARDWARE,
+    PERF_TYPE_HARDWARE,
+    PERF_TYPE_HARDWARE
+};
+static const unsigned long long counter_configs[MINGUS_COUNTER_COUNT] = {
+    PERF_COUNT_SW_TASK_CLOCK,
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_BRANCH_INSTRUCTIONS,
+    PERF_COUNT_HW_BRANCH_MISSES,
+    PERF_COUNT_HW_CACHE_MISSES
+};
+
+static unsigned char counter_user(struct perf_event_mmap_page *page, unsigned long long *value) {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    /* allocates space for the sequence of the page, for the
+    index of the hardware counter and for its value */
+    unsigned int sequence;
+    unsigned int index;
+    unsigned int low;
+    unsigned int high;
+    unsigned long long pmc;
+    long long count;
+
+    /* reads the hardware counter directly (rdpmc) adding it to
+    the offset kept by the kernel, retrying in case the page
+    is updated in between (the counter has been rescheduled) */
+    do {
+        sequence = page->lock;
+        __sync_synchronize();
+        index = page->index;
+        count = page->offset;
+        if(page->cap_user_rdpmc == 0 || index == 0) { return FALSE; }
+        __asm__ volatile("rdpmc" : "=a" (low), "=d" (high) : "c" (index - 1));
+        pmc = ((unsigned long long) high << 32 | low) << (64 - page->pmc_width);
+        count += (long long) pmc >> (64 - page->pmc_width);
+        __sync_synchronize();
+    } while(page->lock != sequence);
+    *value = (unsigned long long) count;
+    return TRUE;
+#else
+    return FALSE;
+#endif
+}
+
+ERROR_CODE mingus_counters_open(struct counters_t *counters) {
+    /* allocates space for the attributes of the counters, for
+    the index of the event and for the number of counters */
+    struct perf_event_attr attributes;
+    size_t index;
+    size_t count = 0;
+    void *page;
+
+    /* opens a (disabled) counter for each event measuring only
+    the user space of the current thread on any processor, the
+    events not supported by the host are left unavailable */
+    for(index = 0; index < MINGUS_COUNTER_COUNT; index++) {
+        memset(&attributes, 0, sizeof(struct perf_event_attr));
+        attributes.type = counter_types[index];
+        attributes.size = sizeof(struct perf_event_attr);
+        attributes.config = counter_configs[index];
+        attributes.disabled = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        counters->descriptors[index] = (int) syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0);
+        counters->pages[index] = NULL;
+        counters->starts[index] = 0;
+        counters->values[index] = 0;
+        if(counters->descriptors[index] < 0) { continue; }
+        count++;
+
+        /* maps the first page of the counter, used to read it
+        from user space (if allowed by the kernel) */
+        page = mmap(NULL, (size_t) sysconf(_SC_PAGESIZE), PROT_READ, MAP_SHARED, counters->descriptors[index], 0);
+        if(page != MAP_FAILED) { counters->pages[index] = page; }
+    }
+
+    /* in case none of the counters has been opened raises
+    an error (eg: not allowed by perf_event_paranoid) */
+    if(count == 0) {
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Performance counters not available"
+        );
+    }
+
+    /* returns with no error */
+    RAISE_NO_ERROR;
+}
+
+void mingus_counters_close(struct counters_t *counters) {
+    size_t index;
+    for(index = 0; index < MINGUS_COUNTER_COUNT; index++) {
+        if(counters->pages[index] != NULL) { munmap(counters->pages[index], (size_t) sysconf(_SC_PAGESIZE)); }
+        if(counters->descriptors[index] >= 0) { close(counters->descriptors[index]); }
+        counters->pages[index] = NULL;
+        counters->descriptors[index] = -1;
+    }
+}
+
+void mingus_counters_read(struct counters_t *counters, unsigned long long *values) {
+    /* allocates space for the index of the event and for the
+    value read from the counter (with its enabled and running
+    times, used to scale multiplexed counters) */
+    size_t index;
+    unsigned long long data[3];
+
+    /* reads each of the counters from user space when possible
+    and with a system call otherwise */
+    for(index = 0; index < MINGUS_COUNTER_COUNT; index++) {
+        values[index] = 0;
+        if(counters->descriptors[index] < 0) { continue; }
+        if(counters->pages[index] != NULL &&
+            counter_user((struct perf_event_mmap_page *) counters->pages[index], &values[index])) { continue; }
+        if(read(counters->descriptors[index], data, sizeof(data)) != sizeof(data)) { continue; }
+        values[index] = data[2] > 0 && data[2] < data[1] ?
+            (unsigned long long) ((double) data[0] * data[1] / data[2]) : data[0];
+    }
+}
+
+void mingus_counters_start(struct counters_t *counters) {
+    size_t index;
+    for(index = 0; index < MINGUS_COUNTER_COUNT; index++) {
+        if(counters->descriptors[index] < 0) { continue; }
+        ioctl(counters->descriptors[index], PERF_EVENT_IOC_ENABLE, 0);
+    }
+    mingus_counters_read(counters, counters->starts);
+}
+
+void mingus_counters_stop(struct counters_t *counters) {
+    size_t index;
+    mingus_counters_read(counters, counters->values);
+    for(index = 0; index < MINGUS_COUNTER_COUNT; index++) {
+        if(counters->descriptors[index] < 0) { continue; }
+        ioctl(counters->descriptors[index], PERF_EVENT_IOC_DISABLE, 0);
+        counters->values[index] -= counters->starts[index];
+    }
+}
+
+#else
+
+ERROR_CODE mingus_counters_open(struct counters_t *counters) {
+    RAISE_ERROR_M(
+        RUNTIME_EXCEPTION_ERROR_CODE,
+        (unsigned char *) "Performance counters not available"
+    );
+}
+
+void mingus_counters_close(struct counters_t *counters) {
+}
+
+void mingus_counters_read(struct counters_t *counters, unsigned long long *values) {
+    memset(values, 0, MINGUS_COUNTER_COUNT * sizeof(unsigned long long));
+}
+
+void mingus_counters_start(struct counters_t *counters) {
+}
+
+void mingus_counters_stop(struct counters_t *counters) {
+}
+
+#endif
+
+ERROR_CODE mingus_counters_report(struct counters_t *counters, unsigned long long instructions) {
+    /* allocates space for the index of the event and
+    for the values of the events used in the ratios */
+    size_t index;
+    unsigned long long *values = counters->values;
+
+    /* prints the total of each event and its value per executed
+    instruction, the count of instructions may be unknown (eg: the
+    program has not halted) and then only the totals are printed */
+    if(instructions > 0) { PRINTF_F("Counters (%llu instructions):\n", instructions); }
+    else { PRINTF_F("%s", "Counters:\n"); }
+    for(index = 0; index < MINGUS_COUNTER_COUNT; index++) {
+        if(!MINGUS_COUNTER_AVAILABLE(counters, index)) {
+            PRINTF_F("  %-14s %20s\n", counter_names[index], "n/a");
+        } else if(instructions > 0) {
+            PRINTF_F(
+                "  %-14s %20llu %12.3f/inst\n",
+                counter_names[index], values[index], (double) values[index] / instructions
+            );
+        } else {
+            PRINTF_F("  %-14s %20llu\n", counter_names[index], values[index]);
+        }
+    }
+
+    /* prints the ratios derived from the events, the native
+    instructions per cycle and the branch misprediction rate */
+    if(MINGUS_COUNTER_AVAILABLE(counters, MINGUS_CYCLES) &&
+        MINGUS_COUNTER_AVAILABLE(counters, MINGUS_INSTRUCTIONS) && values[MINGUS_CYCLES] > 0) {
+        PRINTF_F(
+            "  %-14s %20.3f\n", "ipc",
+            (double) values[MINGUS_INSTRUCTIONS] / values[MINGUS_CYCLES]
+        );
+    }
+    if(MINGUS_COUNTER_AVAILABLE(counters, MINGUS_BRANCHES) &&
+        MINGUS_COUNTER_AVAILABLE(counters, MINGUS_BRANCH_MISSES) && values[MINGUS_BRANCHES] > 0) {
+        PRINTF_F(
+            "  %-14s %19.3f%%\n", "branch-miss",
+            100.0 * values[MINGUS_BRANCH_MISSES] / values[MINGUS_BRANCHES]
+        );
+    }
+
+    /* returns with no error */
+    RAISE_NO_ERROR;
+}
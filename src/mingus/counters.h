@@ -0,0 +1,156 @@
+/*
+ Mingus Virtual Machine
+ Copyright (c) 2008-2020 Hive Solutions Lda.
+
+ This file is part of Mingus Virtual Machine.
+
+ Mingus Virtual Machine is free software: you can redistribute it and/or modify
+ it under the terms of the Apache License as published by the Apache
+ Foundation, either version 2.0 of the License, or (at your option) any
+ later version.
+
+ Mingus Virtual Machine is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ Apache License for more details.
+
+ You should have received a copy of the Apache License along with
+ Mingus Virtual Machine. If not, see <http://www.apache.org/licenses/>.
+
+ __author__    = João Magalhães <joamag@hive.pt>
+ __version__   = 1.0.0
+ __revision__  = $LastChangedRevision$
+ __date__      = $LastChangedDate$
+ __copyright__ = Copyright (c) 2008-2020 João Magalhães
+ __license__   = Apache License, Version 2.0
+*/
+
+#pragma once
+
+/**
+ * The hardware performance counters are only available
+ * under Linux (perf_event_open system call).
+ */
+#if defined(__linux__)
+#define MINGUS_COUNTERS
+#endif
+
+/**
+ * The number of events measured by the counters, the
+ * order of the events enumeration.
+ */
+#define MINGUS_COUNTER_COUNT 6
+
+/**
+ * The names of the events measured by the counters
+ * indexed by event, to be used by the reports.
+ */
+#define MINGUS_COUNTER_NAMES {\
+    "task-clock", "cycles", "instructions",\
+    "branches", "branch-misses", "cache-misses"\
+}
+
+/**
+ * The events measured by the counters, the task clock
+ * is a software event (nanoseconds) available even when
+ * there's no hardware counters (eg: virtual machines).
+ */
+typedef enum counter_e {
+    MINGUS_TASK_CLOCK = 0,
+    MINGUS_CYCLES,
+    MINGUS_INSTRUCTIONS,
+    MINGUS_BRANCHES,
+    MINGUS_BRANCH_MISSES,
+    MINGUS_CACHE_MISSES
+} counter;
+
+/**
+ * Structure describing the set of performance counters of
+ * the current thread, each event has its own counter that
+ * is set to unavailable in case it can't be opened.
+ */
+typedef struct counters_t {
+    /**
+     * The file descriptors of the counters of the events
+     * (negative for the unavailable ones).
+     */
+    int descriptors[MINGUS_COUNTER_COUNT];
+
+    /**
+     * The (memory mapped) pages of the counters used to read
+     * them from user space (rdpmc) with no system call, unset
+     * in case it's not possible (the counter is read).
+     */
+    void *pages[MINGUS_COUNTER_COUNT];
+
+    /**
+     * The values of the counters at the start of the
+     * measurement and the values measured (by the stop).
+     */
+    unsigned long long starts[MINGUS_COUNTER_COUNT];
+    unsigned long long values[MINGUS_COUNTER_COUNT];
+} counters;
+
+/**
+ * Opens the counters of the events for the current thread
+ * (user space only), the events not supported by the host
+ * are marked as unavailable, raising an error only if none
+ * of them may be opened.
+ *
+ * @param counters The counters to be opened.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_counters_open(struct counters_t *counters);
+
+/**
+ * Closes the counters, releasing their descriptors.
+ *
+ * @param counters The counters to be closed.
+ */
+void mingus_counters_close(struct counters_t *counters);
+
+/**
+ * Reads the current (running) values of the counters into
+ * the provided array, using user space reads when possible
+ * as this is used around every operation by the profiler.
+ *
+ * @param counters The counters to be read.
+ * @param values The array of values (one per event).
+ */
+void mingus_counters_read(struct counters_t *counters, unsigned long long *values);
+
+/**
+ * Starts the measurement, the values are measured from
+ * this point on (enabling the counters).
+ *
+ * @param counters The counters to be started.
+ */
+void mingus_counters_start(struct counters_t *counters);
+
+/**
+ * Stops the measurement, setting the values of the
+ * counters with the events since the start.
+ *
+ * @param counters The counters to be stopped.
+ */
+void mingus_counters_stop(struct counters_t *counters);
+
+/**
+ * Verifies if the counter of the event is available.
+ *
+ * @param counters The counters to be verified.
+ * @param event The event to be verified.
+ * @return If the counter of the event is available.
+ */
+#define MINGUS_COUNTER_AVAILABLE(counters, event) ((counters)->descriptors[event] >= 0)
+
+/**
+ * Prints the report of the measured values, the total of
+ * each event and its value per executed (bytecode)
+ * instruction plus the derived ratios (eg: IPC).
+ *
+ * @param counters The (stopped) counters to be reported.
+ * @param instructions The number of executed instructions.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_counters_report(struct counters_t *counters, unsigned long long instructions);
@@ -0,0 +1,620 @@
+/*
+ Mingus Virtual Machine
+ Copyright (c) 2008-2020 Hive Solutions Lda.
+
+ This file is part of Mingus Virtual Machine.
+
+ Mingus Virtual Machine is free software: you can redistribute it and/or modify
+ it under the terms of the Apache License as published by the Apache
+ Foundation, either version 2.0 of the License, or (at your option) any
+ later version.
+
+ Mingus Virtual Machine is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ Apache License for more details.
+
+ You should have received a copy of the Apache License along with
+ Mingus Virtual Machine. If not, see <http://www.apache.org/licenses/>.
+
+ __author__    = João Magalhães <joamag@hive.pt>
+ __version__   = 1.0.0
+ __revision__  = $LastChangedRevision$
+ __date__      = $LastChangedDate$
+ __copyright__ = Copyright (c) 2008-2020 João Magalhães
+ __license__   = Apache License, Version 2.0
+*/
+
+#include "stdafx.h"
+
+#include "mingus.h"
+#include "jit.h"
+
+#ifdef MINGUS_JIT_AVAILABLE
+
+#include <stddef.h>
+#include <sys/mman.h>
+
+#define JIT_STATE_OFFSET(field) ((unsigned int) offsetof(struct state_t, field))
+#define JIT_REGISTER_OFFSET(index) (JIT_STATE_OFFSET(registers) + (unsigned int) (index) * sizeof(unsigned int))
+
+static void jit_byte(struct jit_t *jit, unsigned char value) {
+    jit->buffer[jit->offset++] = value;
+}
+
+static void jit_bytes(struct jit_t *jit, const char *values, size_t size) {
+    memcpy(&jit->buffer[jit->offset], values, size);
+    jit->offset += size;
+}
+
+static void jit_int(struct jit_t *jit, unsigned int value) {
+    memcpy(&jit->buffer[jit->offset], &value, sizeof(unsigned int));
+    jit->offset += sizeof(unsigned int);
+}
+
+static void jit_pointer(struct jit_t *jit, void *value) {
+    memcpy(&jit->buffer[jit->offset], &value, sizeof(void *));
+    jit->offset += sizeof(void *);
+}
+
+static void jit_rel32(struct jit_t *jit, size_t target) {
+    /* writes the displacement from the end of the
+    current rel32 field into the target offset */
+    jit_int(jit, (unsigned int) (target - (jit->offset + 4)));
+}
+
+static void jit_patch(struct jit_t *jit, size_t offset) {
+    /* patches the rel32 field at the given offset so that it
+    points to the current offset (forward branch) */
+    unsigned int displacement = (unsigned int) (jit->offset - (offset + 4));
+    memcpy(&jit->buffer[offset], &displacement, sizeof(unsigned int));
+}
+
+static void jit_branch(struct jit_t *jit, unsigned int target) {
+    /* registers the rel32 displacement that is about to
+    be emitted for patching and then reserves its space */
+    jit->fixups[jit->fixup_count].offset = jit->offset;
+    jit->fixups[jit->fixup_count].target = target;
+    jit->fixup_count++;
+    jit_int(jit, 0);
+}
+
+static void jit_print(struct state_t *state, unsigned int value) {
+    mingus_print(state, (int) value);
+}
+
+static int jit_prints(struct state_t *state, unsigned int value) {
+    if(!MINGUS_STRING(state, value)) { return 1; }
+    mingus_prints(state, (char *) state->globals[value]);
+    return 0;
+}
+
+static void jit_call(struct jit_t *jit, void *function) {
+    /* mov rdi, r14 ; mov esi, [r12 - 4] (the top of the
+    stack) and then mov rax, imm64 ; call rax */
+    jit_bytes(jit, "\x4c\x89\xf7", 3);
+    jit_bytes(jit, "\x41\x8b\x74\x24\xfc", 5);
+    jit_bytes(jit, "\x48\xb8", 2);
+    jit_pointer(jit, function);
+    jit_bytes(jit, "\xff\xd0", 2);
+}
+
+static void jit_sync(struct jit_t *jit) {
+    /* writes the stack offsets back into the state, computed
+    from the top pointers: mov rax, r12 ; sub rax, rbx ;
+    shr rax, 2 ; mov [r14 + so], eax ; mov rax, r13 ;
+    sub rax, [r14 + call_stack] ; shr rax, 2 ; mov [r14 + cso], eax */
+    jit_bytes(jit, "\x4c\x89\xe0\x48\x29\xd8\x48\xc1\xe8\x02", 10);
+    jit_bytes(jit, "\x41\x89\x86", 3);
+    jit_int(jit, JIT_STATE_OFFSET(so));
+    jit_bytes(jit, "\x4c\x89\xe8\x49\x2b\x86", 6);
+    jit_int(jit, JIT_STATE_OFFSET(call_stack));
+    jit_bytes(jit, "\x48\xc1\xe8\x02", 4);
+    jit_bytes(jit, "\x41\x89\x86", 3);
+    jit_int(jit, JIT_STATE_OFFSET(cso));
+}
+
+static void jit_global(struct jit_t *jit, int index) {
+    /* mov rcx, [r14 + globals] ; mov [rcx + index * 8], rax */
+    jit_bytes(jit, "\x49\x8b\x8e", 3);
+    jit_int(jit, JIT_STATE_OFFSET(globals));
+    jit_bytes(jit, "\x48\x89\x81", 3);
+    jit_int(jit, (unsigned int) index * sizeof(size_t));
+}
+
+static void jit_register(struct jit_t *jit, const char *prefix, unsigned char index) {
+    /* emits the instruction prefix (rex, opcode and modrm) for
+    a [r14 + disp32] operand followed by the register offset */
+    jit_bytes(jit, prefix, 3);
+    jit_int(jit, JIT_REGISTER_OFFSET(index));
+}
+
+static void jit_call_register(struct jit_t *jit, void *function, unsigned char index) {
+    /* mov rdi, r14 ; mov esi, [r14 + ra] and then
+    mov rax, imm64 ; call rax */
+    jit_bytes(jit, "\x4c\x89\xf7", 3);
+    jit_register(jit, "\x41\x8b\xb6", index);
+    jit_bytes(jit, "\x48\xb8", 2);
+    jit_pointer(jit, function);
+    jit_bytes(jit, "\xff\xd0", 2);
+}
+
+ERROR_CODE mingus_jit_compile(struct state_t *state, struct jit_t *jit) {
+    /* allocates space for the index of the operation being
+    compiled and for the pointer to the operation itself */
+    unsigned int index;
+    struct operation_t *operation;
+
+    /* allocates space for the offsets of the shared code
+    blocks (epilogue, exit and error stubs) */
+    size_t epilogue;
+    size_t leave;
+    size_t error;
+    size_t overflow;
+    size_t invalid;
+
+    /* allocates space for the offsets of the (forward) branches
+    of a call into its overflow block */
+    size_t stack_check;
+    size_t call_check;
+
+    /* unsets the references in the structure so that it
+    may be safely released in case of error */
+    jit->buffer = NULL;
+    jit->natives = NULL;
+    jit->fixups = NULL;
+
+    /* calculates the size of the buffer for the native code,
+    rounding it to the page size and maps it (writable only) */
+    jit->count = state->header.code_count;
+    jit->size = MINGUS_JIT_BASE_SIZE + jit->count * MINGUS_JIT_OPERATION_SIZE;
+    jit->size = (jit->size + 4095) & ~((size_t) 4095);
+    jit->offset = 0;
+    jit->buffer = (unsigned char *) mmap(
+        NULL, jit->size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
+    );
+    if(jit->buffer == (unsigned char *) MAP_FAILED) {
+        jit->buffer = NULL;
+        MINGUS_RAISE_M(
+            state,
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem mapping JIT buffer"
+        );
+    }
+
+    /* allocates the table of native addresses and the list of
+    fixups (at most two branches per operation) */
+    jit->natives = (void **) MALLOC((jit->count + 1) * sizeof(void *));
+    jit->fixups = (struct jit_fixup_t *) MALLOC(2 * (jit->count + 1) * sizeof(struct jit_fixup_t));
+    jit->fixup_count = 0;
+
+    /* prologue: saves the callee saved registers and loads
+    r14 = state, r15 = natives, rbx = stack base, r12 = stack
+    top and r13 = call stack top, then jumps into the native
+    code of the current program counter */
+    jit_bytes(jit, "\x53\x41\x54\x41\x55\x41\x56\x41\x57", 9);
+    jit_bytes(jit, "\x49\x89\xfe", 3);
+    jit_bytes(jit, "\x49\x89\xf7", 3);
+    jit_bytes(jit, "\x49\x8b\x9e", 3);
+    jit_int(jit, JIT_STATE_OFFSET(stack));
+    jit_bytes(jit, "\x41\x8b\x86", 3);
+    jit_int(jit, JIT_STATE_OFFSET(so));
+    jit_bytes(jit, "\x4c\x8d\x24\x83", 4);
+    jit_bytes(jit, "\x4d\x8b\xae", 3);
+    jit_int(jit, JIT_STATE_OFFSET(call_stack));
+    jit_bytes(jit, "\x41\x8b\x86", 3);
+    jit_int(jit, JIT_STATE_OFFSET(cso));
+    jit_bytes(jit, "\x4d\x8d\x6c\x85\x00", 5);
+    jit_bytes(jit, "\x41\x8b\x86", 3);
+    jit_int(jit, JIT_STATE_OFFSET(pc));
+    jit_bytes(jit, "\x41\xff\x24\xc7", 4);
+
+    /* epilogue: writes the stack offsets back into the state,
+    unsets the running flag and returns with no error */
+    epilogue = jit->offset;
+    jit_sync(jit);
+    jit_bytes(jit, "\x41\xc6\x86", 3);
+    jit_int(jit, JIT_STATE_OFFSET(running));
+    jit_byte(jit, FALSE);
+    jit_bytes(jit, "\x31\xc0", 2);
+
+    /* exit: restores the callee saved registers and returns
+    the value currently set in the eax register */
+    leave = jit->offset;
+    jit_bytes(jit, "\x41\x5f\x41\x5e\x41\x5d\x41\x5c\x5b\xc3", 10);
+
+    /* error stub: used for invalid (dynamic) program counter
+    values, returns a non zero value (error) */
+    error = jit->offset;
+    jit_byte(jit, 0xb8);
+    jit_int(jit, 1);
+    jit_byte(jit, 0xe9);
+    jit_rel32(jit, leave);
+
+    /* overflow stub: used when the stacks are not able to hold
+    a new frame (with the program counter set at the call), writes
+    the stack offsets back into the state (the running flag is
+    kept) and returns the overflow value, so that the stacks are
+    grown and the native code re-entered at the call */
+    overflow = jit->offset;
+    jit_sync(jit);
+    jit_byte(jit, 0xb8);
+    jit_int(jit, 2);
+    jit_byte(jit, 0xe9);
+    jit_rel32(jit, leave);
+
+    /* invalid stub: used when a string print references a value
+    that is not a string, writes the stack offsets back into the
+    state and returns the invalid reference value */
+    invalid = jit->offset;
+    jit_sync(jit);
+    jit_byte(jit, 0xb8);
+    jit_int(jit, 3);
+    jit_byte(jit, 0xe9);
+    jit_rel32(jit, leave);
+
+    /* iterates over the complete set of operations emitting
+    the native code template for each of them */
+    for(index = 0; index < jit->count; index++) {
+        operation = &state->operations[index];
+        jit->natives[index] = &jit->buffer[jit->offset];
+
+        switch(operation->opcode) {
+            case HALT:
+                /* mov dword [r14 + pc], index + 1 ; jmp epilogue */
+                jit_bytes(jit, "\x41\xc7\x86", 3);
+                jit_int(jit, JIT_STATE_OFFSET(pc));
+                jit_int(jit, index + 1);
+                jit_byte(jit, 0xe9);
+                jit_rel32(jit, epilogue);
+                break;
+
+            case LOAD:
+            case LOADI:
+                /* mov dword [r12], imm32 ; add r12, 4 */
+                jit_bytes(jit, "\x41\xc7\x04\x24", 4);
+                jit_int(jit, (unsigned int) operation->operand);
+                jit_bytes(jit, "\x49\x83\xc4\x04", 4);
+                break;
+
+            case STORE:
+                /* sub r12, 4 ; mov eax, [r12] ;
+                mov [r14 + globals + operand * 8], rax */
+                jit_bytes(jit, "\x49\x83\xec\x04\x41\x8b\x04\x24", 8);
+                jit_global(jit, operation->operand);
+                break;
+
+            case ADD:
+                /* sub r12, 4 ; mov eax, [r12] ; add [r12 - 4], eax */
+                jit_bytes(jit, "\x49\x83\xec\x04\x41\x8b\x04\x24", 8);
+                jit_bytes(jit, "\x41\x01\x44\x24\xfc", 5);
+                break;
+
+            case SUB:
+                /* sub r12, 4 ; mov eax, [r12] ; sub [r12 - 4], eax */
+                jit_bytes(jit, "\x49\x83\xec\x04\x41\x8b\x04\x24", 8);
+                jit_bytes(jit, "\x41\x29\x44\x24\xfc", 5);
+                break;
+
+            case POP:
+                /* sub r12, 4 */
+                jit_bytes(jit, "\x49\x83\xec\x04", 4);
+                break;
+
+            case CMP:
+                /* mov eax, [r12 - 4] ; xor ecx, ecx ; cmp [r12 - 8], eax ;
+                setcc cl ; mov [r12 - 4], ecx (replaces second operand) */
+                jit_bytes(jit, "\x41\x8b\x44\x24\xfc\x31\xc9", 7);
+                if(operation->arg1 == 1 || operation->arg1 == 2) {
+                    jit_bytes(jit, "\x41\x39\x44\x24\xf8", 5);
+                    jit_bytes(jit, operation->arg1 == 1 ? "\x0f\x94\xc1" : "\x0f\x95\xc1", 3);
+                }
+                jit_bytes(jit, "\x41\x89\x4c\x24\xfc", 5);
+                break;
+
+            case JMP:
+            case JMP_ABS:
+                /* jmp rel32 */
+                jit_byte(jit, 0xe9);
+                jit_branch(jit, (unsigned int) operation->operand);
+                break;
+
+            case JMP_EQ:
+            case JMP_NEQ:
+                /* sub r12, 4 ; cmp dword [r12], 1 (or 0) ; je rel32 */
+                jit_bytes(jit, "\x49\x83\xec\x04\x41\x83\x3c\x24", 8);
+                jit_byte(jit, operation->opcode == JMP_EQ ? 1 : 0);
+                jit_bytes(jit, "\x0f\x84", 2);
+                jit_branch(jit, (unsigned int) operation->operand);
+                break;
+
+            case CALL:
+                /* verifies that the stacks (as currently grown) hold
+                the stack depth of the function and the new frame:
+                lea rax, [r12 + reserve * 4] ; sub rax, rbx ; shr rax, 2 ;
+                cmp eax, [r14 + stack_size] ; ja grow ; mov rax, r13 ;
+                sub rax, [r14 + call_stack] ; shr rax, 2 ; add eax, 3 ;
+                cmp eax, [r14 + call_size] ; ja grow */
+                jit_bytes(jit, "\x49\x8d\x84\x24", 4);
+                jit_int(jit, MINGUS_RESERVE(operation) * sizeof(unsigned int));
+                jit_bytes(jit, "\x48\x29\xd8\x48\xc1\xe8\x02\x41\x3b\x86", 10);
+                jit_int(jit, JIT_STATE_OFFSET(stack_size));
+                jit_bytes(jit, "\x0f\x87", 2);
+                stack_check = jit->offset;
+                jit_int(jit, 0);
+                jit_bytes(jit, "\x4c\x89\xe8\x49\x2b\x86", 6);
+                jit_int(jit, JIT_STATE_OFFSET(call_stack));
+                jit_bytes(jit, "\x48\xc1\xe8\x02\x83\xc0", 6);
+                jit_byte(jit, MINGUS_FRAME_SIZE);
+                jit_bytes(jit, "\x41\x3b\x86", 3);
+                jit_int(jit, JIT_STATE_OFFSET(call_size));
+                jit_bytes(jit, "\x0f\x87", 2);
+                call_check = jit->offset;
+                jit_int(jit, 0);
+
+                /* pushes the number of arguments, the function location
+                and the return program counter into the call stack
+                (mov dword [r13 + n], imm32) ; add r13, 12 ; jmp rel32 */
+                jit_bytes(jit, "\x41\xc7\x45\x00", 4);
+                jit_int(jit, operation->arg1);
+                jit_bytes(jit, "\x41\xc7\x45\x04", 4);
+                jit_int(jit, (unsigned int) operation->operand);
+                jit_bytes(jit, "\x41\xc7\x45\x08", 4);
+                jit_int(jit, index + 1);
+                jit_bytes(jit, "\x49\x83\xc5\x0c", 4);
+                jit_byte(jit, 0xe9);
+                jit_branch(jit, (unsigned int) operation->operand);
+
+                /* grow block (out of the straight path): sets the
+                program counter at the call so that it's re-entered
+                once the stacks are grown, mov dword [r14 + pc], index ;
+                jmp overflow */
+                jit_patch(jit, stack_check);
+                jit_patch(jit, call_check);
+                jit_bytes(jit, "\x41\xc7\x86", 3);
+                jit_int(jit, JIT_STATE_OFFSET(pc));
+                jit_int(jit, index);
+                jit_byte(jit, 0xe9);
+                jit_rel32(jit, overflow);
+                break;
+
+            case RET:
+                /* sub r13, 12 ; mov eax, [r13 + 8] ; cmp eax, count ;
+                jae error ; jmp [r15 + rax * 8] */
+                jit_bytes(jit, "\x49\x83\xed\x0c\x41\x8b\x45\x08", 8);
+                jit_byte(jit, 0x3d);
+                jit_int(jit, jit->count);
+                jit_bytes(jit, "\x0f\x83", 2);
+                jit_rel32(jit, error);
+                jit_bytes(jit, "\x41\xff\x24\xc7", 4);
+                break;
+
+            case PRINT:
+                jit_call(jit, (void *) jit_print);
+                break;
+
+            case PRINTS:
+                /* calls the print helper and verifies its result
+                (the reference check): test eax, eax ; jnz invalid */
+                jit_call(jit, (void *) jit_prints);
+                jit_bytes(jit, "\x85\xc0\x0f\x85", 4);
+                jit_rel32(jit, invalid);
+                break;
+
+            case RLOAD:
+            case RLOADI:
+                /* mov dword [r14 + rd], imm32 */
+                jit_bytes(jit, "\x41\xc7\x86", 3);
+                jit_int(jit, JIT_REGISTER_OFFSET(operation->arg1));
+                jit_int(jit, (unsigned int) operation->operand);
+                break;
+
+            case RSTORE:
+                /* mov eax, [r14 + ra] ; mov [r14 + globals + operand * 8], rax */
+                jit_register(jit, "\x41\x8b\x86", operation->arg1);
+                jit_global(jit, operation->operand);
+                break;
+
+            case RMOV:
+                /* mov eax, [r14 + ra] ; mov [r14 + rd], eax */
+                jit_register(jit, "\x41\x8b\x86", operation->arg2);
+                jit_register(jit, "\x41\x89\x86", operation->arg1);
+                break;
+
+            case RADD:
+            case RSUB:
+                /* mov eax, [r14 + ra] ; add (or sub) eax, [r14 + rb] ;
+                mov [r14 + rd], eax */
+                jit_register(jit, "\x41\x8b\x86", operation->arg2);
+                jit_register(jit, operation->opcode == RADD ? "\x41\x03\x86" : "\x41\x2b\x86", operation->arg3);
+                jit_register(jit, "\x41\x89\x86", operation->arg1);
+                break;
+
+            case RADDI:
+            case RSUBI:
+                /* add (or sub) dword [r14 + rd], imm32 */
+                jit_register(jit, operation->opcode == RADDI ? "\x41\x81\x86" : "\x41\x81\xae", operation->arg1);
+                jit_int(jit, (unsigned int) operation->operand);
+                break;
+
+            case RCMP_EQ:
+            case RCMP_NEQ:
+                /* mov eax, [r14 + ra] ; xor ecx, ecx ; cmp eax, [r14 + rb] ;
+                setcc cl ; mov [r14 + rd], ecx */
+                jit_register(jit, "\x41\x8b\x86", operation->arg2);
+                jit_bytes(jit, "\x31\xc9", 2);
+                jit_register(jit, "\x41\x3b\x86", operation->arg3);
+                jit_bytes(jit, operation->opcode == RCMP_EQ ? "\x0f\x94\xc1" : "\x0f\x95\xc1", 3);
+                jit_register(jit, "\x41\x89\x8e", operation->arg1);
+                break;
+
+            case RJMP_EQ:
+            case RJMP_NEQ:
+            case RJMP_NZ:
+                /* cmp dword [r14 + ra], 1 (or 0) ; je (or jne) rel32 */
+                jit_register(jit, "\x41\x83\xbe", operation->arg1);
+                jit_byte(jit, operation->opcode == RJMP_EQ ? 1 : 0);
+                jit_bytes(jit, operation->opcode == RJMP_NZ ? "\x0f\x85" : "\x0f\x84", 2);
+                jit_branch(jit, (unsigned int) operation->operand);
+                break;
+
+            case RPRINT:
+                jit_call_register(jit, (void *) jit_print, operation->arg1);
+                break;
+
+            case RPRINTS:
+                jit_call_register(jit, (void *) jit_prints, operation->arg1);
+                jit_bytes(jit, "\x85\xc0\x0f\x85", 4);
+                jit_rel32(jit, invalid);
+                break;
+
+            case ADDI:
+            case SUBI:
+                /* add (or sub) dword [r12 - 4], imm32 ; jmp rel32
+                (skips the native code of the fused operation) */
+                jit_bytes(jit, operation->opcode == ADDI ? "\x41\x81\x44\x24\xfc" : "\x41\x81\x6c\x24\xfc", 5);
+                jit_int(jit, (unsigned int) operation->operand);
+                jit_byte(jit, 0xe9);
+                jit_branch(jit, index + 2);
+                break;
+
+            case CMPI_JMP_EQ:
+            case CMPI_JMP_NEQ:
+                /* cmp dword [r12 - 4], imm32 ; jcc rel32 (condition
+                taken from the comparison kind and the kind of fused
+                branch) ; jmp rel32 (skips the fused operations) */
+                jit_bytes(jit, "\x41\x81\x7c\x24\xfc", 5);
+                jit_int(jit, (unsigned int) operation->operand);
+                if(operation->arg1 == 1 || operation->arg1 == 2) {
+                    jit_byte(jit, 0x0f);
+                    jit_byte(jit, (operation->arg1 == 1) == (operation->opcode == CMPI_JMP_EQ) ? 0x84 : 0x85);
+                    jit_branch(jit, (unsigned int) (operation + 2)->operand);
+                } else if(operation->opcode == CMPI_JMP_NEQ) {
+                    jit_byte(jit, 0xe9);
+                    jit_branch(jit, (unsigned int) (operation + 2)->operand);
+                }
+                jit_byte(jit, 0xe9);
+                jit_branch(jit, index + 3);
+                break;
+
+            default:
+                mingus_jit_release(jit);
+                MINGUS_RAISE_F(
+                    state,
+                    RUNTIME_EXCEPTION_ERROR_CODE,
+                    (unsigned char *) "Invalid opcode '%d' for JIT",
+                    operation->opcode
+                );
+        }
+    }
+
+    /* falling through the end of the program is
+    considered an error (no halt instruction) */
+    jit->natives[jit->count] = &jit->buffer[jit->offset];
+    jit_byte(jit, 0xe9);
+    jit_rel32(jit, error);
+
+    /* patches the complete set of pending branches now
+    that the native address of every operation is known */
+    for(index = 0; index < jit->fixup_count; index++) {
+        jit->offset = jit->fixups[index].offset;
+        jit_rel32(jit, (unsigned char *) jit->natives[jit->fixups[index].target] - jit->buffer);
+    }
+
+    /* releases the fixups (no longer required) and turns
+    the buffer into an executable (read only) one */
+    FREE(jit->fixups);
+    jit->fixups = NULL;
+    if(mprotect(jit->buffer, jit->size, PROT_READ | PROT_EXEC) != 0) {
+        mingus_jit_release(jit);
+        MINGUS_RAISE_M(
+            state,
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem protecting JIT buffer"
+        );
+    }
+
+    /* raises no error */
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE mingus_jit_run(struct state_t *state, struct jit_t *jit) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* retrieves the native entry point (start of the buffer)
+    and allocates space for the value returned by it */
+    jit_entry entry = (jit_entry) jit->buffer;
+    struct operation_t *operation;
+    int result;
+
+    /* runs the native code until the halt instruction is reached,
+    in case a call doesn't fit the stacks the native code returns
+    at the call, the stacks are grown (as the interpreter does, up
+    to their limits) and the native code is re-entered at the call */
+    while(TRUE) {
+        result = state->pc < jit->count ? entry(state, jit->natives) : 1;
+        if(result != 2) { break; }
+        operation = &state->operations[state->pc];
+        return_value = mingus_grow(
+            state,
+            state->so + MINGUS_RESERVE(operation),
+            state->cso + MINGUS_FRAME_SIZE
+        );
+        if(IS_ERROR_CODE(return_value)) { mingus_output_flush(&state->output); RAISE_AGAIN(return_value); }
+    }
+
+    /* flushes the output and maps the returned value into
+    the respective error (if any) */
+    mingus_output_flush(&state->output);
+    if(result == 3) {
+        MINGUS_RAISE_M(
+            state,
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Invalid string reference in JIT code"
+        );
+    }
+    if(result != 0) {
+        MINGUS_RAISE_M(
+            state,
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Invalid program counter in JIT code"
+        );
+    }
+
+    /* raises no error */
+    RAISE_NO_ERROR;
+}
+
+void mingus_jit_release(struct jit_t *jit) {
+    if(jit->buffer != NULL) { munmap(jit->buffer, jit->size); }
+    if(jit->natives != NULL) { FREE(jit->natives); }
+    if(jit->fixups != NULL) { FREE(jit->fixups); }
+    jit->buffer = NULL;
+    jit->natives = NULL;
+    jit->fixups = NULL;
+}
+
+#else
+
+ERROR_CODE mingus_jit_compile(struct state_t *state, struct jit_t *jit) {
+    MINGUS_RAISE_M(
+        state,
+        RUNTIME_EXCEPTION_ERROR_CODE,
+        (unsigned char *) "JIT not available for target"
+    );
+}
+
+ERROR_CODE mingus_jit_run(struct state_t *state, struct jit_t *jit) {
+    MINGUS_RAISE_M(
+        state,
+        RUNTIME_EXCEPTION_ERROR_CODE,
+        (unsigned char *) "JIT not available for target"
+    );
+}
+
+void mingus_jit_release(struct jit_t *jit) {
+}
+
+#endif
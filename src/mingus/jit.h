@@ -0,0 +1,145 @@
+/*
+ Mingus Virtual Machine
+ Copyright (c) 2008-2020 Hive Solutions Lda.
+
+ This file is part of Mingus Virtual Machine.
+
+ Mingus Virtual Machine is free software: you can redistribute it and/or modify
+ it under the terms of the Apache License as published by the Apache
+ Foundation, either version 2.0 of the License, or (at your option) any
+ later version.
+
+ Mingus Virtual Machine is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ Apache License for more details.
+
+ You should have received a copy of the Apache License along with
+ Mingus Virtual Machine. If not, see <http://www.apache.org/licenses/>.
+
+ __author__    = João Magalhães <joamag@hive.pt>
+ __version__   = 1.0.0
+ __revision__  = $LastChangedRevision$
+ __date__      = $LastChangedDate$
+ __copyright__ = Copyright (c) 2008-2020 João Magalhães
+ __license__   = Apache License, Version 2.0
+*/
+
+#pragma once
+
+/**
+ * The JIT backend is only available for x86-64 targets
+ * running under POSIX systems (mmap based buffers), for
+ * all the other targets the compile function fails.
+ */
+#if defined(__x86_64__) && !defined(_WIN32)
+#define MINGUS_JIT_AVAILABLE
+#endif
+
+/**
+ * The maximum number of bytes of native code that
+ * may be generated for a single operation, used to
+ * size the executable buffer before emission.
+ */
+#define MINGUS_JIT_OPERATION_SIZE 112
+
+/**
+ * The number of bytes reserved in the executable buffer
+ * for the prologue, epilogue and error stub code.
+ */
+#define MINGUS_JIT_BASE_SIZE 256
+
+/**
+ * The signature of the native entry point generated by
+ * the JIT, receives the state and the table of native
+ * addresses indexed by program counter.
+ */
+typedef int (*jit_entry)(struct state_t *state, void **natives);
+
+/**
+ * Structure describing a pending branch in the native
+ * code that is going to be patched (rel32 displacement)
+ * once all the operations have been emitted.
+ */
+typedef struct jit_fixup_t {
+    size_t offset;
+    unsigned int target;
+} jit_fixup;
+
+/**
+ * Structure holding the native code generated for a
+ * program together with the information required to
+ * enter it at any program counter.
+ */
+typedef struct jit_t {
+    /**
+     * The mmap'd executable buffer that holds the
+     * native code generated for the program.
+     */
+    unsigned char *buffer;
+
+    /**
+     * The size in bytes of the (allocated) buffer.
+     */
+    size_t size;
+
+    /**
+     * The offset in the buffer where the next native
+     * instruction is going to be emitted.
+     */
+    size_t offset;
+
+    /**
+     * The table that maps each program counter value into
+     * the address of its native code, used for entering the
+     * code and for the (dynamic) return operation.
+     */
+    void **natives;
+
+    /**
+     * The number of operations (program counter values)
+     * covered by the natives table.
+     */
+    unsigned int count;
+
+    /**
+     * The list of branches pending patching and the number
+     * of entries currently set in it.
+     */
+    struct jit_fixup_t *fixups;
+    size_t fixup_count;
+} jit;
+
+/**
+ * Compiles the (pre-decoded) operations of the provided
+ * state into native x86-64 code using one machine code
+ * template per opcode.
+ *
+ * The value stack and the call stack are kept in memory
+ * (in the state) with their top pointers in registers.
+ *
+ * @param state The virtual machine state with the loaded
+ * operations that are going to be compiled.
+ * @param jit The JIT structure to be populated.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_jit_compile(struct state_t *state, struct jit_t *jit);
+
+/**
+ * Runs the native code of a previously compiled program
+ * from the current program counter until halt, leaving
+ * the state as the interpreter would.
+ *
+ * @param state The current virtual machine state.
+ * @param jit The JIT structure with the compiled code.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_jit_run(struct state_t *state, struct jit_t *jit);
+
+/**
+ * Releases the executable buffer and the tables
+ * associated with the provided JIT structure.
+ *
+ * @param jit The JIT structure to be released.
+ */
+void mingus_jit_release(struct jit_t *jit);
@@ -0,0 +1,593 @@
+/*
+ Mingus Virtual Machine
+ Copyright (c) 2008-2020 Hive Solutions Lda.
+
+ This file is part of Mingus Virtual Machine.
+
+ Mingus Virtual Machine is free software: you can redistribute it and/or modify
+ it under the terms of the Apache License as published by the Apache
+ Foundation, either version 2.0 of the License, or (at your option) any
+ later version.
+
+ Mingus Virtual Machine is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ Apache License for more details.
+
+ You should have received a copy of the Apache License along with
+ Mingus Virtual Machine. If not, see <http://www.apache.org/licenses/>.
+
+ __author__    = João Magalhães <joamag@hive.pt>
+ __version__   = 1.0.0
+ __revision__  = $LastChangedRevision$
+ __date__      = $LastChangedDate$
+ __copyright__ = Copyright (c) 2008-2020 João Magalhães
+ __license__   = Apache License, Version 2.0
+*/
+
+#include "stdafx.h"
+
+#include "mingus.h"
+#include "counters.h"
+#include "jit.h"
+#include "ngram.h"
+#include "pool.h"
+#include "profile.h"
+
+/* starts the memory structures */
+START_MEMORY;
+
+ERROR_CODE run(struct options_t *options) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* allocates space for the structure holding the native
+    code in case the JIT backend is used */
+    struct jit_t jit;
+
+    /* allocates space for the status of the execution, used
+    to detect an exhausted budget or an expired timeout */
+    enum mingus_status_e status;
+
+    /* allocates space for the per instruction hit counters
+    used by the n-grams profiling mode */
+    unsigned long long *hits;
+
+    /* allocates space for the profile gathered by the
+    (instrumented or sampling) profiling modes */
+    struct profile_t *profile;
+
+    /* allocates space for the performance counters measuring
+    the execution and for the number of executed instructions */
+    struct counters_t counters;
+    unsigned long long instructions = 0;
+    unsigned int index;
+
+    /* allocates space for the path to the file to be run */
+    char *file_path = options->file_path;
+
+    /* allocates space for the module and for the virtual
+    machine state, created once the file is read */
+    struct module_t *module;
+    struct state_t *state;
+
+    /* in case the provided file path is not valid raises
+    and error indicating the problem */
+    if(file_path == NULL) {
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "No input file"
+        );
+    }
+
+    /* maps the program file into a module and attaches it to a
+    new virtual machine state, the n-grams and the instrumented
+    profiling modes run the unfused operations as these are the
+    ones being analysed, the errors of the state are raised again
+    (process wide) as the state is deleted before they're printed */
+    return_value = mingus_module_map(
+        &module, file_path, options->ngrams == TRUE || options->profile == TRUE ? FALSE : options->fuse
+    );
+    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+    return_value = mingus_create(&state);
+    if(IS_ERROR_CODE(return_value)) { mingus_module_release(module); RAISE_AGAIN(return_value); }
+    mingus_set_limits(state, options->stack_limit, options->call_limit);
+    return_value = mingus_attach(state, module);
+    mingus_module_release(module);
+    if(IS_ERROR_CODE(return_value)) { return_value = mingus_raise(state, return_value); }
+    if(IS_ERROR_CODE(return_value)) { mingus_delete(state); RAISE_AGAIN(return_value); }
+
+    /* in case the n-grams profiling mode is requested runs the
+    (unfused) program counting the hits per instruction and then
+    prints the report of the hottest opcode sequences */
+    if(options->ngrams == TRUE) {
+        hits = (unsigned long long *) MALLOC(state->header.code_count * sizeof(unsigned long long));
+        if(hits == NULL) {
+            mingus_delete(state);
+            RAISE_ERROR_M(RUNTIME_EXCEPTION_ERROR_CODE, (unsigned char *) "Problem allocating hits");
+        }
+        memset(hits, 0, state->header.code_count * sizeof(unsigned long long));
+        return_value = mingus_ngram_run(state, hits);
+        if(IS_ERROR_CODE(return_value)) { return_value = mingus_raise(state, return_value); }
+        else { return_value = mingus_ngram_report(state, hits); }
+        FREE(hits);
+        mingus_delete(state);
+        if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+        RAISE_NO_ERROR;
+    }
+
+    /* in case the performance counters are requested opens them,
+    before the execution so that opening them is not measured */
+    if(options->counters == TRUE) {
+        return_value = mingus_counters_open(&counters);
+        if(IS_ERROR_CODE(return_value)) { mingus_delete(state); RAISE_AGAIN(return_value); }
+    }
+
+    /* in case one of the profiling modes is requested runs the
+    program gathering the profile, printing its report and then
+    writing the folded stacks (instrumented mode only), the
+    counters are read around every operation when instrumented */
+    if(options->profile == TRUE || options->sample == TRUE) {
+        return_value = mingus_profile_create(&profile, state);
+        if(IS_ERROR_CODE(return_value)) {
+            if(options->counters == TRUE) { mingus_counters_close(&counters); }
+            mingus_delete(state);
+            RAISE_AGAIN(return_value);
+        }
+        if(options->counters == TRUE) {
+            if(options->profile == TRUE) { profile->counters = &counters; }
+            mingus_counters_start(&counters);
+        }
+        if(options->profile == TRUE) { return_value = mingus_profile_run(state, profile); }
+        else { return_value = mingus_profile_sample(state, profile); }
+        if(options->counters == TRUE) { mingus_counters_stop(&counters); }
+        if(IS_ERROR_CODE(return_value)) { return_value = mingus_raise(state, return_value); }
+        if(!IS_ERROR_CODE(return_value)) { return_value = mingus_profile_report(state, profile); }
+        if(!IS_ERROR_CODE(return_value) && options->folded_path != NULL) {
+            return_value = mingus_profile_folded(profile, options->folded_path);
+        }
+        if(!IS_ERROR_CODE(return_value) && options->counters == TRUE) {
+            instructions = state->steps;
+            for(index = 0; index < MINGUS_OPERATION_COUNT && options->profile == TRUE; index++) {
+                instructions += profile->counts[index];
+            }
+            return_value = mingus_counters_report(&counters, instructions);
+        }
+        if(options->counters == TRUE) { mingus_counters_close(&counters); }
+        mingus_profile_delete(profile);
+        mingus_delete(state);
+        if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+        RAISE_NO_ERROR;
+    }
+
+    /* in case a trace file is requested creates the trace ring
+    buffer, raising an error if tracing is not compiled in */
+    if(options->trace_path != NULL) {
+#ifdef MINGUS_TRACE
+        return_value = mingus_trace_create(&state->trace, options->trace_path, MINGUS_TRACE_CAPACITY);
+        if(IS_ERROR_CODE(return_value)) {
+            if(options->counters == TRUE) { mingus_counters_close(&counters); }
+            mingus_delete(state);
+            RAISE_AGAIN(return_value);
+        }
+#else
+        if(options->counters == TRUE) { mingus_counters_close(&counters); }
+        mingus_delete(state);
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Tracing not available (build with trace=1)"
+        );
+#endif
+    }
+
+    /* in case the JIT backend is requested compiles the operations
+    into native code and runs it (always to completion), otherwise
+    runs the program using the dispatch engine selected at compile
+    time, within the budget and timeout of the execution */
+    status = MINGUS_HALTED;
+    if(options->jit == TRUE) {
+        if(options->budget != MINGUS_BUDGET_UNLIMITED || options->timeout != 0) {
+            if(options->counters == TRUE) { mingus_counters_close(&counters); }
+            mingus_delete(state);
+            RAISE_ERROR_M(
+                RUNTIME_EXCEPTION_ERROR_CODE,
+                (unsigned char *) "Budget and timeout not available with JIT"
+            );
+        }
+        return_value = mingus_jit_compile(state, &jit);
+        if(!IS_ERROR_CODE(return_value)) {
+            if(options->counters == TRUE) { mingus_counters_start(&counters); }
+            return_value = mingus_jit_run(state, &jit);
+            if(options->counters == TRUE) { mingus_counters_stop(&counters); }
+            mingus_jit_release(&jit);
+        }
+    } else {
+        if(options->counters == TRUE) { mingus_counters_start(&counters); }
+        return_value = mingus_execute_until(
+            state,
+            options->budget,
+            options->timeout == 0 ? 0 : mingus_time() + options->timeout * 1000000ULL,
+            &status
+        );
+        if(options->counters == TRUE) { mingus_counters_stop(&counters); }
+    }
+    if(IS_ERROR_CODE(return_value)) { return_value = mingus_raise(state, return_value); }
+
+    /* writes the trace (if any) to its file, this is done even
+    on error as the trace is most useful in that case */
+    if(state->trace != NULL) {
+        if(IS_ERROR_CODE(return_value)) { mingus_trace_close(state->trace); }
+        else { return_value = mingus_trace_close(state->trace); }
+        state->trace = NULL;
+    }
+
+    /* retrieves the number of operations dispatched by the
+    interpreter during the (measured) execution, unknown for the
+    JIT, and releases the state (and with it the module), these
+    are no longer required as the execution is finished */
+    instructions = state->steps;
+    mingus_delete(state);
+
+    /* prints the number of dispatched operations (if requested) and
+    the report of the counters (if any), the values per instruction
+    are only reported in case the number of operations is known */
+    if(options->steps == TRUE && options->jit == FALSE && !IS_ERROR_CODE(return_value)) {
+        fprintf(stderr, "Dispatched %llu operations\n", instructions);
+    }
+    if(options->counters == TRUE) {
+        if(!IS_ERROR_CODE(return_value)) { return_value = mingus_counters_report(&counters, instructions); }
+        mingus_counters_close(&counters);
+    }
+    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+
+    /* in case the program has not halted (stopped by the budget
+    or by the timeout) raises an error indicating the reason */
+    if(status != MINGUS_HALTED) {
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) (status == MINGUS_EXHAUSTED ? "Execution budget exhausted" : "Execution timeout expired")
+        );
+    }
+
+    /* normal returns of the function with no error */
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE run_jobs(struct options_t *options) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value = 0;
+
+    /* allocates space for the index of the path, for the number
+    of failed jobs, for the line read from the standard input
+    and for the pool running the jobs */
+    size_t index;
+    size_t length;
+    size_t failures = 0;
+    char line[4096];
+    struct pool_t *pool;
+
+    /* creates the pool with the requested number of threads, the
+    output of each job is written as a whole once it finishes */
+    return_value = mingus_pool_create(&pool, options->jobs, TRUE);
+    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+
+    /* adds a job per path, the special path "-" reads the paths
+    from the standard input (one per line) */
+    for(index = 0; index < options->path_count && !IS_ERROR_CODE(return_value); index++) {
+        if(strcmp(options->paths[index], "-") != 0) {
+            return_value = mingus_pool_add(pool, options->paths[index]);
+            continue;
+        }
+        while(fgets(line, sizeof(line), stdin) != NULL && !IS_ERROR_CODE(return_value)) {
+            length = strlen(line);
+            while(length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r')) { length--; }
+            line[length] = '\0';
+            if(length == 0) { continue; }
+            return_value = mingus_pool_add(pool, line);
+        }
+    }
+
+    /* runs all the jobs and counts the failed ones, the error
+    of each of them has already been printed by the pool */
+    if(!IS_ERROR_CODE(return_value)) { return_value = mingus_pool_run(pool); }
+    for(index = 0; index < pool->count; index++) {
+        if(IS_ERROR_CODE(pool->jobs[index].result)) { failures++; }
+    }
+    mingus_pool_delete(pool);
+    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+    if(failures > 0) {
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "%lu jobs failed",
+            (unsigned long) failures
+        );
+    }
+
+    /* normal returns of the function with no error */
+    RAISE_NO_ERROR;
+}
+
+#ifndef _WIN32
+
+ERROR_CODE run_capture(struct options_t *options, unsigned char jit, char **buffer, size_t *size) {
+    /* allocates space for the pipe descriptors, the identifier
+    of the child process and for its exit status */
+    int pipes[2];
+    int status;
+    pid_t pid;
+
+    /* allocates space for the number of bytes read in each
+    iteration and for the capacity of the output buffer */
+    ssize_t count;
+    size_t capacity = 4096;
+    char *grown;
+
+    /* creates the pipe that is going to be used to capture
+    the output of the child process and forks it */
+    if(pipe(pipes) != 0) {
+        RAISE_ERROR_M(RUNTIME_EXCEPTION_ERROR_CODE, (unsigned char *) "Problem creating pipe");
+    }
+    fflush(stdout);
+    pid = fork();
+    if(pid < 0) {
+        RAISE_ERROR_M(RUNTIME_EXCEPTION_ERROR_CODE, (unsigned char *) "Problem forking process");
+    }
+
+    /* in case this is the child process redirects the standard
+    output into the pipe and runs the program with the requested
+    engine, exiting with the proper status at the end */
+    if(pid == 0) {
+        close(pipes[0]);
+        dup2(pipes[1], 1);
+        options->jit = jit;
+        status = IS_ERROR_CODE(run(options)) ? 1 : 0;
+        fflush(stdout);
+        _exit(status);
+    }
+
+    /* reads the complete output of the child process into
+    the (growing) buffer until the end of file is reached */
+    close(pipes[1]);
+    *buffer = (char *) MALLOC(capacity);
+    *size = 0;
+    while(*buffer != NULL) {
+        if(*size == capacity) {
+            capacity *= 2;
+            grown = (char *) REALLOC(*buffer, capacity);
+            if(grown == NULL) { FREE(*buffer); *buffer = NULL; break; }
+            *buffer = grown;
+        }
+        count = read(pipes[0], *buffer + *size, capacity - *size);
+        if(count <= 0) { break; }
+        *size += (size_t) count;
+    }
+    close(pipes[0]);
+
+    /* waits for the child process to finish and verifies
+    that it has exited with no error */
+    waitpid(pid, &status, 0);
+    if(*buffer == NULL) {
+        RAISE_ERROR_M(RUNTIME_EXCEPTION_ERROR_CODE, (unsigned char *) "Problem allocating output");
+    }
+    if(!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        FREE(*buffer);
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem running %s engine",
+            jit ? "jit" : "interpreter"
+        );
+    }
+
+    /* raises no error */
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE run_diff(struct options_t *options) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* allocates space for the index of the first different
+    byte and for the outputs of both engines */
+    size_t index;
+    size_t size;
+    size_t jit_size;
+    char *buffer;
+    char *jit_buffer;
+
+    /* runs the program under both the interpreter and the
+    JIT capturing the complete output of each of them */
+    return_value = run_capture(options, FALSE, &buffer, &size);
+    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+    return_value = run_capture(options, TRUE, &jit_buffer, &jit_size);
+    if(IS_ERROR_CODE(return_value)) { FREE(buffer); RAISE_AGAIN(return_value); }
+
+    /* finds the first byte where both outputs diverge, in
+    case there's none and sizes match the outputs are equal */
+    for(index = 0; index < size && index < jit_size; index++) {
+        if(buffer[index] != jit_buffer[index]) { break; }
+    }
+    FREE(buffer);
+    FREE(jit_buffer);
+    if(index != size || index != jit_size) {
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Engine outputs differ at byte %lu",
+            (unsigned long) index
+        );
+    }
+
+    /* prints a message indicating that both outputs
+    are the same and returns with no error */
+    PRINTF_F("Engine outputs match (%lu bytes)\n", (unsigned long) size);
+    RAISE_NO_ERROR;
+}
+
+#else
+
+ERROR_CODE run_diff(struct options_t *options) {
+    RAISE_ERROR_M(
+        RUNTIME_EXCEPTION_ERROR_CODE,
+        (unsigned char *) "Differential mode not available"
+    );
+}
+
+#endif
+
+ERROR_CODE get_value(int argc, const char *argv[], int *index, char **value) {
+    /* in case there's no argument after the option its
+    value is missing and an error is raised */
+    if(*index + 1 >= argc) {
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Missing value for option %s",
+            argv[*index]
+        );
+    }
+
+    /* moves to the value argument and returns it */
+    *index += 1;
+    *value = (char *) argv[*index];
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE get_number(
+    int argc,
+    const char *argv[],
+    int *index,
+    unsigned long long minimum,
+    unsigned long long maximum,
+    unsigned long long *value
+) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* allocates space for the value string and for the
+    pointer to the end of the parsed digits */
+    char *string;
+    char *end;
+
+    /* retrieves the value of the option and parses it as a
+    decimal number, requiring it to be made only of digits
+    (no sign) and to be within the range of the option */
+    return_value = get_value(argc, argv, index, &string);
+    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+    errno = 0;
+    *value = strtoull(string, &end, 10);
+    if(string[0] < '0' || string[0] > '9' || *end != '\0' || errno == ERANGE || *value < minimum || *value > maximum) {
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Invalid value %s for option %s",
+            string,
+            argv[*index - 1]
+        );
+    }
+
+    /* raises no error */
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE parse_options(int argc, const char *argv[], struct options_t *options) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* allocates space for the index of the argument
+    being parsed and for the value of a numeric option */
+    int index;
+    unsigned long long value;
+
+    /* allocates the array of paths (at most one per argument) */
+    options->paths = (char **) MALLOC(argc * sizeof(char *));
+    if(options->paths == NULL) {
+        RAISE_ERROR_M(RUNTIME_EXCEPTION_ERROR_CODE, (unsigned char *) "Problem allocating paths");
+    }
+
+    /* iterates over the complete set of arguments, flags
+    change the options (an unknown one is an error) and any
+    other argument is considered to be the path of the file
+    to be interpreted, numeric values are range checked */
+    for(index = 1, return_value = 0; index < argc && !IS_ERROR_CODE(return_value); index++) {
+        if(strcmp(argv[index], "--jit") == 0) {
+            options->jit = TRUE;
+        } else if(strcmp(argv[index], "--trace") == 0) {
+            return_value = get_value(argc, argv, &index, &options->trace_path);
+        } else if(strcmp(argv[index], "--no-fuse") == 0) {
+            options->fuse = FALSE;
+        } else if(strcmp(argv[index], "--ngrams") == 0) {
+            options->ngrams = TRUE;
+        } else if(strcmp(argv[index], "--profile") == 0) {
+            options->profile = TRUE;
+        } else if(strcmp(argv[index], "--sample") == 0) {
+            options->sample = TRUE;
+        } else if(strcmp(argv[index], "--folded") == 0) {
+            options->profile = TRUE;
+            return_value = get_value(argc, argv, &index, &options->folded_path);
+        } else if(strcmp(argv[index], "--counters") == 0) {
+            options->counters = TRUE;
+        } else if(strcmp(argv[index], "--steps") == 0) {
+            options->steps = TRUE;
+        } else if(strcmp(argv[index], "--diff") == 0) {
+            options->diff = TRUE;
+        } else if(strcmp(argv[index], "--stack-limit") == 0) {
+            return_value = get_number(argc, argv, &index, 1, MINGUS_LIMIT_MAX, &value);
+            options->stack_limit = (size_t) value;
+        } else if(strcmp(argv[index], "--call-limit") == 0) {
+            return_value = get_number(argc, argv, &index, 1, MINGUS_LIMIT_MAX / MINGUS_FRAME_SIZE, &value);
+            options->call_limit = (size_t) value;
+        } else if(strcmp(argv[index], "--budget") == 0) {
+            return_value = get_number(argc, argv, &index, 0, MINGUS_BUDGET_UNLIMITED, &options->budget);
+        } else if(strcmp(argv[index], "--timeout") == 0) {
+            return_value = get_number(argc, argv, &index, 0, ((unsigned long long) -1) / 1000000, &options->timeout);
+        } else if(strcmp(argv[index], "--jobs") == 0) {
+            return_value = get_number(argc, argv, &index, 1, MINGUS_LIMIT_MAX, &value);
+            options->jobs = (size_t) value;
+        } else if(strncmp(argv[index], "--", 2) == 0) {
+            RAISE_ERROR_F(
+                RUNTIME_EXCEPTION_ERROR_CODE,
+                (unsigned char *) "Unknown option %s",
+                argv[index]
+            );
+        } else {
+            options->file_path = (char *) argv[index];
+            options->paths[options->path_count++] = (char *) argv[index];
+        }
+    }
+
+    /* in case there was an error parsing the value of
+    one of the options re-raises it */
+    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+    RAISE_NO_ERROR;
+}
+
+int main(int argc, const char *argv[]) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* allocates space for the execution options */
+    struct options_t options = {
+        NULL, FALSE, NULL, TRUE, FALSE, FALSE, MINGUS_STACK_LIMIT, MINGUS_CALL_LIMIT,
+        MINGUS_BUDGET_UNLIMITED, 0, 0, NULL, 0, FALSE, FALSE, NULL, FALSE, FALSE
+    };
+
+    /* parses the options from the arguments and then runs the
+    virtual machine (or both engines in case of the differential
+    mode, or the pool in the batch mode) and verifies if an
+    error as occurred, if that's the case prints it */
+    return_value = parse_options(argc, argv, &options);
+    if(!IS_ERROR_CODE(return_value)) {
+        return_value = options.jobs > 0 ? run_jobs(&options) : options.diff ? run_diff(&options) : run(&options);
+    }
+    if(options.paths != NULL) { FREE(options.paths); }
+    if(IS_ERROR_CODE(return_value)) {
+        V_ERROR_F("Fatal error (%s)\n", (char *) GET_ERROR());
+        RAISE_AGAIN(return_value);
+    }
+
+    /* returns with no error */
+    return 0;
+}
@@ -28,32 +28,296 @@
 #include "stdafx.h"
 
 #include "mingus.h"
-
-/* starts the memory structures */
-START_MEMORY;
+#include "jit.h"
+#include "ngram.h"
+#include "verify.h"
 
 const char operands[3][32] = { "##", "==", "!=" };
 
-unsigned int mingus_fetch(struct state_t *state) {
-    return state->program[state->pc++];
+struct operation_t *mingus_fetch(struct state_t *state) {
+    return &state->operations[state->pc++];
 }
 
-ERROR_CODE mingus_decode(struct state_t *state, unsigned int instruction) {
+ERROR_CODE mingus_decode(struct instruction_t *instruction, unsigned int code) {
     /* populates the (current) instruction with the decoded values */
-    state->instruction.code = instruction;
-    state->instruction.opcode = (instruction & 0xffff0000) >> 16;
-    state->instruction.arg1 = (instruction & 0x00000f00) >> 8;
-    state->instruction.arg2 = (instruction & 0x000000f0) >> 4;
-    state->instruction.arg3 = (instruction & 0x0000000f);
-    state->instruction.immediate = (instruction & 0x000000ff);
+    instruction->code = code;
+    instruction->opcode = (code & 0xff000000) >> 24;
+    instruction->arg1 = (code & 0x00f00000) >> 20;
+    instruction->arg2 = (code & 0x000f0000) >> 16;
+    instruction->arg3 = (code & 0x0000f000) >> 12;
+
+    /* decodes the immediate (sign extended) according to the kind
+    of opcode, wide (24 bit) or narrow (16 bit) */
+    if(MINGUS_WIDE(instruction->opcode)) {
+        instruction->immediate = (int) (code & 0x00ffffff);
+        if(instruction->immediate & 0x00800000) { instruction->immediate -= 0x01000000; }
+    } else {
+        instruction->immediate = (int) (code & 0x0000ffff);
+        if(instruction->immediate & 0x00008000) { instruction->immediate -= 0x00010000; }
+    }
+
+    /* returns the control flow with no error */
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE mingus_frame(struct module_t *module, unsigned int entry, unsigned int *depth) {
+    /* allocates space for the bounds of the binary search
+    over the (sorted) frames of the module */
+    size_t lower = 0;
+    size_t upper = module->header.frame_count;
+    size_t middle;
+
+    /* runs the binary search for the frame with the
+    provided entry, setting its depth when found */
+    while(lower < upper) {
+        middle = (lower + upper) / 2;
+        if(module->frames[middle].entry == entry) {
+            *depth = module->frames[middle].depth;
+            RAISE_NO_ERROR;
+        }
+        if(module->frames[middle].entry < entry) { lower = middle + 1; }
+        else { upper = middle; }
+    }
+
+    /* raises an error as there's no frame for the entry */
+    RAISE_ERROR_F(
+        RUNTIME_EXCEPTION_ERROR_CODE,
+        (unsigned char *) "No stack frame for function '%d'",
+        (int) entry
+    );
+}
+
+ERROR_CODE mingus_load(struct module_t *module) {
+    /* allocates space for the index of the instruction being
+    translated and for the (absolute) target of a branch */
+    unsigned int index;
+    unsigned int target;
+    unsigned int depth;
+
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* allocates space for the instruction structure that
+    is going to hold the decoded values of each instruction */
+    struct instruction_t instruction;
+
+    /* allocates space for the pointer to the operation
+    that is going to be populated for each instruction */
+    struct operation_t *operation;
+
+    /* allocates the array of operations, one per instruction
+    in the code section, this is the array that is going to
+    be used by the engines (no more decoding at runtime) */
+    module->operations = (struct operation_t *) MALLOC(
+        module->header.code_count * sizeof(struct operation_t)
+    );
+    if(module->operations == NULL) {
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem allocating operations"
+        );
+    }
+
+    /* retrieves the stack depth of the entry frame (reserved
+    when the module is attached) and starts the number of
+    globals with the number of data elements */
+    return_value = mingus_frame(module, 0, &module->reserve);
+    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+    module->global_count = module->header.data_count;
+
+    /* iterates over the complete set of instructions in the
+    code section to decode each of them (only once) */
+    for(index = 0; index < module->header.code_count; index++) {
+        mingus_decode(&instruction, module->program[index]);
+        operation = &module->operations[index];
+
+        /* verifies that the opcode is a valid one, this check is
+        done here so that the engines may skip it */
+        if(instruction.opcode < 0 || instruction.opcode >= MINGUS_OPCODE_COUNT) {
+            RAISE_ERROR_F(
+                RUNTIME_EXCEPTION_ERROR_CODE,
+                (unsigned char *) "Invalid opcode '%d'",
+                instruction.opcode
+            );
+        }
+
+        /* populates the operation with the decoded values, notice
+        that the operand is explicitly sign extended */
+        operation->opcode = (unsigned char) instruction.opcode;
+        operation->arg1 = (unsigned char) instruction.arg1;
+        operation->arg2 = (unsigned char) instruction.arg2;
+        operation->arg3 = (unsigned char) instruction.arg3;
+        operation->operand = instruction.immediate;
+
+        /* resolves the constant pool loads into immediate loads
+        of the referenced value, so that the engines never see
+        them, and verifies that the global indexes are valid */
+        switch(operation->opcode) {
+            case LOADK:
+            case RLOADK:
+                if(operation->operand < 0 || (unsigned int) operation->operand >= module->header.const_count) {
+                    RAISE_ERROR_F(
+                        RUNTIME_EXCEPTION_ERROR_CODE,
+                        (unsigned char *) "Invalid constant index '%d'",
+                        operation->operand
+                    );
+                }
+                operation->opcode = operation->opcode == LOADK ? LOADI : RLOADI;
+                operation->operand = module->constants[operation->operand];
+                continue;
+
+            case CALLK:
+                if(operation->operand < 0 || (unsigned int) operation->operand >= module->header.const_count) {
+                    RAISE_ERROR_F(
+                        RUNTIME_EXCEPTION_ERROR_CODE,
+                        (unsigned char *) "Invalid constant index '%d'",
+                        operation->operand
+                    );
+                }
+                operation->opcode = CALL;
+                operation->operand = module->constants[operation->operand];
+                break;
+
+            case STORE:
+            case RSTORE:
+                if(operation->operand < 0) {
+                    RAISE_ERROR_F(
+                        RUNTIME_EXCEPTION_ERROR_CODE,
+                        (unsigned char *) "Invalid global index '%d'",
+                        operation->operand
+                    );
+                }
+                if((unsigned int) operation->operand >= module->header.data_count + LOCALS_SIZE) {
+                    RAISE_ERROR_F(
+                        RUNTIME_EXCEPTION_ERROR_CODE,
+                        (unsigned char *) "Global index '%d' exceeds the limit (%u data elements plus %d globals)",
+                        operation->operand,
+                        module->header.data_count,
+                        LOCALS_SIZE
+                    );
+                }
+                if((unsigned int) operation->operand >= module->global_count) {
+                    module->global_count = (unsigned int) operation->operand + 1;
+                }
+                continue;
+
+            default:
+                break;
+        }
+
+        /* resolves the branch operations into their absolute target,
+        relative jumps are relative to the next instruction and the
+        absolute ones are unsigned (no sign extension), the pooled
+        calls already hold their (full) target */
+        switch(instruction.opcode) {
+            case JMP:
+            case JMP_EQ:
+            case JMP_NEQ:
+            case RJMP_EQ:
+            case RJMP_NEQ:
+            case RJMP_NZ:
+                target = index + 1 + operation->operand;
+                break;
+
+            case JMP_ABS:
+                target = (unsigned int) instruction.immediate & 0x00ffffff;
+                break;
+
+            case CALL:
+                target = (unsigned int) instruction.immediate & 0x0000ffff;
+                break;
+
+            case CALLK:
+                target = (unsigned int) operation->operand;
+                break;
+
+            default:
+                continue;
+        }
+
+        /* verifies that the branch target is within the
+        code section, raising an error otherwise */
+        if(target >= module->header.code_count) {
+            RAISE_ERROR_F(
+                RUNTIME_EXCEPTION_ERROR_CODE,
+                (unsigned char *) "Invalid branch target '%d'",
+                (int) target
+            );
+        }
+
+        /* updates the operand with the resolved target */
+        operation->operand = (int) target;
+
+        /* stores the stack depth of the called function in the
+        call operation so that the engines verify (and grow) the
+        stacks once per call instead of once per push */
+        if(operation->opcode != CALL) { continue; }
+        return_value = mingus_frame(module, target, &depth);
+        if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+        if(depth > 0xffff) {
+            RAISE_ERROR_F(
+                RUNTIME_EXCEPTION_ERROR_CODE,
+                (unsigned char *) "Stack frame too large for function '%d'",
+                (int) target
+            );
+        }
+        operation->arg2 = (unsigned char) (depth & 0xff);
+        operation->arg3 = (unsigned char) (depth >> 8);
+    }
 
     /* returns the control flow with no error */
     RAISE_NO_ERROR;
 }
 
-ERROR_CODE mingus_eval(struct state_t *state) {
-    /* retrieves the current instruction */
-    struct instruction_t *instruction = &state->instruction;
+ERROR_CODE mingus_fuse(struct module_t *module) {
+    /* allocates space for the index of the operation being
+    analysed and for the pointers to the sequence */
+    unsigned int index;
+    struct operation_t *operation;
+    struct operation_t *next;
+    struct operation_t *last;
+
+    /* iterates over the operations looking for sequences
+    starting with a load immediate that may be fused */
+    for(index = 0; index + 1 < module->header.code_count; index++) {
+        operation = &module->operations[index];
+        next = &module->operations[index + 1];
+        if(operation->opcode != LOADI) { continue; }
+
+        /* loadi k ; add and loadi k ; sub, updates the top
+        of the stack directly with the immediate value */
+        if(next->opcode == ADD || next->opcode == SUB) {
+            operation->opcode = next->opcode == ADD ? ADDI : SUBI;
+            continue;
+        }
+
+        /* loadi k ; cmp c ; jeq/jneq target, compares the top of
+        the stack with the immediate and branches, notice that the
+        target is read from the (kept in place) jump operation */
+        if(index + 2 >= module->header.code_count) { continue; }
+        last = &module->operations[index + 2];
+        if(next->opcode != CMP) { continue; }
+        if(last->opcode != JMP_EQ && last->opcode != JMP_NEQ) { continue; }
+        operation->opcode = last->opcode == JMP_EQ ? CMPI_JMP_EQ : CMPI_JMP_NEQ;
+        operation->arg1 = next->arg1;
+    }
+
+    /* returns the control flow with no error */
+    RAISE_NO_ERROR;
+}
+
+void mingus_unload(struct module_t *module) {
+    /* releases the operations array (if any) and unsets
+    the reference to it in the module */
+    if(module->operations != NULL) { FREE(module->operations); }
+    module->operations = NULL;
+}
+
+ERROR_CODE mingus_eval(struct state_t *state, struct operation_t *operation) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
 
     /* allocates space for two (temporary) operands and
     for a possible result from operations over them */
@@ -62,14 +326,10 @@ ERROR_CODE mingus_eval(struct state_t *state) {
     int result;
 
     /* switches over the instruction number */
-    switch(instruction->opcode) {
+    switch(operation->opcode) {
         case HALT:
             V_DEBUG("halt\n");
 
-            /* verifies the condition for the instruction
-            execution without any problem */
-            assert(state->so == 0);
-
             /* unsets the running flag */
             state->running = FALSE;
 
@@ -77,34 +337,30 @@ ERROR_CODE mingus_eval(struct state_t *state) {
             break;
 
         case LOAD:
-            V_DEBUG_F("load #%08x (#%08x)\n", instruction->immediate, state->globals[(size_t) instruction->immediate]);
+            V_DEBUG_F("load #%08x (#%08x)\n", operation->operand, (unsigned int) state->globals[(size_t) operation->operand]);
 
             /* loads the value located at the immediate location to the stack and
             increments the stack pointer by such value */
-            MINGUS_PUSH(state, instruction->immediate);
+            MINGUS_PUSH(state, operation->operand);
 
             /* breaks the switch */
             break;
 
         case LOADI:
-            V_DEBUG_F("loadi #%08x\n", instruction->immediate);
+            V_DEBUG_F("loadi #%08x\n", operation->operand);
 
             /* sets the integer in the top of stack and then
             increments the current stack pointer */
-            MINGUS_PUSH(state, instruction->immediate);
+            MINGUS_PUSH(state, operation->operand);
 
             /* breaks the switch */
             break;
 
         case STORE:
-            V_DEBUG_F("store #%08x #%08x\n", instruction->immediate, MINGUS_PEEK(state));
-
-            /* verifies the condition for the instruction
-            execution without any problem */
-            assert(state->so > 0);
+            V_DEBUG_F("store #%08x #%08x\n", operation->operand, MINGUS_PEEK(state));
 
             /* stores the top of the stack in the local storage */
-            state->globals[(size_t) instruction->immediate] = MINGUS_POP(state);
+            state->globals[(size_t) operation->operand] = MINGUS_POP(state);
 
             /* breaks the switch */
             break;
@@ -112,10 +368,6 @@ ERROR_CODE mingus_eval(struct state_t *state) {
         case ADD:
             V_DEBUG_F("add #%08x #%08x\n", MINGUS_PEEK(state), MINGUS_PEEK_OFF(state, 1));
 
-            /* verifies the condition for the instruction
-            execution without any problem */
-            assert(state->so > 1);
-
             /* retrieves both operands from the stack and then pops
             both elements from it */
             operand2 = MINGUS_POP(state);
@@ -131,10 +383,6 @@ ERROR_CODE mingus_eval(struct state_t *state) {
         case SUB:
             V_DEBUG_F("sub #%08x #%08x\n", MINGUS_PEEK(state), MINGUS_PEEK_OFF(state, 1));
 
-            /* verifies the condition for the instruction
-            execution without any problem */
-            assert(state->so > 1);
-
             /* retrieves both operands from the stack and then pops
             both elements from it */
             operand2 = MINGUS_POP(state);
@@ -150,10 +398,6 @@ ERROR_CODE mingus_eval(struct state_t *state) {
         case POP:
             V_DEBUG_F("pop #%08x\n", MINGUS_PEEK(state));
 
-            /* verifies the condition for the instruction
-            execution without any problem */
-            assert(state->so > 0);
-
             /* pops the top element from the stack */
             MINGUS_POP_S(state);
 
@@ -163,15 +407,11 @@ ERROR_CODE mingus_eval(struct state_t *state) {
         case CMP:
             V_DEBUG_F(
                 "cmp '%s' #%08x #%08x\n",
-                operands[(size_t) instruction->arg1],
+                operands[(size_t) operation->arg1],
                 MINGUS_PEEK(state),
                 MINGUS_PEEK_OFF(state, 1)
             );
 
-            /* verifies the condition for the instruction
-            execution without any problem */
-            assert(state->so > 1);
-
             /* retrieves both operands from the stack and then pops
             the second element from it */
             operand2 = MINGUS_POP(state);
@@ -179,7 +419,7 @@ ERROR_CODE mingus_eval(struct state_t *state) {
 
             /* switches over the kind of comparison that is going
             to be performed */
-            switch(instruction->arg1) {
+            switch(operation->arg1) {
                 case 1:
                     result = operand1 == operand2 ? 1 : 0;
                     break;
@@ -187,6 +427,10 @@ ERROR_CODE mingus_eval(struct state_t *state) {
                 case 2:
                     result = operand1 != operand2 ? 1 : 0;
                     break;
+
+                default:
+                    result = 0;
+                    break;
             }
 
             /* pushes the result of the comparison to the stack */
@@ -196,21 +440,17 @@ ERROR_CODE mingus_eval(struct state_t *state) {
             break;
 
         case JMP:
-            V_DEBUG_F("jmp %d\n", instruction->immediate);
+            V_DEBUG_F("jmp %d\n", operation->operand);
 
-            /* increments the program counter with the immediate
-            value of this (relative) jump operation */
-            state->pc += instruction->immediate;
+            /* updates the program counter to the (pre-resolved)
+            absolute target of this relative jump operation */
+            MINGUS_BRANCH(state, state->budget, operation->operand, (void) 0);
 
             /* breaks the switch */
             break;
 
         case JMP_EQ:
-            V_DEBUG_F("jmp_eq %d #%08x\n", instruction->immediate, MINGUS_PEEK(state));
-
-            /* verifies the condition for the instruction
-            execution without any problem */
-            assert(state->so > 0);
+            V_DEBUG_F("jmp_eq %d #%08x\n", operation->operand, MINGUS_PEEK(state));
 
             /* pops the current stack top as the result value that is going
             to be used for the equality validation */
@@ -219,18 +459,14 @@ ERROR_CODE mingus_eval(struct state_t *state) {
             /* compares the current stack top with zero (comparision
             verified) and increments the program counter if that's the case */
             if(result == 1) {
-                state->pc += instruction->immediate;
+                MINGUS_BRANCH(state, state->budget, operation->operand, (void) 0);
             }
 
             /* breaks the switch */
             break;
 
         case JMP_NEQ:
-            V_DEBUG_F("jmp_neq %d #%08x\n", instruction->immediate, MINGUS_PEEK(state));
-
-            /* verifies the condition for the instruction
-            execution without any problem */
-            assert(state->so > 0);
+            V_DEBUG_F("jmp_neq %d #%08x\n", operation->operand, MINGUS_PEEK(state));
 
             /* pops the current stack top as the result value that is going
             to be used for the inequality validation */
@@ -239,34 +475,47 @@ ERROR_CODE mingus_eval(struct state_t *state) {
             /* compares the current stack top with zero (comparision
             failed) and increments the program counter if that's the case */
             if(result == 0) {
-                state->pc += instruction->immediate;
+                MINGUS_BRANCH(state, state->budget, operation->operand, (void) 0);
             }
 
             /* breaks the switch */
             break;
 
         case JMP_ABS:
-            V_DEBUG_F("jmp_abs #%08x\n", instruction->immediate);
+            V_DEBUG_F("jmp_abs #%08x\n", operation->operand);
 
             /* updates the program counter to the immediate
             value of the current instruction (long jump) */
-            state->pc = instruction->immediate;
+            MINGUS_BRANCH(state, state->budget, operation->operand, (void) 0);
 
             /* breaks the switch */
             break;
 
         case CALL:
-            V_DEBUG_F("call #%08x %d\n", instruction->immediate, instruction->arg1);
+            V_DEBUG_F("call #%08x %d\n", operation->operand, operation->arg1);
+
+            /* verifies that the stacks are able to hold the frame and
+            the stack depth of the called function, growing them if
+            required, this is the only bounds check of the stacks */
+            if(MINGUS_RESERVE_CHECK(state, MINGUS_RESERVE(operation))) {
+                return_value = mingus_grow(
+                    state,
+                    state->so + MINGUS_RESERVE(operation),
+                    state->cso + MINGUS_FRAME_SIZE
+                );
+                if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+            }
 
             /* pushes the number of arguments, the function location
             and the current program counter to the stack */
-            MINGUS_CALL_PUSH(state, instruction->arg1)
-            MINGUS_CALL_PUSH(state, instruction->immediate)
+            MINGUS_CALL_PUSH(state, operation->arg1)
+            MINGUS_CALL_PUSH(state, operation->operand)
             MINGUS_CALL_PUSH(state, state->pc)
 
             /* updates the current program counter with the jump location
-            for the function */
-            state->pc = instruction->immediate;
+            for the function and charges the call against the budget */
+            state->pc = operation->operand;
+            MINGUS_CHARGE(state->budget, 1);
 
             /* breaks the switch */
             break;
@@ -286,13 +535,9 @@ ERROR_CODE mingus_eval(struct state_t *state) {
         case PRINT:
             V_DEBUG_F("print #%08x\n", MINGUS_PEEK(state));
 
-            /* verifies the condition for the instruction
-            execution without any problem */
-            assert(state->so > 0);
-
             /* retrieves the current top value from the stack and
-            prints it to the standard output */
-            PRINTF_F("%d\n", state->stack[state->so - 1]);
+            prints it to the output of the state */
+            mingus_print(state, state->stack[state->so - 1]);
 
             /* breaks the switch */
             break;
@@ -300,22 +545,249 @@ ERROR_CODE mingus_eval(struct state_t *state) {
         case PRINTS:
             V_DEBUG_F("prints #%08x\n", MINGUS_PEEK(state));
 
-            /* verifies the condition for the instruction
-            execution without any problem */
-            assert(state->so > 0);
+            /* verifies that the top value from the stack references
+            a string, the only value that is not verified at load */
+            if(!MINGUS_STRING(state, MINGUS_PEEK(state))) {
+                MINGUS_RAISE_M(
+                    state,
+                    RUNTIME_EXCEPTION_ERROR_CODE,
+                    (unsigned char *) "Invalid string reference"
+                );
+            }
 
             /* retrieves the current top value from the stack and
-            prints the string in such address to the standard output */
-            PRINTF_F("%s\n", (char *) state->globals[state->stack[state->so - 1]]);
+            prints the string in such address to the output */
+            mingus_prints(state, (char *) state->globals[state->stack[state->so - 1]]);
+
+            /* breaks the switch */
+            break;
+
+        case RLOAD:
+        case RLOADI:
+            V_DEBUG_F("rload r%d #%08x\n", operation->arg1, operation->operand);
+
+            /* sets the immediate value (global index for the load)
+            in the destination register */
+            MINGUS_REGISTER(state, operation->arg1) = operation->operand;
+
+            /* breaks the switch */
+            break;
+
+        case RSTORE:
+            V_DEBUG_F("rstore r%d #%08x\n", operation->arg1, operation->operand);
+
+            /* stores the value of the register in the global
+            variable at the immediate location */
+            state->globals[(size_t) operation->operand] = MINGUS_REGISTER(state, operation->arg1);
+
+            /* breaks the switch */
+            break;
+
+        case RMOV:
+            V_DEBUG_F("rmov r%d r%d\n", operation->arg1, operation->arg2);
+
+            /* copies the value of the source register into
+            the destination register */
+            MINGUS_REGISTER(state, operation->arg1) = MINGUS_REGISTER(state, operation->arg2);
+
+            /* breaks the switch */
+            break;
+
+        case RADD:
+            V_DEBUG_F("radd r%d r%d r%d\n", operation->arg1, operation->arg2, operation->arg3);
+
+            /* adds both source registers and sets the
+            sum in the destination register */
+            MINGUS_REGISTER(state, operation->arg1) =
+                MINGUS_REGISTER(state, operation->arg2) + MINGUS_REGISTER(state, operation->arg3);
+
+            /* breaks the switch */
+            break;
+
+        case RSUB:
+            V_DEBUG_F("rsub r%d r%d r%d\n", operation->arg1, operation->arg2, operation->arg3);
+
+            /* subtracts both source registers and sets the
+            result in the destination register */
+            MINGUS_REGISTER(state, operation->arg1) =
+                MINGUS_REGISTER(state, operation->arg2) - MINGUS_REGISTER(state, operation->arg3);
+
+            /* breaks the switch */
+            break;
+
+        case RADDI:
+            V_DEBUG_F("raddi r%d %d\n", operation->arg1, operation->operand);
+
+            /* adds the immediate value to the register */
+            MINGUS_REGISTER(state, operation->arg1) += operation->operand;
+
+            /* breaks the switch */
+            break;
+
+        case RSUBI:
+            V_DEBUG_F("rsubi r%d %d\n", operation->arg1, operation->operand);
+
+            /* subtracts the immediate value from the register */
+            MINGUS_REGISTER(state, operation->arg1) -= operation->operand;
+
+            /* breaks the switch */
+            break;
+
+        case RCMP_EQ:
+            V_DEBUG_F("rcmp_eq r%d r%d r%d\n", operation->arg1, operation->arg2, operation->arg3);
+
+            /* compares both source registers for equality and sets
+            the result (one or zero) in the destination register */
+            MINGUS_REGISTER(state, operation->arg1) =
+                MINGUS_REGISTER(state, operation->arg2) == MINGUS_REGISTER(state, operation->arg3) ? 1 : 0;
+
+            /* breaks the switch */
+            break;
+
+        case RCMP_NEQ:
+            V_DEBUG_F("rcmp_neq r%d r%d r%d\n", operation->arg1, operation->arg2, operation->arg3);
+
+            /* compares both source registers for inequality and sets
+            the result (one or zero) in the destination register */
+            MINGUS_REGISTER(state, operation->arg1) =
+                MINGUS_REGISTER(state, operation->arg2) != MINGUS_REGISTER(state, operation->arg3) ? 1 : 0;
+
+            /* breaks the switch */
+            break;
+
+        case RJMP_EQ:
+            V_DEBUG_F("rjmp_eq r%d %d\n", operation->arg1, operation->operand);
+
+            /* jumps in case the register contains a successful
+            comparison result (same as the stack based jump) */
+            if(MINGUS_REGISTER(state, operation->arg1) == 1) {
+                MINGUS_BRANCH(state, state->budget, operation->operand, (void) 0);
+            }
+
+            /* breaks the switch */
+            break;
+
+        case RJMP_NEQ:
+            V_DEBUG_F("rjmp_neq r%d %d\n", operation->arg1, operation->operand);
+
+            /* jumps in case the register contains a failed
+            comparison result, meaning a zero value */
+            if(MINGUS_REGISTER(state, operation->arg1) == 0) {
+                MINGUS_BRANCH(state, state->budget, operation->operand, (void) 0);
+            }
+
+            /* breaks the switch */
+            break;
+
+        case RJMP_NZ:
+            V_DEBUG_F("rjmp_nz r%d %d\n", operation->arg1, operation->operand);
+
+            /* jumps in case the register contains any
+            value other than zero */
+            if(MINGUS_REGISTER(state, operation->arg1) != 0) {
+                MINGUS_BRANCH(state, state->budget, operation->operand, (void) 0);
+            }
+
+            /* breaks the switch */
+            break;
+
+        case RPRINT:
+            V_DEBUG_F("rprint r%d\n", operation->arg1);
+
+            /* prints the value of the register to the
+            output of the state */
+            mingus_print(state, MINGUS_REGISTER(state, operation->arg1));
+
+            /* breaks the switch */
+            break;
+
+        case RPRINTS:
+            V_DEBUG_F("rprints r%d\n", operation->arg1);
+
+            /* verifies that the register references a string */
+            if(!MINGUS_STRING(state, MINGUS_REGISTER(state, operation->arg1))) {
+                MINGUS_RAISE_M(
+                    state,
+                    RUNTIME_EXCEPTION_ERROR_CODE,
+                    (unsigned char *) "Invalid string reference"
+                );
+            }
+
+            /* prints the string in the global address contained
+            in the register to the output of the state */
+            mingus_prints(state, (char *) state->globals[MINGUS_REGISTER(state, operation->arg1)]);
+
+            /* breaks the switch */
+            break;
+
+        case ADDI:
+            V_DEBUG_F("addi #%08x %d\n", MINGUS_PEEK(state), operation->operand);
+
+            /* adds the immediate value to the top of the stack
+            and skips the (fused) add operation */
+            MINGUS_PEEK(state) += operation->operand;
+            state->pc++;
+
+            /* breaks the switch */
+            break;
+
+        case SUBI:
+            V_DEBUG_F("subi #%08x %d\n", MINGUS_PEEK(state), operation->operand);
+
+            /* subtracts the immediate value from the top of the
+            stack and skips the (fused) sub operation */
+            MINGUS_PEEK(state) -= operation->operand;
+            state->pc++;
+
+            /* breaks the switch */
+            break;
+
+        case CMPI_JMP_EQ:
+        case CMPI_JMP_NEQ:
+            V_DEBUG_F(
+                "cmpi_jmp '%s' #%08x %d %d\n",
+                operands[(size_t) operation->arg1],
+                MINGUS_PEEK(state),
+                operation->operand,
+                (operation + 2)->operand
+            );
+
+            /* compares the top of the stack with the immediate
+            value (no stack changes) using the requested kind of
+            comparison and the branches accordingly */
+            operand1 = MINGUS_PEEK(state);
+            operand2 = operation->operand;
+            switch(operation->arg1) {
+                case 1:
+                    result = operand1 == operand2 ? 1 : 0;
+                    break;
+
+                case 2:
+                    result = operand1 != operand2 ? 1 : 0;
+                    break;
+
+                default:
+                    result = 0;
+                    break;
+            }
+
+            /* jumps to the target (of the fused jump) in case the
+            branch is taken, otherwise skips the fused cmp and jump */
+            if(result == (operation->opcode == CMPI_JMP_EQ ? 1 : 0)) {
+                MINGUS_BRANCH(state, state->budget, (operation + 2)->operand, (void) 0);
+            } else {
+                state->pc += 2;
+            }
 
             /* breaks the switch */
             break;
 
         default:
-            RAISE_ERROR_F(
+            MINGUS_RAISE_F(
+                state,
                 RUNTIME_EXCEPTION_ERROR_CODE,
                 (unsigned char *) "Invalid opcode '%d'",
-                instruction->opcode
+                operation->opcode
             );
     }
 
@@ -324,130 +796,1169 @@ ERROR_CODE mingus_eval(struct state_t *state) {
     RAISE_NO_ERROR;
 }
 
-ERROR_CODE run(char *file_path) {
-    /* allocates space for some local variables to be
-    used for internal function operations */
-    unsigned int index;
+ERROR_CODE mingus_run_switch(struct state_t *state) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* allocates space for the pointer to the (pre-decoded)
+    operation that is going to be evaluated */
+    struct operation_t *operation;
+
+    /* iterates while the running flag is set and there's still
+    budget left for the execution of more operations, the budget
+    is only charged by the backward branches and calls */
+    while(state->running == TRUE && state->budget != 0) {
+
+        /* writes the trace record for the operation that is
+        about to be executed (only if tracing is compiled in) */
+        MINGUS_TRACE_STEP(state);
+
+        /* fetches the next (already decoded) operation, counting
+        it, and then evaluates it against the current state */
+        operation = mingus_fetch(state);
+        state->steps++;
+        return_value = mingus_eval(state, operation);
+        if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+    }
+
+    /* normal returns of the function with no error */
+    RAISE_NO_ERROR;
+}
+
+#ifdef MINGUS_THREADED_DISPATCH
+
+/**
+ * Jumps directly to the handler of the next operation,
+ * fetching it inline (no function calls) so that each
+ * handler ends with its own indirect branch, the opcode
+ * has already been validated by the loader.
+ *
+ * The budget is not verified here but only at backward
+ * branches and calls, once exhausted the program counter
+ * points to the branch target where the execution is
+ * going to be resumed.
+ */
+#define MINGUS_DISPATCH()\
+    do {\
+        MINGUS_TRACE_STEP(state);\
+        operation = &state->operations[state->pc++];\
+        steps++;\
+        goto *handlers[operation->opcode];\
+    } while(0)
+
+/**
+ * Stores the local copies of the budget and of the number
+ * of dispatched operations back into the state, before
+ * leaving the engine.
+ */
+#define MINGUS_SAVE()\
+    do {\
+        state->budget = budget;\
+        state->steps = steps;\
+    } while(0)
+
+/**
+ * Branches to the target charging the (local copy of the)
+ * budget in case of a backward branch, leaving the engine
+ * in case the budget is exhausted.
+ */
+#define MINGUS_JUMP(target) MINGUS_BRANCH(state, budget, target, goto exhausted)
+
+ERROR_CODE mingus_run_threaded(struct state_t *state) {
+    /* the table of handler labels indexed by opcode, the
+    order must be kept in sync with the opcodes enumeration */
+    static void *handlers[MINGUS_OPERATION_COUNT] = {
+        &&do_halt,
+        &&do_load,
+        &&do_loadi,
+        &&do_store,
+        &&do_add,
+        &&do_sub,
+        &&do_pop,
+        &&do_cmp,
+        &&do_jmp,
+        &&do_jmp_eq,
+        &&do_jmp_neq,
+        &&do_jmp_abs,
+        &&do_call,
+        &&do_ret,
+        &&do_print,
+        &&do_prints,
+        &&do_rload,
+        &&do_rloadi,
+        &&do_rstore,
+        &&do_rmov,
+        &&do_radd,
+        &&do_rsub,
+        &&do_raddi,
+        &&do_rsubi,
+        &&do_rcmp_eq,
+        &&do_rcmp_neq,
+        &&do_rjmp_eq,
+        &&do_rjmp_neq,
+        &&do_rjmp_nz,
+        &&do_rprint,
+        &&do_rprints,
+        &&do_loadi,
+        &&do_rloadi,
+        &&do_call,
+        &&do_addi,
+        &&do_subi,
+        &&do_cmpi_jmp_eq,
+        &&do_cmpi_jmp_neq
+    };
 
     /* allocates the value to be used to verify the
     existence of error from the function */
     ERROR_CODE return_value;
 
-    /* allocates the space for the instruction
-    value (its a "normal" integer value, 32 bit)*/
-    int instruction;
+    /* allocates space for the pointer to the current
+    (pre-decoded) operation being executed */
+    struct operation_t *operation;
 
-    /* allocates space for the variable that will
-    hold the size of the bytecode buffer and for
-    the buffer that will hold the bytecode */
-    size_t size;
-    unsigned char *buffer;
+    /* allocates space for two (temporary) operands and
+    for a possible result from operations over them */
+    int operand1;
+    int operand2;
+    int result;
+
+    /* copies the instruction budget and the number of dispatched
+    operations into local variables so that they may be kept in
+    registers during the execution */
+    unsigned long long budget = state->budget;
+    unsigned long long steps = state->steps;
+
+    /* starts the execution by dispatching the first instruction
+    (unless there's no budget), from this point on control only
+    flows between handlers */
+    if(budget == 0) { RAISE_NO_ERROR; }
+    MINGUS_DISPATCH();
+
+exhausted:
+    MINGUS_SAVE();
+    RAISE_NO_ERROR;
+
+do_halt:
+    V_DEBUG("halt\n");
+    state->running = FALSE;
+    MINGUS_SAVE();
+    RAISE_NO_ERROR;
+
+do_load:
+    V_DEBUG_F("load #%08x\n", operation->operand);
+    MINGUS_PUSH(state, operation->operand);
+    MINGUS_DISPATCH();
+
+do_loadi:
+    V_DEBUG_F("loadi #%08x\n", operation->operand);
+    MINGUS_PUSH(state, operation->operand);
+    MINGUS_DISPATCH();
+
+do_store:
+    V_DEBUG_F("store #%08x #%08x\n", operation->operand, MINGUS_PEEK(state));
+    state->globals[(size_t) operation->operand] = MINGUS_POP(state);
+    MINGUS_DISPATCH();
+
+do_add:
+    V_DEBUG_F("add #%08x #%08x\n", MINGUS_PEEK(state), MINGUS_PEEK_OFF(state, 1));
+    operand2 = MINGUS_POP(state);
+    operand1 = MINGUS_POP(state);
+    MINGUS_PUSH(state, operand1 + operand2);
+    MINGUS_DISPATCH();
+
+do_sub:
+    V_DEBUG_F("sub #%08x #%08x\n", MINGUS_PEEK(state), MINGUS_PEEK_OFF(state, 1));
+    operand2 = MINGUS_POP(state);
+    operand1 = MINGUS_POP(state);
+    MINGUS_PUSH(state, operand1 - operand2);
+    MINGUS_DISPATCH();
+
+do_pop:
+    V_DEBUG_F("pop #%08x\n", MINGUS_PEEK(state));
+    MINGUS_POP_S(state);
+    MINGUS_DISPATCH();
+
+do_cmp:
+    V_DEBUG_F(
+        "cmp '%s' #%08x #%08x\n",
+        operands[(size_t) operation->arg1],
+        MINGUS_PEEK(state),
+        MINGUS_PEEK_OFF(state, 1)
+    );
+    operand2 = MINGUS_POP(state);
+    operand1 = MINGUS_PEEK(state);
+    switch(operation->arg1) {
+        case 1:
+            result = operand1 == operand2 ? 1 : 0;
+            break;
+
+        case 2:
+            result = operand1 != operand2 ? 1 : 0;
+            break;
 
-    /* creates the virtual machine state, no program
-    buffer is already set (deferred loading) */
-    struct state_t state = { 1, 0, 0, 0, NULL };
+        default:
+            result = 0;
+            break;
+    }
+    MINGUS_PUSH(state, result);
+    MINGUS_DISPATCH();
+
+do_jmp:
+    V_DEBUG_F("jmp %d\n", operation->operand);
+    MINGUS_JUMP(operation->operand);
+    MINGUS_DISPATCH();
+
+do_jmp_eq:
+    V_DEBUG_F("jmp_eq %d #%08x\n", operation->operand, MINGUS_PEEK(state));
+    result = MINGUS_POP(state);
+    if(result == 1) { MINGUS_JUMP(operation->operand); }
+    MINGUS_DISPATCH();
+
+do_jmp_neq:
+    V_DEBUG_F("jmp_neq %d #%08x\n", operation->operand, MINGUS_PEEK(state));
+    result = MINGUS_POP(state);
+    if(result == 0) { MINGUS_JUMP(operation->operand); }
+    MINGUS_DISPATCH();
+
+do_jmp_abs:
+    V_DEBUG_F("jmp_abs #%08x\n", operation->operand);
+    MINGUS_JUMP(operation->operand);
+    MINGUS_DISPATCH();
+
+do_call:
+    V_DEBUG_F("call #%08x %d\n", operation->operand, operation->arg1);
+    if(MINGUS_RESERVE_CHECK(state, MINGUS_RESERVE(operation))) {
+        return_value = mingus_grow(
+            state,
+            state->so + MINGUS_RESERVE(operation),
+            state->cso + MINGUS_FRAME_SIZE
+        );
+        if(IS_ERROR_CODE(return_value)) { MINGUS_SAVE(); RAISE_AGAIN(return_value); }
+    }
+    MINGUS_CALL_PUSH(state, operation->arg1)
+    MINGUS_CALL_PUSH(state, operation->operand)
+    MINGUS_CALL_PUSH(state, state->pc)
+    state->pc = operation->operand;
+    MINGUS_CHARGE(budget, 1);
+    if(budget == 0) { goto exhausted; }
+    MINGUS_DISPATCH();
+
+do_ret:
+    V_DEBUG("ret\n");
+    state->pc = MINGUS_CALL_POP(state);
+    MINGUS_CALL_POP_S(state);
+    MINGUS_CALL_POP_S(state);
+    MINGUS_DISPATCH();
+
+do_print:
+    V_DEBUG_F("print #%08x\n", MINGUS_PEEK(state));
+    mingus_print(state, state->stack[state->so - 1]);
+    MINGUS_DISPATCH();
+
+do_prints:
+    V_DEBUG_F("prints #%08x\n", MINGUS_PEEK(state));
+    if(!MINGUS_STRING(state, MINGUS_PEEK(state))) {
+        MINGUS_SAVE();
+        MINGUS_RAISE_M(state, RUNTIME_EXCEPTION_ERROR_CODE, (unsigned char *) "Invalid string reference");
+    }
+    mingus_prints(state, (char *) state->globals[state->stack[state->so - 1]]);
+    MINGUS_DISPATCH();
+
+do_rload:
+do_rloadi:
+    V_DEBUG_F("rload r%d #%08x\n", operation->arg1, operation->operand);
+    MINGUS_REGISTER(state, operation->arg1) = operation->operand;
+    MINGUS_DISPATCH();
+
+do_rstore:
+    V_DEBUG_F("rstore r%d #%08x\n", operation->arg1, operation->operand);
+    state->globals[(size_t) operation->operand] = MINGUS_REGISTER(state, operation->arg1);
+    MINGUS_DISPATCH();
+
+do_rmov:
+    V_DEBUG_F("rmov r%d r%d\n", operation->arg1, operation->arg2);
+    MINGUS_REGISTER(state, operation->arg1) = MINGUS_REGISTER(state, operation->arg2);
+    MINGUS_DISPATCH();
+
+do_radd:
+    V_DEBUG_F("radd r%d r%d r%d\n", operation->arg1, operation->arg2, operation->arg3);
+    MINGUS_REGISTER(state, operation->arg1) =
+        MINGUS_REGISTER(state, operation->arg2) + MINGUS_REGISTER(state, operation->arg3);
+    MINGUS_DISPATCH();
+
+do_rsub:
+    V_DEBUG_F("rsub r%d r%d r%d\n", operation->arg1, operation->arg2, operation->arg3);
+    MINGUS_REGISTER(state, operation->arg1) =
+        MINGUS_REGISTER(state, operation->arg2) - MINGUS_REGISTER(state, operation->arg3);
+    MINGUS_DISPATCH();
+
+do_raddi:
+    V_DEBUG_F("raddi r%d %d\n", operation->arg1, operation->operand);
+    MINGUS_REGISTER(state, operation->arg1) += operation->operand;
+    MINGUS_DISPATCH();
+
+do_rsubi:
+    V_DEBUG_F("rsubi r%d %d\n", operation->arg1, operation->operand);
+    MINGUS_REGISTER(state, operation->arg1) -= operation->operand;
+    MINGUS_DISPATCH();
+
+do_rcmp_eq:
+    V_DEBUG_F("rcmp_eq r%d r%d r%d\n", operation->arg1, operation->arg2, operation->arg3);
+    MINGUS_REGISTER(state, operation->arg1) =
+        MINGUS_REGISTER(state, operation->arg2) == MINGUS_REGISTER(state, operation->arg3) ? 1 : 0;
+    MINGUS_DISPATCH();
+
+do_rcmp_neq:
+    V_DEBUG_F("rcmp_neq r%d r%d r%d\n", operation->arg1, operation->arg2, operation->arg3);
+    MINGUS_REGISTER(state, operation->arg1) =
+        MINGUS_REGISTER(state, operation->arg2) != MINGUS_REGISTER(state, operation->arg3) ? 1 : 0;
+    MINGUS_DISPATCH();
+
+do_rjmp_eq:
+    V_DEBUG_F("rjmp_eq r%d %d\n", operation->arg1, operation->operand);
+    if(MINGUS_REGISTER(state, operation->arg1) == 1) { MINGUS_JUMP(operation->operand); }
+    MINGUS_DISPATCH();
+
+do_rjmp_neq:
+    V_DEBUG_F("rjmp_neq r%d %d\n", operation->arg1, operation->operand);
+    if(MINGUS_REGISTER(state, operation->arg1) == 0) { MINGUS_JUMP(operation->operand); }
+    MINGUS_DISPATCH();
+
+do_rjmp_nz:
+    V_DEBUG_F("rjmp_nz r%d %d\n", operation->arg1, operation->operand);
+    if(MINGUS_REGISTER(state, operation->arg1) != 0) { MINGUS_JUMP(operation->operand); }
+    MINGUS_DISPATCH();
+
+do_rprint:
+    V_DEBUG_F("rprint r%d\n", operation->arg1);
+    mingus_print(state, MINGUS_REGISTER(state, operation->arg1));
+    MINGUS_DISPATCH();
+
+do_rprints:
+    V_DEBUG_F("rprints r%d\n", operation->arg1);
+    if(!MINGUS_STRING(state, MINGUS_REGISTER(state, operation->arg1))) {
+        MINGUS_SAVE();
+        MINGUS_RAISE_M(state, RUNTIME_EXCEPTION_ERROR_CODE, (unsigned char *) "Invalid string reference");
+    }
+    mingus_prints(state, (char *) state->globals[MINGUS_REGISTER(state, operation->arg1)]);
+    MINGUS_DISPATCH();
+
+do_addi:
+    V_DEBUG_F("addi #%08x %d\n", MINGUS_PEEK(state), operation->operand);
+    MINGUS_PEEK(state) += operation->operand;
+    state->pc++;
+    MINGUS_DISPATCH();
+
+do_subi:
+    V_DEBUG_F("subi #%08x %d\n", MINGUS_PEEK(state), operation->operand);
+    MINGUS_PEEK(state) -= operation->operand;
+    state->pc++;
+    MINGUS_DISPATCH();
+
+do_cmpi_jmp_eq:
+    V_DEBUG_F("cmpi_jmp_eq #%08x %d %d\n", MINGUS_PEEK(state), operation->operand, (operation + 2)->operand);
+    operand1 = MINGUS_PEEK(state);
+    operand2 = operation->operand;
+    if(operation->arg1 == 1 ? operand1 == operand2 : operation->arg1 == 2 ? operand1 != operand2 : 0) {
+        MINGUS_JUMP((operation + 2)->operand);
+    } else {
+        state->pc += 2;
+    }
+    MINGUS_DISPATCH();
+
+do_cmpi_jmp_neq:
+    V_DEBUG_F("cmpi_jmp_neq #%08x %d %d\n", MINGUS_PEEK(state), operation->operand, (operation + 2)->operand);
+    operand1 = MINGUS_PEEK(state);
+    operand2 = operation->operand;
+    if(operation->arg1 == 1 ? operand1 == operand2 : operation->arg1 == 2 ? operand1 != operand2 : 0) {
+        state->pc += 2;
+    } else {
+        MINGUS_JUMP((operation + 2)->operand);
+    }
+    MINGUS_DISPATCH();
+}
 
-    /* in case the provided file path is not valid raises
-    and error indicating the problem */
-    if(file_path == NULL) {
+#endif
+
+ERROR_CODE mingus_run(struct state_t *state) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* runs the program using the dispatch engine selected
+    at compile time */
+#ifdef MINGUS_THREADED_DISPATCH
+    return_value = mingus_run_threaded(state);
+#else
+    return_value = mingus_run_switch(state);
+#endif
+
+    /* flushes the buffered output once the program has halted
+    (or failed), a resumable execution keeps it buffered */
+    if(state->running == FALSE || IS_ERROR_CODE(return_value)) { mingus_output_flush(&state->output); }
+    return return_value;
+}
+
+ERROR_CODE mingus_create(struct state_t **state_pointer) {
+    /* allocates the state structure, the state is zeroed so that
+    all the stacks, registers and pointers start unset */
+    struct state_t *state = (struct state_t *) MALLOC(sizeof(struct state_t));
+    if(state == NULL) {
         RAISE_ERROR_M(
             RUNTIME_EXCEPTION_ERROR_CODE,
-            (unsigned char *) "No input file"
+            (unsigned char *) "Problem allocating state"
         );
     }
-
-    /* reads the program file and verifies if there was an
-    error if that's the case return immediately */
-    return_value = read_file(file_path, &buffer, &size);
-    if(IS_ERROR_CODE(return_value)) {
-        RAISE_ERROR_F(
+    memset(state, 0, sizeof(struct state_t));
+    mingus_output_init(&state->output, 1);
+    state->budget = MINGUS_BUDGET_UNLIMITED;
+    state->stack_limit = MINGUS_STACK_LIMIT;
+    state->call_limit = MINGUS_CALL_LIMIT * MINGUS_FRAME_SIZE;
+
+    /* allocates the initial (small) stacks of the state, these
+    are grown on demand (up to the limits) by the engines */
+    state->stack = (unsigned int *) MALLOC(MINGUS_STACK_INITIAL * sizeof(unsigned int));
+    state->call_stack = (unsigned int *) MALLOC(MINGUS_CALL_INITIAL * MINGUS_FRAME_SIZE * sizeof(unsigned int));
+    if(state->stack == NULL || state->call_stack == NULL) {
+        mingus_delete(state);
+        RAISE_ERROR_M(
             RUNTIME_EXCEPTION_ERROR_CODE,
-            (unsigned char *) "Problem reading file %s",
-            file_path
+            (unsigned char *) "Problem allocating stacks"
         );
     }
+    state->stack_size = MINGUS_STACK_INITIAL;
+    state->call_size = MINGUS_CALL_INITIAL * MINGUS_FRAME_SIZE;
 
-    /* copies the header contents from the file into the header buffer */
-    memcpy((char *) &state.header, (char *) buffer, sizeof(struct code_header_t));
+    /* sets the state in the pointer and returns with no error */
+    *state_pointer = state;
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE mingus_delete(struct state_t *state) {
+    /* releases the reference to the loaded module (if
+    any) and then the state structure itself */
+    if(state->module != NULL) { mingus_module_release(state->module); }
+    if(state->stack != NULL) { FREE(state->stack); }
+    if(state->call_stack != NULL) { FREE(state->call_stack); }
+    if(state->globals != NULL) { FREE(state->globals); }
+    mingus_output_release(&state->output);
+    FREE(state);
+    RAISE_NO_ERROR;
+}
 
-    /* stores the pointer to the complete set of data elements in memory and then
-    updates the global variables with their respective buffer values */
-    state.data_elements = (struct data_element_f *) (buffer + sizeof(struct code_header_t));
-    for(index = 0; index < state.header.data_count; index++) {
-        state.globals[index] = state.data_elements[index].value;
+char *mingus_error(struct state_t *state) {
+    return state->error;
+}
+
+ERROR_CODE mingus_raise(struct state_t *state, ERROR_CODE error) {
+    RAISE_ERROR_F(error, (unsigned char *) "%s", state->error);
+}
+
+void mingus_set_limits(struct state_t *state, size_t stack_limit, size_t call_limit) {
+    /* clamps both limits so that neither the number of entries
+    of the call stack (three per frame) nor the size of any of
+    the stacks (in bytes) wraps around */
+    if(stack_limit > MINGUS_LIMIT_MAX) { stack_limit = MINGUS_LIMIT_MAX; }
+    if(call_limit > MINGUS_LIMIT_MAX / MINGUS_FRAME_SIZE) { call_limit = MINGUS_LIMIT_MAX / MINGUS_FRAME_SIZE; }
+    state->stack_limit = (unsigned int) stack_limit;
+    state->call_limit = (unsigned int) (call_limit * MINGUS_FRAME_SIZE);
+}
+
+/**
+ * Appends the data to the output, inlining the common case of
+ * data that fits in the buffer (no function call).
+ */
+#define MINGUS_OUTPUT_WRITE(output, data, count)\
+    if((output)->size + (count) <= (output)->capacity) {\
+        memcpy((output)->buffer + (output)->size, data, count);\
+        (output)->size += (count);\
+    } else {\
+        mingus_output_write(output, data, count);\
     }
 
-    /* sets the program buffer in the state, effectively initializing
-    the virtual machine */
-    state.program = (unsigned int *) (buffer + sizeof(struct code_header_t) + state.header.data_size);
-    state.running = TRUE;
+static ERROR_CODE output_send(int descriptor, char *data, size_t size) {
+    /* allocates space for the number of bytes written */
+#ifdef _WIN32
+    int count;
+#else
+    ssize_t count;
+#endif
+
+    /* writes the complete data into the descriptor, retrying
+    on partial writes and on interrupted system calls */
+    while(size > 0) {
+#ifdef _WIN32
+        count = _write(descriptor, data, (unsigned int) size);
+#else
+        count = write(descriptor, data, size);
+        if(count < 0 && errno == EINTR) { continue; }
+#endif
+        if(count <= 0) {
+            RAISE_ERROR_M(
+                RUNTIME_EXCEPTION_ERROR_CODE,
+                (unsigned char *) "Problem writing output"
+            );
+        }
+        data += count;
+        size -= (size_t) count;
+    }
 
-    /* iterates while the running flag is set */
-    while(state.running == TRUE) {
-        /* shows the stack, to the default output
-        buffer (standard output) */
-        show_stack(&state);
+    /* raises no error */
+    RAISE_NO_ERROR;
+}
 
-        /* fetches the next instruction, decodes it into
-        the intruction and then evaluates the current state */
-        instruction = mingus_fetch(&state);
-        return_value = mingus_decode(&state, instruction);
-        if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
-        return_value = mingus_eval(&state);
+static ERROR_CODE output_send_vector(int descriptor, char *first, size_t first_size, char *second, size_t second_size) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+#ifndef _WIN32
+    /* allocates space for the vector of buffers and for
+    the number of bytes written */
+    struct iovec vector[2];
+    ssize_t count;
+
+    /* writes both buffers with a single system call, in case
+    of a partial write the rest is written sequentially */
+    vector[0].iov_base = first;
+    vector[0].iov_len = first_size;
+    vector[1].iov_base = second;
+    vector[1].iov_len = second_size;
+    do { count = writev(descriptor, vector, 2); } while(count < 0 && errno == EINTR);
+    if(count < 0) {
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem writing output"
+        );
+    }
+    if((size_t) count < first_size) {
+        first += count;
+        first_size -= (size_t) count;
+    } else {
+        second += (size_t) count - first_size;
+        second_size -= (size_t) count - first_size;
+        first_size = 0;
+    }
+#endif
+
+    /* writes the remaining part of both of the buffers */
+    return_value = output_send(descriptor, first, first_size);
+    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+    return_value = output_send(descriptor, second, second_size);
+    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+    RAISE_NO_ERROR;
+}
+
+void mingus_output_init(struct output_t *output, int descriptor) {
+    output->buffer = NULL;
+    output->size = 0;
+    output->capacity = 0;
+    output->descriptor = descriptor;
+    output->owner = TRUE;
+    output->truncated = FALSE;
+}
+
+ERROR_CODE mingus_output_flush(struct output_t *output) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* in case the output is kept in memory or there's nothing
+    buffered there's nothing to be flushed */
+    if(output->descriptor < 0 || output->size == 0) { RAISE_NO_ERROR; }
+
+    /* writes the buffer into the descriptor, the buffer is
+    emptied even on error (the output is marked truncated) */
+    return_value = output_send(output->descriptor, output->buffer, output->size);
+    output->size = 0;
+    if(IS_ERROR_CODE(return_value)) { output->truncated = TRUE; RAISE_AGAIN(return_value); }
+    RAISE_NO_ERROR;
+}
+
+void mingus_output_release(struct output_t *output) {
+    mingus_output_flush(output);
+    if(output->owner == TRUE && output->buffer != NULL) { FREE(output->buffer); }
+    output->buffer = NULL;
+    output->size = 0;
+    output->capacity = 0;
+}
+
+ERROR_CODE mingus_output_write(struct output_t *output, char *data, size_t size) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* allocates space for the new capacity and buffer */
+    size_t capacity;
+    char *buffer;
+
+    /* in case the data fits in the buffer appends it,
+    this is the common case (no flush nor growth) */
+    if(output->size + size <= output->capacity) {
+        memcpy(output->buffer + output->size, data, size);
+        output->size += size;
+        RAISE_NO_ERROR;
+    }
+
+    /* in case the output is flushed into a descriptor allocates
+    the buffer (on first use), writes data too large to be
+    buffered together with the buffer (single system call) and
+    otherwise flushes the buffer to make room for the data */
+    if(output->descriptor >= 0) {
+        if(output->buffer == NULL) {
+            output->buffer = (char *) MALLOC(MINGUS_OUTPUT_SIZE);
+            if(output->buffer == NULL) { RAISE_AGAIN(output_send(output->descriptor, data, size)); }
+            output->capacity = MINGUS_OUTPUT_SIZE;
+        }
+        if(size >= output->capacity) {
+            return_value = output_send_vector(output->descriptor, output->buffer, output->size, data, size);
+            output->size = 0;
+            if(IS_ERROR_CODE(return_value)) { output->truncated = TRUE; RAISE_AGAIN(return_value); }
+            RAISE_NO_ERROR;
+        }
+        return_value = mingus_output_flush(output);
         if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+        memcpy(output->buffer + output->size, data, size);
+        output->size += size;
+        RAISE_NO_ERROR;
     }
 
-    /* normal returns of the function with no error */
+    /* in case the output is kept in a caller supplied buffer
+    copies the part of the data that fits and drops the rest */
+    if(output->owner == FALSE) {
+        memcpy(output->buffer + output->size, data, output->capacity - output->size);
+        output->size = output->capacity;
+        output->truncated = TRUE;
+        RAISE_NO_ERROR;
+    }
+
+    /* grows the (owned) memory buffer doubling it until the data
+    fits in it, raising an error in case of allocation failure */
+    capacity = output->capacity == 0 ? 4096 : output->capacity;
+    while(output->size + size > capacity) { capacity *= 2; }
+    buffer = (char *) REALLOC(output->buffer, capacity);
+    if(buffer == NULL) {
+        output->truncated = TRUE;
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem allocating output"
+        );
+    }
+    output->buffer = buffer;
+    output->capacity = capacity;
+    memcpy(output->buffer + output->size, data, size);
+    output->size += size;
     RAISE_NO_ERROR;
 }
 
-void show_stack(struct state_t *state) {
-    /* allocates space for the index to be used
-    in the iteration and the allocates space for
-    the buffer for the print information */
-    size_t count;
-    unsigned int index;
-    char buffer[1024];
-    char *pointer;
+void mingus_set_output(struct state_t *state, int descriptor) {
+    mingus_output_release(&state->output);
+    mingus_output_init(&state->output, descriptor);
+}
+
+void mingus_set_output_memory(struct state_t *state, char *buffer, size_t capacity) {
+    mingus_output_release(&state->output);
+    mingus_output_init(&state->output, -1);
+    if(buffer == NULL) { return; }
+    state->output.buffer = buffer;
+    state->output.capacity = capacity;
+    state->output.owner = FALSE;
+}
 
-    /* prints the initial line */
-    count = SPRINTF(buffer, 1024, "%s", "stack => ");
+void mingus_print(struct state_t *state, int value) {
+    /* allocates space for the formatted value, written from
+    the end of the buffer (least significant digit first) */
+    char buffer[16];
+    char *pointer = buffer + sizeof(buffer);
+    unsigned int magnitude = value < 0 ? 0U - (unsigned int) value : (unsigned int) value;
+
+    /* formats the decimal value followed by the newline, with
+    no format string parsing nor locking, and appends it */
+    *--pointer = '\n';
+    do {
+        *--pointer = (char) ('0' + magnitude % 10);
+        magnitude /= 10;
+    } while(magnitude > 0);
+    if(value < 0) { *--pointer = '-'; }
+    MINGUS_OUTPUT_WRITE(&state->output, pointer, (size_t) (buffer + sizeof(buffer) - pointer));
+}
+
+void mingus_prints(struct state_t *state, char *string) {
+    /* appends the string followed by the newline */
+    size_t length = strlen(string);
+    MINGUS_OUTPUT_WRITE(&state->output, string, length);
+    MINGUS_OUTPUT_WRITE(&state->output, "\n", 1);
+}
 
-    /* iterates over all the element currently
-    under the stack (to print it) */
-    for(index = 0; index < state->so; index++) {
-        /* prints the stack information */
-        pointer = &buffer[count];
-        count += SPRINTF(pointer, 1024 - count, "%08x ", state->stack[index]);
+ERROR_CODE mingus_grow(struct state_t *state, size_t stack_size, size_t call_size) {
+    /* allocates space for the new sizes and for the
+    pointers to the (reallocated) stacks */
+    size_t size;
+    unsigned int *pointer;
+
+    /* in case any of the required sizes exceeds the limit of
+    the respective stack raises the overflow error */
+    if(stack_size > state->stack_limit) {
+        MINGUS_RAISE_M(
+            state,
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Stack overflow"
+        );
+    }
+    if(call_size > state->call_limit) {
+        MINGUS_RAISE_M(
+            state,
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Call stack overflow"
+        );
     }
 
-    /* prints the final newline into de buffer and
-    then debugs the stack information */
-    pointer = &buffer[count];
-    SPRINTF(pointer, 1024 - count, "%s", "\n");
-    V_DEBUG_F("%s", buffer);
+    /* grows the data stack geometrically (doubling) until the
+    required size fits, bounded by the limit of the stack */
+    if(stack_size > state->stack_size) {
+        for(size = state->stack_size; size < stack_size; size *= 2) {}
+        if(size > state->stack_limit) { size = state->stack_limit; }
+        pointer = (unsigned int *) REALLOC(state->stack, size * sizeof(unsigned int));
+        if(pointer == NULL) {
+            MINGUS_RAISE_M(
+                state,
+                RUNTIME_EXCEPTION_ERROR_CODE,
+                (unsigned char *) "Problem growing stack"
+            );
+        }
+        state->stack = pointer;
+        state->stack_size = (unsigned int) size;
+    }
+
+    /* grows the call stack the same way (in whole frames) */
+    if(call_size > state->call_size) {
+        for(size = state->call_size; size < call_size; size *= 2) {}
+        if(size > state->call_limit) { size = state->call_limit; }
+        pointer = (unsigned int *) REALLOC(state->call_stack, size * sizeof(unsigned int));
+        if(pointer == NULL) {
+            MINGUS_RAISE_M(
+                state,
+                RUNTIME_EXCEPTION_ERROR_CODE,
+                (unsigned char *) "Problem growing call stack"
+            );
+        }
+        state->call_stack = pointer;
+        state->call_size = (unsigned int) size;
+    }
+
+    /* raises no error */
+    RAISE_NO_ERROR;
 }
 
-int main(int argc, const char *argv[]) {
+ERROR_CODE mingus_module_create(
+    struct module_t **module_pointer,
+    unsigned char *buffer,
+    size_t size,
+    unsigned char fuse,
+    unsigned char owner
+) {
     /* allocates the value to be used to verify the
     existence of error from the function */
     ERROR_CODE return_value;
 
-    /* allocates and starts the pointer to the path
-    of the file to be interpreted, checks if the number
-    of arguments is greater than one and in case it is
-    updates the file path with the second argument */
-    char *file_path = NULL;
-    if(argc > 1) { file_path = (char *) argv[1]; }
+    /* allocates space for the header of the module, for
+    the module to be created and for the sections that are
+    verified before the creation */
+    size_t index;
+    size_t count;
+    size_t width;
+    struct code_header_t header;
+    struct module_t *module;
+    struct data_entry_t *entries;
+    char *values;
+    char *names;
+
+    /* verifies that the buffer is able to hold the header
+    and that it contains a mingus module */
+    if(size < sizeof(struct code_header_t)) {
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Truncated module"
+        );
+    }
+    if(memcmp(buffer, "MING", 4) != 0) {
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Invalid module"
+        );
+    }
+
+    /* copies the header contents from the buffer and verifies
+    that the version matches the one supported by this virtual
+    machine and that all of the sections fit in the buffer */
+    memcpy((char *) &header, (char *) buffer, sizeof(struct code_header_t));
+    if(header.version != MINGUS_CODE_VERSION) {
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Unsupported code version %d (expected %d)",
+            (int) header.version,
+            MINGUS_CODE_VERSION
+        );
+    }
+    if(!MINGUS_SECTION_VALID(header.data_offset, header.data_size, size) ||
+        !MINGUS_SECTION_VALID(header.const_offset, header.const_size, size) ||
+        !MINGUS_SECTION_VALID(header.code_offset, header.code_size, size) ||
+        !MINGUS_SECTION_VALID(header.value_offset, header.value_size, size) ||
+        (header.debug_size > 0 && !MINGUS_SECTION_VALID(header.debug_offset, header.debug_size, size)) ||
+        !MINGUS_SECTION_VALID(header.frame_offset, header.frame_size, size) ||
+        header.frame_size != header.frame_count * sizeof(struct frame_entry_t) ||
+        header.data_size != header.data_count * sizeof(struct data_entry_t) ||
+        header.const_size != header.const_count * sizeof(int) ||
+        header.code_size != header.code_count * sizeof(int)) {
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Truncated module"
+        );
+    }
+
+    /* verifies that the values of each of the data entries are
+    inside the value section and aligned to the width of their
+    type (byte values must be null terminated), so that the
+    values may be used in place */
+    entries = (struct data_entry_t *) (buffer + header.data_offset);
+    values = (char *) (buffer + header.value_offset);
+    for(index = 0; index < header.data_count; index++) {
+        width = MINGUS_DATA_WIDTH(entries[index].type);
+        if(entries[index].type < BYTE_T || entries[index].type > QWORD_T ||
+            entries[index].offset % width != 0 || entries[index].size % width != 0 ||
+            entries[index].offset > header.value_size ||
+            entries[index].size > header.value_size - entries[index].offset ||
+            (entries[index].type == BYTE_T && (entries[index].size == header.value_size - entries[index].offset ||
+            values[entries[index].offset + entries[index].size] != '\0'))) {
+            RAISE_ERROR_F(
+                RUNTIME_EXCEPTION_ERROR_CODE,
+                (unsigned char *) "Invalid data entry '%d'",
+                (int) index
+            );
+        }
+    }
+
+    /* verifies that the debug section (if present) contains
+    one null terminated name per each of the data entries */
+    names = header.debug_size > 0 ? (char *) (buffer + header.debug_offset) : NULL;
+    for(index = 0, count = 0; index < header.debug_size; index++) {
+        if(names[index] == '\0') { count++; }
+    }
+    if(names != NULL && (count != header.data_count || names[header.debug_size - 1] != '\0')) {
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Invalid debug section"
+        );
+    }
 
-    /* runs the virtual machine and verifies if an error
-    as occurred, if that's the case prints it */
-    return_value = run(file_path);
+    /* allocates the module structure and populates it
+    with the header and the buffer references */
+    module = (struct module_t *) MALLOC(sizeof(struct module_t));
+    if(module == NULL) {
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem allocating module"
+        );
+    }
+    memset(module, 0, sizeof(struct module_t));
+    module->references = 1;
+    module->buffer = buffer;
+    module->size = size;
+    module->header = header;
+
+    /* stores the pointers to the various sections of the module,
+    notice that the buffer is referenced and not copied */
+    module->data_entries = entries;
+    module->values = values;
+    module->names = names;
+    module->frames = (struct frame_entry_t *) (buffer + header.frame_offset);
+    module->constants = (int *) (buffer + header.const_offset);
+    module->program = (unsigned int *) (buffer + header.code_offset);
+
+    /* pre-decodes the complete code section into the operations
+    array, verifies it (once, so that the engines run unchecked)
+    and runs the fusion pass over it (unless disabled), from
+    this point on the module is considered immutable */
+    return_value = mingus_load(module);
+    if(!IS_ERROR_CODE(return_value)) { return_value = mingus_verify(module); }
+    if(!IS_ERROR_CODE(return_value) && fuse == TRUE) { return_value = mingus_fuse(module); }
     if(IS_ERROR_CODE(return_value)) {
-        V_ERROR_F("Fatal error (%s)\n", (char *) GET_ERROR());
+        mingus_module_release(module);
         RAISE_AGAIN(return_value);
     }
 
+    /* the ownership of the buffer is only taken on success so
+    that the caller is responsible for it on error */
+    module->owner = owner;
+
+    /* sets the module in the pointer and returns with no error */
+    *module_pointer = module;
+    RAISE_NO_ERROR;
+}
+
+struct module_t *mingus_module_retain(struct module_t *module) {
+    MINGUS_ATOMIC_INC(module->references);
+    return module;
+}
+
+void mingus_module_release(struct module_t *module) {
+    /* decrements the number of references and in case this
+    is the last one releases the module and its buffer */
+    if(MINGUS_ATOMIC_DEC(module->references) > 0) { return; }
+    if(module->operations != NULL) { mingus_unload(module); }
+    if(module->owner == TRUE) { FREE(module->buffer); }
+#ifndef _WIN32
+    if(module->mapped == TRUE) { munmap(module->buffer, module->size); }
+#endif
+    FREE(module);
+}
+
+ERROR_CODE mingus_module_map(struct module_t **module_pointer, char *path, unsigned char fuse) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* allocates space for the buffer (mapping) of the
+    object file and for its size */
+    size_t size;
+    unsigned char *buffer;
+
+#ifndef _WIN32
+    /* allocates space for the descriptor of the file
+    and for the information on it (size) */
+    int descriptor;
+    struct stat information;
+
+    /* opens the object file and maps it (read only) in memory,
+    the descriptor is no longer required once mapped */
+    descriptor = open(path, O_RDONLY);
+    if(descriptor < 0 || fstat(descriptor, &information) != 0) {
+        if(descriptor >= 0) { close(descriptor); }
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem opening file %s",
+            path
+        );
+    }
+    size = (size_t) information.st_size;
+    buffer = size > 0 ? (unsigned char *) mmap(
+        NULL, size, PROT_READ, MAP_PRIVATE, descriptor, 0
+    ) : (unsigned char *) MAP_FAILED;
+    close(descriptor);
+    if(buffer == (unsigned char *) MAP_FAILED) {
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem mapping file %s",
+            path
+        );
+    }
+
+    /* creates the module from the mapping, which is then
+    unmapped together with the module */
+    return_value = mingus_module_create(module_pointer, buffer, size, fuse, FALSE);
+    if(IS_ERROR_CODE(return_value)) { munmap(buffer, size); RAISE_AGAIN(return_value); }
+    (*module_pointer)->mapped = TRUE;
+#else
+    /* reads the complete object file into memory as there's
+    no memory mapping available, the module owns the buffer */
+    return_value = read_file(path, &buffer, &size);
+    if(IS_ERROR_CODE(return_value)) {
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem reading file %s",
+            path
+        );
+    }
+    return_value = mingus_module_create(module_pointer, buffer, size, fuse, TRUE);
+    if(IS_ERROR_CODE(return_value)) { FREE(buffer); RAISE_AGAIN(return_value); }
+#endif
+
+    /* returns with no error */
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE mingus_attach(struct state_t *state, struct module_t *module) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* allocates space for the globals table of the module */
+    size_t *globals;
+
+    /* grows the stack to the depth of the entry frame of the
+    module and allocates its globals table (at least one entry),
+    the state is left unchanged in case of error */
+    return_value = mingus_grow(state, module->reserve, 0);
+    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+    globals = (size_t *) REALLOC(
+        state->globals, (module->global_count + 1) * sizeof(size_t)
+    );
+    if(globals == NULL) {
+        MINGUS_RAISE_M(
+            state,
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem allocating globals"
+        );
+    }
+    state->globals = globals;
+
+    /* acquires the reference to the new module before releasing
+    the previous one (in case both are the same module) */
+    mingus_module_retain(module);
+    if(state->module != NULL) { mingus_module_release(state->module); }
+
+    /* caches the module values required by the engines in
+    the state and resets the execution */
+    state->module = module;
+    state->header = module->header;
+    state->operations = module->operations;
+    mingus_reset(state);
+
     /* returns with no error */
-    return 0;
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE mingus_load_module(struct state_t *state, unsigned char *buffer, size_t size, unsigned char fuse) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* allocates space for the module to be created */
+    struct module_t *module;
+
+    /* creates the module (referencing the buffer) and attaches
+    it to the state, which then holds the only reference, the
+    module errors are process wide so they're copied into the
+    state (consistent with the other errors of the state) */
+    return_value = mingus_module_create(&module, buffer, size, fuse, FALSE);
+    if(IS_ERROR_CODE(return_value)) {
+        MINGUS_RAISE_F(state, return_value, "%s", (char *) GET_ERROR());
+    }
+    return_value = mingus_attach(state, module);
+    mingus_module_release(module);
+    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+
+    /* returns with no error */
+    RAISE_NO_ERROR;
+}
+
+void mingus_reset(struct state_t *state) {
+    /* allocates space for the index of the global
+    variable being initialized */
+    size_t index;
+
+    /* resets the program counter, the stacks and the number of
+    dispatched operations, setting the running flag so that the
+    execution may start */
+    state->running = TRUE;
+    state->pc = 0;
+    state->so = 0;
+    state->cso = 0;
+    state->steps = 0;
+
+    /* clears the registers and global variables, updating the
+    latter with their respective data element values */
+    memset(state->registers, 0, sizeof(state->registers));
+    memset(state->globals, 0, (state->module->global_count + 1) * sizeof(size_t));
+    for(index = 0; index < state->header.data_count; index++) {
+        state->globals[index] = (size_t) (state->module->values + state->module->data_entries[index].offset);
+    }
+}
+
+ERROR_CODE mingus_execute(struct state_t *state, unsigned long long budget) {
+    /* sets the budget in the state and runs the program with the
+    dispatch engine selected at compile time */
+    state->budget = budget;
+    return mingus_run(state);
+}
+
+ERROR_CODE mingus_execute_until(
+    struct state_t *state,
+    unsigned long long budget,
+    unsigned long long deadline,
+    enum mingus_status_e *status
+) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* allocates space for the budget of the current slice */
+    unsigned long long slice;
+
+    /* runs the program in slices of the budget (a single one in
+    case there's no deadline) verifying the deadline between
+    them, until the program halts or the budget is exhausted */
+    while(TRUE) {
+        slice = deadline == 0 || budget < MINGUS_SLICE ? budget : MINGUS_SLICE;
+        state->budget = slice;
+        return_value = mingus_run(state);
+        budget -= slice - state->budget;
+        if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+        if(state->running == FALSE) { *status = MINGUS_HALTED; break; }
+        if(budget == 0) { *status = MINGUS_EXHAUSTED; break; }
+        if(deadline != 0 && mingus_time() >= deadline) { *status = MINGUS_EXPIRED; break; }
+    }
+
+    /* raises no error */
+    RAISE_NO_ERROR;
+}
+
+unsigned long long mingus_time() {
+#ifdef _WIN32
+    /* uses the performance counter converted into nanoseconds
+    (split to avoid overflowing the multiplication) */
+    LARGE_INTEGER counter;
+    LARGE_INTEGER frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (unsigned long long) (counter.QuadPart / frequency.QuadPart) * 1000000000ULL +
+        (unsigned long long) (counter.QuadPart % frequency.QuadPart) * 1000000000ULL /
+        (unsigned long long) frequency.QuadPart;
+#else
+    struct timespec value;
+    clock_gettime(CLOCK_MONOTONIC, &value);
+    return (unsigned long long) value.tv_sec * 1000000000ULL + (unsigned long long) value.tv_nsec;
+#endif
+}
+
+size_t mingus_get_global(struct state_t *state, size_t index) {
+    return state->module != NULL && index < state->module->global_count ? state->globals[index] : 0;
+}
+
+ERROR_CODE mingus_find_global(struct state_t *state, char *name, size_t *index_pointer) {
+    /* allocates space for the index of the global and for
+    the pointer to the current name in the debug section */
+    size_t index;
+    char *pointer;
+
+    /* in case there's no module or the module has been stripped
+    (no names available) raises an error */
+    if(state->module == NULL || state->module->names == NULL) {
+        MINGUS_RAISE_M(
+            state,
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "No debug section available"
+        );
+    }
+
+    /* iterates over the names of the debug section (in the
+    order of the data entries) looking for the requested one */
+    pointer = state->module->names;
+    for(index = 0; index < state->header.data_count; index++) {
+        if(strcmp(pointer, name) == 0) { *index_pointer = index; RAISE_NO_ERROR; }
+        pointer += strlen(pointer) + 1;
+    }
+
+    /* raises an error as no global with the name exists */
+    MINGUS_RAISE_F(
+        state,
+        RUNTIME_EXCEPTION_ERROR_CODE,
+        (unsigned char *) "No global named %s",
+        name
+    );
+}
+
+unsigned int mingus_get_register(struct state_t *state, size_t index) {
+    return index < MINGUS_REGISTER_COUNT ? state->registers[index] : 0;
 }
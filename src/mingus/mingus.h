@@ -25,15 +25,48 @@
  __license__   = Apache License, Version 2.0
 */
 
+#include "trace.h"
+
+/**
+ * The initial number of entries of the (data) stack
+ * of a state, grown on demand up to the stack limit.
+ */
+#define MINGUS_STACK_INITIAL 64
+
+/**
+ * The default hard limit (in entries) of the (data)
+ * stack of a state, reaching it is an overflow.
+ */
+#define MINGUS_STACK_LIMIT 1048576
+
 /**
- * The size of the stack to be used in the
- * runtime of the virtual machine.
+ * The largest limit (in entries) of any of the stacks
+ * of a state, so that its size (in bytes) never wraps.
  */
-#define STACK_SIZE 4096
+#define MINGUS_LIMIT_MAX (((unsigned int) -1) / sizeof(unsigned int))
 
 /**
- * The size of the map of local references to
- * the variables.
+ * The initial number of frames of the call stack of
+ * a state, grown on demand up to the call limit.
+ */
+#define MINGUS_CALL_INITIAL 16
+
+/**
+ * The default hard limit (in frames) of the call
+ * stack of a state, limiting the recursion depth.
+ */
+#define MINGUS_CALL_LIMIT 65536
+
+/**
+ * The number of call stack entries used by each frame
+ * (number of arguments, function and return address).
+ */
+#define MINGUS_FRAME_SIZE 3
+
+/**
+ * The maximum number of global variables of a module beyond
+ * its data elements (created by stores), the global table of
+ * a state is sized per module (data elements have no limit).
  */
 #define LOCALS_SIZE 512
 
@@ -42,7 +75,177 @@
  * use, any change to the structure should
  * increment this value.
  */
-#define MINGUS_CODE_VERSION 1
+#define MINGUS_CODE_VERSION 5
+
+/**
+ * The version of the translation unit file (the
+ * assembled but not linked unit kept in the cache of
+ * the assembler), any change to its structure or to the
+ * assembling of the units should increment this value.
+ */
+#define MINGUS_UNIT_VERSION 1
+
+/**
+ * The alignment (in bytes) of the start of each of the
+ * sections in the object file, so that the sections may
+ * be used in place from a (read only) memory mapping.
+ */
+#define MINGUS_SECTION_ALIGNMENT 8
+
+/**
+ * Aligns the provided offset to the section alignment.
+ */
+#define MINGUS_ALIGN(offset) (((offset) + MINGUS_SECTION_ALIGNMENT - 1) & ~(MINGUS_SECTION_ALIGNMENT - 1))
+
+/**
+ * The size in bytes of each of the values of a data
+ * element of the given type (eg: four for dword).
+ */
+#define MINGUS_DATA_WIDTH(type) ((type) == QWORD_T ? 8 : (type) == DWORD_T ? 4 : (type) == WORD_T ? 2 : 1)
+
+/**
+ * Verifies that the section with the given offset and size
+ * is aligned and fits in the buffer of the given size.
+ */
+#define MINGUS_SECTION_VALID(offset, size, total) ((offset) % MINGUS_SECTION_ALIGNMENT == 0 &&\
+    (offset) >= sizeof(struct code_header_t) && (offset) <= (total) && (size) <= (total) - (offset))
+
+/**
+ * Verifies that the section of a translation unit file with
+ * the given offset and size is aligned and fits in the file.
+ */
+#define MINGUS_UNIT_VALID(offset, size, total) ((offset) % MINGUS_SECTION_ALIGNMENT == 0 &&\
+    (offset) >= sizeof(struct unit_header_t) && (offset) <= (total) && (size) <= (total) - (offset))
+
+/**
+ * The size (in bytes) of the error message buffer of each
+ * state, longer messages are truncated.
+ */
+#define MINGUS_ERROR_SIZE 1024
+
+/**
+ * Raises an error with the provided message in the given state
+ * (instead of the process wide error message), so that states
+ * running in different threads never share an error message.
+ */
+#define MINGUS_RAISE_M(state, code, message)\
+    do {\
+        SPRINTF((state)->error, MINGUS_ERROR_SIZE, "%s", (char *) (message));\
+        return code;\
+    } while(0)
+
+/**
+ * Raises an error with the provided (formatted) message in the
+ * given state, the state equivalent of RAISE_ERROR_F.
+ */
+#define MINGUS_RAISE_F(state, code, format, ...)\
+    do {\
+        SPRINTF((state)->error, MINGUS_ERROR_SIZE, (char *) (format), __VA_ARGS__);\
+        return code;\
+    } while(0)
+
+/**
+ * The instruction budget value meaning that no limit
+ * is imposed on the number of executed operations.
+ */
+#define MINGUS_BUDGET_UNLIMITED ((unsigned long long) -1)
+
+/**
+ * The budget of each of the slices of an execution with a
+ * deadline, the deadline is only verified between slices.
+ */
+#define MINGUS_SLICE 65536
+
+/**
+ * Atomic increment and decrement of a (long) value, used
+ * for the reference counting of the shared modules.
+ */
+#if defined(__GNUC__)
+#define MINGUS_ATOMIC_INC(value) __sync_add_and_fetch(&(value), 1)
+#define MINGUS_ATOMIC_DEC(value) __sync_sub_and_fetch(&(value), 1)
+#elif defined(_WIN32)
+#define MINGUS_ATOMIC_INC(value) InterlockedIncrement(&(value))
+#define MINGUS_ATOMIC_DEC(value) InterlockedDecrement(&(value))
+#else
+#define MINGUS_ATOMIC_INC(value) ++(value)
+#define MINGUS_ATOMIC_DEC(value) --(value)
+#endif
+
+/**
+ * The number of virtual registers available to the
+ * register based instructions (4 bit operand fields).
+ */
+#define MINGUS_REGISTER_COUNT 16
+
+/**
+ * The number of valid opcodes in the instruction
+ * set (both stack and register based instructions),
+ * used to size opcode indexed tables.
+ */
+#define MINGUS_OPCODE_COUNT 34
+
+/**
+ * The number of valid operations at runtime, this
+ * includes the opcodes of the instruction set plus
+ * the superinstructions created by the fusion pass.
+ */
+#define MINGUS_OPERATION_COUNT 38
+
+/**
+ * The (mnemonic) names of the complete set of operations
+ * indexed by opcode, to be used by reporting tools.
+ */
+#define MINGUS_OPERATION_NAMES {\
+    "halt", "load", "loadi", "store", "add", "sub", "pop", "cmp",\
+    "jmp", "jeq", "jneq", "jabs", "call", "ret", "print", "prints",\
+    "rload", "rloadi", "rstore", "rmov", "radd", "rsub", "raddi", "rsubi",\
+    "rcmp_eq", "rcmp_neq", "rjeq", "rjneq", "rjnz", "rprint", "rprints",\
+    "loadk", "rloadk", "callk",\
+    "addi", "subi", "cmpi_jeq", "cmpi_jneq"\
+}
+
+/**
+ * The range of the immediate values in the instruction
+ * word, wide immediates (24 bit) are used by the opcodes
+ * without register operands and narrow ones (16 bit) by the
+ * remaining, larger values must use the constant pool.
+ */
+#define MINGUS_WIDE_MIN -0x00800000
+#define MINGUS_WIDE_MAX 0x007fffff
+#define MINGUS_NARROW_MIN -0x00008000
+#define MINGUS_NARROW_MAX 0x00007fff
+
+/**
+ * Verifies if the opcode uses the wide (24 bit) immediate
+ * encoding, meaning that it has no argument fields.
+ */
+#define MINGUS_WIDE(opcode) ((opcode) == LOAD || (opcode) == LOADI ||\
+    (opcode) == STORE || (opcode) == JMP || (opcode) == JMP_EQ ||\
+    (opcode) == JMP_NEQ || (opcode) == JMP_ABS || (opcode) == LOADK)
+
+/**
+ * The threaded (computed goto) dispatch engine is only
+ * available under compilers that support labels as values
+ * (GCC and Clang), the switch engine is used otherwise.
+ */
+#if defined(MINGUS_THREADED) && defined(__GNUC__)
+#define MINGUS_THREADED_DISPATCH
+#endif
+
+/**
+ * Tracing is compiled in only for debug builds or when
+ * explicitly requested (MINGUS_TRACE), release builds
+ * have no tracing code at all in the execution loops.
+ */
+#if defined(HAVE_DEBUG) && !defined(MINGUS_TRACE)
+#define MINGUS_TRACE
+#endif
+
+#ifdef MINGUS_TRACE
+#define MINGUS_TRACE_STEP(state) if(state->trace != NULL) { mingus_trace_record(state->trace, state); }
+#else
+#define MINGUS_TRACE_STEP(state)
+#endif
 
 #define MINGUS_PUSH(state, value) state->stack[state->so] = value; state->so++;
 #define MINGUS_POP(state) state->stack[state->so - 1]; state->so--
@@ -50,12 +253,60 @@
 #define MINGUS_PEEK(state) state->stack[state->so - 1]
 #define MINGUS_PEEK_OFF(state, offset) state->stack[state->so - offset - 1]
 
+#define MINGUS_REGISTER(state, index) state->registers[index]
+
+/**
+ * Verifies that the global index references a string (byte)
+ * data element, the only check left to the engines as the
+ * value comes from the stack (or a register) at runtime.
+ */
+#define MINGUS_STRING(state, index) ((size_t) (index) < (state)->module->header.data_count &&\
+    (state)->module->data_entries[(size_t) (index)].type == BYTE_T)
+
 #define MINGUS_CALL_PUSH(state, value) state->call_stack[state->cso] = value; state->cso++;
 #define MINGUS_CALL_POP(state) state->call_stack[state->cso - 1]; state->cso--
 #define MINGUS_CALL_POP_S(state) state->cso--
 #define MINGUS_CALL_PEEK(state) state->call_stack[state->cso - 1]
 #define MINGUS_CALL_PEEK_OFF(state, offset) state->call_stack[state->cso - offset - 1]
 
+/**
+ * The number of stack entries to be reserved before
+ * running the function called by the (call) operation,
+ * stored by the loader in the otherwise unused arguments.
+ */
+#define MINGUS_RESERVE(operation) ((unsigned int) (operation)->arg2 | ((unsigned int) (operation)->arg3 << 8))
+
+/**
+ * Verifies (and grows if required) the stacks of the state
+ * before a call to a function with the given reserve, the
+ * only bounds check of the stacks (hoisted out of the pushes).
+ */
+#define MINGUS_RESERVE_CHECK(state, reserve) ((state)->so + (reserve) > (state)->stack_size ||\
+    (state)->cso + MINGUS_FRAME_SIZE > (state)->call_size)
+
+/**
+ * Charges the given cost against the instruction budget,
+ * saturating at zero (exhausted budget).
+ */
+#define MINGUS_CHARGE(budget, cost) if((budget) > (cost)) { (budget) -= (cost); } else { (budget) = 0; }
+
+/**
+ * Sets the program counter to the branch target, charging
+ * the length of the loop (in operations) against the budget
+ * in case the branch is a backward one, the budget is only
+ * verified at backward branches and calls as any unbounded
+ * execution must go through one of them, in case it's
+ * exhausted the given statement is run after the branch.
+ */
+#define MINGUS_BRANCH(state, budget, target, exhausted)\
+    do {\
+        if((unsigned int) (target) < (state)->pc) {\
+            MINGUS_CHARGE(budget, (state)->pc - (unsigned int) (target));\
+            if((budget) == 0) { (state)->pc = (unsigned int) (target); exhausted; }\
+        }\
+        (state)->pc = (unsigned int) (target);\
+    } while(0)
+
 /**
  * Enumeration defining all the opcodes for
  * the various mingus operations.
@@ -77,7 +328,40 @@ typedef enum opcodes_e {
     CALL,
     RET,
     PRINT,
-    PRINTS
+    PRINTS,
+
+    /* register based instructions, operating over the
+    virtual registers (rd, ra, rb in the argument fields) */
+    RLOAD,
+    RLOADI,
+    RSTORE,
+    RMOV,
+    RADD,
+    RSUB,
+    RADDI,
+    RSUBI,
+    RCMP_EQ,
+    RCMP_NEQ,
+    RJMP_EQ,
+    RJMP_NEQ,
+    RJMP_NZ,
+    RPRINT,
+    RPRINTS,
+
+    /* constant pool loads (by index), resolved into the
+    immediate loads at load time and never executed, and the
+    calls to a target in the pool (beyond the immediate range)
+    resolved into the direct calls */
+    LOADK,
+    RLOADK,
+    CALLK,
+
+    /* superinstructions, created by the fusion pass at
+    load time and never present in the bytecode */
+    ADDI,
+    SUBI,
+    CMPI_JMP_EQ,
+    CMPI_JMP_NEQ
 } opcodes;
 
 typedef enum data_types_e {
@@ -88,19 +372,139 @@ typedef enum data_types_e {
     QWORD_T
 } data_types;
 
+/**
+ * Enumeration defining the status of an execution that
+ * returned with no error, only the halted one is final
+ * while the other ones may be resumed by a new execution.
+ */
+typedef enum mingus_status_e {
+    MINGUS_HALTED = 1,
+    MINGUS_EXHAUSTED,
+    MINGUS_EXPIRED
+} mingus_status;
+
+/**
+ * The header of the object file, describing the location
+ * (offset from the beginning of the file) and size of each
+ * of the sections, every section is aligned to the section
+ * alignment so that it may be used in place.
+ */
 typedef struct code_header_t {
     char magic[4];
     unsigned int version;
     unsigned int data_count;
     unsigned int code_count;
+    unsigned int const_count;
+    unsigned int data_offset;
     unsigned int data_size;
+    unsigned int const_offset;
+    unsigned int const_size;
+    unsigned int code_offset;
     unsigned int code_size;
+    unsigned int value_offset;
+    unsigned int value_size;
+    unsigned int debug_offset;
+    unsigned int debug_size;
+    unsigned int frame_count;
+    unsigned int frame_offset;
+    unsigned int frame_size;
+    unsigned int reserved;
 } code_header;
 
+/**
+ * Structure describing the stack frame of a function (or
+ * of the program entry) in the object file, the depth is
+ * the maximum number of stack entries the function pushes
+ * (above the depth at its entry) computed by the assembler.
+ */
+typedef struct frame_entry_t {
+    unsigned int entry;
+    unsigned int depth;
+} frame_entry;
+
+/**
+ * Structure describing a data element in the object file,
+ * the values are packed (aligned to the width of the type)
+ * in the value section at the given offset, byte values
+ * are followed by a null terminator not included in the size.
+ */
+typedef struct data_entry_t {
+    unsigned int type;
+    unsigned int offset;
+    unsigned int size;
+} data_entry;
+
+/**
+ * The header of a translation unit file, an assembled
+ * unit with its own symbol table (the labels it defines)
+ * and relocations (the branches to labels of other units)
+ * identified by the hash and size of its source, every
+ * section is aligned to the section alignment.
+ */
+typedef struct unit_header_t {
+    char magic[4];
+    unsigned int version;
+    unsigned long long hash;
+    unsigned long long size;
+    unsigned int code_count;
+    unsigned int code_offset;
+    unsigned int data_count;
+    unsigned int data_offset;
+    unsigned int value_offset;
+    unsigned int value_size;
+    unsigned int name_offset;
+    unsigned int name_size;
+    unsigned int symbol_count;
+    unsigned int symbol_offset;
+    unsigned int relocation_count;
+    unsigned int relocation_offset;
+    unsigned int string_offset;
+    unsigned int string_size;
+} unit_header;
+
+/**
+ * Structure describing an instruction of a translation
+ * unit file, not yet encoded, with the target (relative
+ * to the start of the unit) in case it's a branch.
+ */
+typedef struct unit_instruction_t {
+    unsigned char opcode;
+    unsigned char arg1;
+    unsigned char arg2;
+    unsigned char arg3;
+    int immediate;
+    unsigned int target;
+} unit_instruction;
+
+/**
+ * Structure describing a data element of a translation
+ * unit file, with the offset of its name in the names.
+ */
+typedef struct unit_data_t {
+    unsigned int type;
+    unsigned int offset;
+    unsigned int size;
+    unsigned int name;
+} unit_data;
+
+/**
+ * Structure describing a symbol (the instruction of
+ * a label) or a relocation (the branch instruction to
+ * a label of another unit) of a translation unit file,
+ * the name is an offset in the strings of the unit.
+ */
+typedef struct unit_symbol_t {
+    unsigned int name;
+    unsigned int instruction;
+} unit_symbol;
+
 typedef struct code_t {
     struct code_header_t header;
-    char *data;
+    struct data_entry_t *data;
+    int *constants;
     char *code;
+    char *values;
+    char *debug;
 } code;
 
 /**
@@ -113,32 +517,51 @@ typedef struct instruction_t {
     char arg1;
     char arg2;
     char arg3;
-    char immediate;
-    unsigned int position;
+    int immediate;
 } instruction;
 
+/**
+ * Structure describing a pre-decoded operation, the
+ * compact runtime representation of an instruction
+ * that is created once at load time.
+ *
+ * The structure is kept at 8 bytes so that a cache
+ * line holds eight consecutive operations, for branch
+ * operations the operand contains the already resolved
+ * absolute target (program counter value).
+ */
+typedef struct operation_t {
+    unsigned char opcode;
+    unsigned char arg1;
+    unsigned char arg2;
+    unsigned char arg3;
+    int operand;
+} operation;
+
 /**
  * Structure describing a full instruction (for
- * assembling) inside mingus virtual machine.
+ * assembling) inside mingus virtual machine, the
+ * position of the instruction is its index plus one
+ * and the label references are kept by the assembler
+ * in a separate list of fixups.
  *
  * This version of the instruction structure should
  * not be used for runtime environments to avoid
  * spending unnecessary memory.
  */
 typedef struct instructionf_t {
-    int code;
     enum opcodes_e opcode;
     char arg1;
     char arg2;
     char arg3;
-    char immediate;
-    char string[128];
-    unsigned int position;
+    int immediate;
 } instructionf;
 
 /**
  * Structure describing a data element (for
- * assembling) inside mingus virtual machine.
+ * assembling) inside mingus virtual machine, the
+ * offset references the packed values buffer and
+ * the name the names buffer of the assembler.
  *
  * This version of the data element structure should
  * not be used for runtime environments to avoid
@@ -146,12 +569,156 @@ typedef struct instructionf_t {
  */
 typedef struct data_elementf_t {
     enum data_types_e type;
+    unsigned int offset;
     unsigned int size;
-    char offset;
-    char name[128];
-    char value[128];
+    unsigned int name;
 } data_elementf;
 
+/**
+ * Structure describing a loaded module, the read only
+ * sections of an object file and its pre-decoded operations.
+ *
+ * The module is immutable once created and reference counted
+ * so that it may be shared by any number of states (running
+ * in any thread), it's released with the last reference.
+ */
+typedef struct module_t {
+    /**
+     * The number of references to the module, updated
+     * atomically (see MINGUS_ATOMIC_INC).
+     */
+    volatile long references;
+
+    /**
+     * The buffer with the contents of the object file,
+     * where the sections of the module are located.
+     */
+    unsigned char *buffer;
+
+    /**
+     * The size in bytes of the object file buffer.
+     */
+    size_t size;
+
+    /**
+     * If the buffer is owned by the module, and should
+     * be released together with it.
+     */
+    unsigned char owner;
+
+    /**
+     * If the buffer is a (read only) memory mapping of the
+     * object file, unmapped together with the module.
+     */
+    unsigned char mapped;
+
+    /**
+     * The header of the object file, copied from the
+     * beginning of the buffer.
+     */
+    struct code_header_t header;
+
+    /**
+     * Pointer to the data entries section of the buffer.
+     */
+    struct data_entry_t *data_entries;
+
+    /**
+     * Pointer to the value section of the buffer, where
+     * the values of the data entries are located.
+     */
+    char *values;
+
+    /**
+     * Pointer to the debug section of the buffer, with the
+     * (null terminated) names of the data entries in order,
+     * unset in case the module has been stripped.
+     */
+    char *names;
+
+    /**
+     * Pointer to the frame section of the buffer, the stack
+     * frames of the functions sorted by their entry.
+     */
+    struct frame_entry_t *frames;
+
+    /**
+     * Pointer to the constant pool section of the buffer,
+     * the values referenced by index in the code.
+     */
+    int *constants;
+
+    /**
+     * Pointer to the code section of the buffer, the
+     * instructions that compose the program.
+     */
+    unsigned int *program;
+
+    /**
+     * The array of pre-decoded operations, one per each
+     * instruction of the program.
+     */
+    struct operation_t *operations;
+
+    /**
+     * The number of stack entries to be reserved before
+     * running the program (stack depth of the entry frame).
+     */
+    unsigned int reserve;
+
+    /**
+     * The number of global variables required by the
+     * module (data elements and stored indexes).
+     */
+    unsigned int global_count;
+} module;
+
+/**
+ * Structure describing the output sink of the prints of a
+ * state, a buffer that is either flushed into a file
+ * descriptor (once full, when the program halts and when
+ * the state is deleted) or that keeps the output in memory,
+ * growing (owned buffer) or truncating (caller buffer).
+ */
+typedef struct output_t {
+    /**
+     * The buffer with the output not yet flushed (or
+     * the complete output in the memory modes).
+     */
+    char *buffer;
+
+    /**
+     * The number of bytes in the buffer and the number
+     * of bytes that fit in it.
+     */
+    size_t size;
+    size_t capacity;
+
+    /**
+     * The file descriptor where the buffer is flushed, a
+     * negative value means that the output is kept in memory.
+     */
+    int descriptor;
+
+    /**
+     * If the buffer is owned (allocated) by the output, a
+     * caller supplied buffer is never grown nor released.
+     */
+    unsigned char owner;
+
+    /**
+     * If part of the output has been dropped, because the
+     * caller supplied buffer is full or a write has failed.
+     */
+    unsigned char truncated;
+} output;
+
+/**
+ * The size of the buffer of the outputs flushed into a
+ * file descriptor, the threshold for the flush.
+ */
+#define MINGUS_OUTPUT_SIZE 65536
+
 /**
  * Structure describing a state of the Mingus
  * virtual machine, a 32 bit based computer like
@@ -183,84 +750,633 @@ typedef struct state_t {
     unsigned int cso;
 
     /**
-     * The pointer to the buffer of instruction
-     * that compose the current program.
+     * The number of operations that may still be executed
+     * before the engine returns (with the running flag still
+     * set), allowing the execution to be resumed later, only
+     * charged at backward branches (loop length) and calls.
      */
-    unsigned int *program;
+    unsigned long long budget;
+
+    /**
+     * The number of operations dispatched by the interpreter
+     * (a fused operation counting once) since the state has
+     * been reset, counted during the execution itself.
+     */
+    unsigned long long steps;
+
+    /**
+     * The (shared) module currently loaded in the state,
+     * a reference to it is held while it's attached.
+     */
+    struct module_t *module;
+
+    /**
+     * The array of pre-decoded operations of the module,
+     * cached in the state as this is the structure that is
+     * effectively used by the execution engines.
+     */
+    struct operation_t *operations;
 
     /**
      * The current data stack of the virtual machine,
      * this structure contains the various values on
      * which the virtual machine can operate.
      */
-    unsigned int stack[STACK_SIZE];
+    unsigned int *stack;
 
     /**
      * The special purpose stack to be used only for calling
      * purposes. Should store things like function address
      * original program counter and number of arguments.
      */
-    unsigned int call_stack[STACK_SIZE];
+    unsigned int *call_stack;
 
     /**
-     * The current set of global variables that can be
-     * used in the virtual machine context.
+     * The number of entries currently allocated for
+     * the data stack and for the call stack.
+     */
+    unsigned int stack_size;
+    unsigned int call_size;
+
+    /**
+     * The hard limits (in entries) up to which the data
+     * stack and the call stack may grow.
      */
-    size_t globals[LOCALS_SIZE];
+    unsigned int stack_limit;
+    unsigned int call_limit;
 
     /**
-     * The current instruction to be executed in the
-     * current virtual machine context (state).
+     * The virtual registers used by the register based
+     * instructions (register machine mode).
      */
-    struct instruction_t instruction;
+    unsigned int registers[MINGUS_REGISTER_COUNT];
 
     /**
-     * The header resulting from the parsing of the
-     * object file currently in read.
+     * The current set of global variables that can be
+     * used in the virtual machine context, sized for
+     * the module currently loaded.
+     */
+    size_t *globals;
+
+    /**
+     * The header of the module currently loaded, copied
+     * from the module when it's attached.
      */
     struct code_header_t header;
 
     /**
-     * Pointer to the data elements section of the reading
-     * buffer so that the global data values can be accessed.
+     * The trace ring buffer where the binary records of
+     * the executed operations are written, only used when
+     * tracing is compiled in and enabled at runtime.
+     */
+    struct trace_t *trace;
+
+    /**
+     * The per instruction counters (indexed by program counter)
+     * of the samples of the sampling profiler, charged by its
+     * timer while the state is being sampled (unset otherwise).
+     */
+    unsigned long long *samples;
+
+    /**
+     * The output sink of the prints, by default buffering
+     * the output of the standard output (descriptor).
+     */
+    struct output_t output;
+
+    /**
+     * The message of the last error raised by an operation
+     * on the state (execution, attach, growth, etc.), kept
+     * in the state so that it's safe across threads.
      */
-    struct data_elementf_t *data_elements;
+    char error[MINGUS_ERROR_SIZE];
 } state;
 
 /**
- * Fetches the next instruction opcode
+ * Structure describing the options for an execution
+ * of the virtual machine, as parsed from the command
+ * line arguments.
+ */
+typedef struct options_t {
+    /**
+     * The path to the object file (program) that is
+     * going to be executed.
+     */
+    char *file_path;
+
+    /**
+     * If the program should be run by the native code
+     * generated by the JIT instead of the interpreter.
+     */
+    unsigned char jit;
+
+    /**
+     * The path to the file where the binary trace of the
+     * execution is going to be written, if tracing is
+     * compiled in (unset means no tracing).
+     */
+    char *trace_path;
+
+    /**
+     * If the fusion pass should be run over the operations
+     * creating superinstructions for common sequences.
+     */
+    unsigned char fuse;
+
+    /**
+     * If the program should be run in profiling mode
+     * reporting the hottest opcode sequences (n-grams).
+     */
+    unsigned char ngrams;
+
+    /**
+     * If the program should be run by both the interpreter
+     * and the JIT with their outputs compared (differential
+     * testing of the JIT backend).
+     */
+    unsigned char diff;
+
+    /**
+     * The hard limit (in entries) of the data stack and
+     * the limit (in frames) of the call stack.
+     */
+    size_t stack_limit;
+    size_t call_limit;
+
+    /**
+     * The maximum number of operations to be run and the
+     * maximum time (in milliseconds, zero for none) of the
+     * execution, stopping runaway programs.
+     */
+    unsigned long long budget;
+    unsigned long long timeout;
+
+    /**
+     * The number of worker threads of the batch mode, in
+     * which every path is run as a job (zero for the single
+     * program mode), and the paths of the programs.
+     */
+    size_t jobs;
+    char **paths;
+    size_t path_count;
+
+    /**
+     * The profiling mode of the execution, either the
+     * instrumented one (every operation measured) or the
+     * sampling one (the program counter sampled by a timer).
+     */
+    unsigned char profile;
+    unsigned char sample;
+
+    /**
+     * The path to the file where the folded stacks of the
+     * instrumented profile are written (unset means none).
+     */
+    char *folded_path;
+
+    /**
+     * If the hardware performance counters should measure
+     * the execution (reported per executed instruction and
+     * per opcode in the instrumented profiling mode).
+     */
+    unsigned char counters;
+
+    /**
+     * If the number of operations dispatched by the interpreter
+     * should be printed (to the standard error) once the execution
+     * finishes, used by the harness to count the instructions of
+     * its measured runs.
+     */
+    unsigned char steps;
+} options;
+
+/**
+ * Fetches the next (pre-decoded) operation
  * and increments the program counter.
  *
  * @param state The current virtual machine state.
- * @return The next instruction opcode.
+ * @return The next operation to be evaluated.
  */
-unsigned int mingus_fetch(struct state_t *state);
+struct operation_t *mingus_fetch(struct state_t *state);
 
 /**
- * Decodes the given instruction, extracting
+ * Decodes the given instruction code, extracting
  * the various sub-components from it and placing
- * the result in global variables.
+ * the result in the provided instruction.
  *
- * @param state The current virtual machine state.
- * @param instruction The instruction to be decoded
- * into the global variables.
+ * @param instruction The instruction structure to
+ * be populated with the decoded values.
+ * @param code The instruction code to be decoded.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_decode(struct instruction_t *instruction, unsigned int code);
+
+/**
+ * Retrieves the stack depth of the function starting at the
+ * given entry from the (sorted) stack frames of the module.
+ *
+ * @param module The module containing the stack frames.
+ * @param entry The entry (program counter) of the function.
+ * @param depth The pointer to be set with the stack depth.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_frame(struct module_t *module, unsigned int entry, unsigned int *depth);
+
+/**
+ * Translates the complete code section of the module
+ * into the array of pre-decoded operations, validating
+ * the opcodes and resolving the branch targets.
+ *
+ * This is meant to be run once after the module is
+ * read so that the engines never decode instructions.
+ *
+ * @param module The module to be pre-decoded.
  * @return The error code on the function execution.
  */
-ERROR_CODE mingus_decode(struct state_t *state, unsigned int instruction);
+ERROR_CODE mingus_load(struct module_t *module);
 
 /**
- * Evaluates the latest decoded instruction, and
+ * Runs the peephole fusion pass over the pre-decoded
+ * operations, replacing common sequences with a single
+ * superinstruction (eg: loadi + add into addi).
+ *
+ * The fused operation is set in the position of the first
+ * operation of the sequence and skips the remaining ones,
+ * which are kept in place so that any branch into the
+ * middle of the sequence remains valid.
+ *
+ * @param module The module to be optimized.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_fuse(struct module_t *module);
+
+/**
+ * Releases the pre-decoded operations created by
+ * the load operation for the provided module.
+ *
+ * @param module The module to be unloaded.
+ */
+void mingus_unload(struct module_t *module);
+
+/**
+ * Evaluates the provided (pre-decoded) operation, and
  * changes the current machine state accordingly.
  *
  * @param state The current virtual machine state.
+ * @param operation The operation to be evaluated.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_eval(struct state_t *state, struct operation_t *operation);
+
+/**
+ * Runs the program loaded in the provided state using
+ * the classic switch based engine, each operation goes
+ * through the fetch and eval functions.
+ *
+ * @param state The current virtual machine state.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_run_switch(struct state_t *state);
+
+/**
+ * Runs the program loaded in the provided state using
+ * the direct threaded engine, where each instruction
+ * handler jumps directly into the next one (computed goto).
+ *
+ * Only available when compiled with labels as values
+ * support (see MINGUS_THREADED_DISPATCH).
+ *
+ * @param state The current virtual machine state.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_run_threaded(struct state_t *state);
+
+/**
+ * Runs the program loaded in the provided state until
+ * the halt instruction is reached, using the dispatch
+ * engine that has been selected at compile time.
+ *
+ * @param state The current virtual machine state.
  * @return The error code on the function execution.
  */
-ERROR_CODE mingus_eval(struct state_t *state);
+ERROR_CODE mingus_run(struct state_t *state);
+
+/**
+ * Creates a new (heap allocated) virtual machine state, each
+ * state is independent from the others so that multiple states
+ * may be used concurrently from different threads.
+ *
+ * @param state_pointer The pointer to be set with the
+ * newly created state.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_create(struct state_t **state_pointer);
+
+/**
+ * Sets the hard limits of the data stack (in entries)
+ * and of the call stack (in frames) of the state, the
+ * stacks start small and grow on demand up to these,
+ * limits beyond the maximum are clamped to it.
+ *
+ * @param state The virtual machine state.
+ * @param stack_limit The limit of the data stack.
+ * @param call_limit The limit of the call stack.
+ */
+void mingus_set_limits(struct state_t *state, size_t stack_limit, size_t call_limit);
+
+/**
+ * Starts the output with an empty buffer that is flushed
+ * into the given file descriptor (allocated on first use),
+ * a negative descriptor keeps the output in memory.
+ *
+ * @param output The output to be started.
+ * @param descriptor The file descriptor of the output.
+ */
+void mingus_output_init(struct output_t *output, int descriptor);
+
+/**
+ * Flushes the buffered output into its file descriptor,
+ * in the memory modes this is a no operation.
+ *
+ * @param output The output to be flushed.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_output_flush(struct output_t *output);
+
+/**
+ * Flushes the output and releases its buffer (if owned),
+ * the output is left with no buffer.
+ *
+ * @param output The output to be released.
+ */
+void mingus_output_release(struct output_t *output);
+
+/**
+ * Appends the given data to the output, flushing the buffer
+ * (descriptor), growing it (owned memory) or truncating the
+ * data (caller memory) in case it does not fit.
+ *
+ * @param output The output.
+ * @param data The data to be appended.
+ * @param size The size in bytes of the data.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_output_write(struct output_t *output, char *data, size_t size);
+
+/**
+ * Sets the output of the state to be buffered and flushed
+ * into the given file descriptor (the previous output is
+ * flushed and released).
+ *
+ * @param state The virtual machine state.
+ * @param descriptor The file descriptor of the output.
+ */
+void mingus_set_output(struct state_t *state, int descriptor);
+
+/**
+ * Sets the output of the state to be kept in memory, in the
+ * caller supplied buffer (truncating once full) or in case
+ * it's unset in a growing buffer owned by the state, the
+ * output is available in the buffer and size of the output.
+ *
+ * @param state The virtual machine state.
+ * @param buffer The caller supplied buffer (or NULL).
+ * @param capacity The size in bytes of the caller buffer.
+ */
+void mingus_set_output_memory(struct state_t *state, char *buffer, size_t capacity);
+
+/**
+ * Prints the integer value (followed by a newline) to
+ * the output of the state, used by all the engines.
+ *
+ * @param state The virtual machine state.
+ * @param value The value to be printed.
+ */
+void mingus_print(struct state_t *state, int value);
+
+/**
+ * Prints the string (followed by a newline) to the
+ * output of the state, used by all the engines.
+ *
+ * @param state The virtual machine state.
+ * @param string The string to be printed.
+ */
+void mingus_prints(struct state_t *state, char *string);
+
+/**
+ * Grows the stacks of the state so that they are able to
+ * hold (at least) the given number of entries, raising an
+ * overflow error in case the limits would be exceeded.
+ *
+ * @param state The virtual machine state.
+ * @param stack_size The required data stack entries.
+ * @param call_size The required call stack entries.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_grow(struct state_t *state, size_t stack_size, size_t call_size);
+
+/**
+ * Deletes the provided state releasing the reference to
+ * the loaded module (if any).
+ *
+ * @param state The virtual machine state to be deleted.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_delete(struct state_t *state);
+
+/**
+ * Retrieves the message of the last error raised by an
+ * operation on the state, safe to use from any thread
+ * (unlike the process wide error message).
+ *
+ * @param state The virtual machine state.
+ * @return The message of the last error of the state.
+ */
+char *mingus_error(struct state_t *state);
+
+/**
+ * Raises the error of the state again as the process wide
+ * error message, for the (single threaded) callers that
+ * report the error only after the state is deleted.
+ *
+ * @param state The virtual machine state that has failed.
+ * @param error The error code to be raised.
+ * @return The provided error code.
+ */
+ERROR_CODE mingus_raise(struct state_t *state, ERROR_CODE error);
+
+/**
+ * Creates a new module from the object file contents in the
+ * provided buffer, validating and pre-decoding it, the module
+ * is returned with a single reference (owned by the caller).
+ *
+ * @param module_pointer The pointer to be set with the module.
+ * @param buffer The buffer containing the object file.
+ * @param size The size in bytes of the buffer.
+ * @param fuse If the fusion pass should be run.
+ * @param owner If the buffer is owned by the module and should
+ * be released with it, otherwise it must remain valid while
+ * the module is in use.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_module_create(
+    struct module_t **module_pointer,
+    unsigned char *buffer,
+    size_t size,
+    unsigned char fuse,
+    unsigned char owner
+);
+
+/**
+ * Creates a new module from the object file in the provided
+ * path, the file is mapped (read only) in memory and its
+ * sections are used in place, so that the pages are loaded
+ * lazily and shared between processes (read into memory
+ * where mapping is not available).
+ *
+ * @param module_pointer The pointer to be set with the module.
+ * @param path The path to the object file.
+ * @param fuse If the fusion pass should be run.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_module_map(struct module_t **module_pointer, char *path, unsigned char fuse);
+
+/**
+ * Acquires a new reference to the provided module.
+ *
+ * @param module The module to be retained.
+ * @return The module (for convenience).
+ */
+struct module_t *mingus_module_retain(struct module_t *module);
+
+/**
+ * Releases a reference to the provided module, the module
+ * is destroyed once its last reference is released.
+ *
+ * @param module The module to be released.
+ */
+void mingus_module_release(struct module_t *module);
+
+/**
+ * Attaches the (shared) module to the state, acquiring a
+ * reference to it and releasing the previous one, the state
+ * is reset so that the execution starts from the beginning.
+ *
+ * The globals table is sized for the module and the stack
+ * is grown to the depth of the entry frame of the module.
+ *
+ * @param state The virtual machine state.
+ * @param module The module to be attached.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_attach(struct state_t *state, struct module_t *module);
+
+/**
+ * Loads the module (object file contents) in the provided
+ * buffer into the state, validating and pre-decoding it.
+ *
+ * The buffer is referenced by the state (not copied) and
+ * must remain valid until the state is deleted.
+ *
+ * @param state The virtual machine state.
+ * @param buffer The buffer containing the module.
+ * @param size The size in bytes of the buffer.
+ * @param fuse If the fusion pass should be run.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_load_module(struct state_t *state, unsigned char *buffer, size_t size, unsigned char fuse);
+
+/**
+ * Resets the execution of the loaded module, so that the
+ * next run starts from the beginning with clean stacks,
+ * registers and globals.
+ *
+ * @param state The virtual machine state.
+ */
+void mingus_reset(struct state_t *state);
+
+/**
+ * Runs the loaded module for at most the given number of
+ * operations (MINGUS_BUDGET_UNLIMITED for no limit), in case
+ * the budget is exhausted the running flag remains set and
+ * a new call resumes the execution.
+ *
+ * The budget is counted at loop granularity, each backward
+ * branch charges the length of the loop and each call one.
+ *
+ * @param state The virtual machine state.
+ * @param budget The maximum number of operations to run.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_execute(struct state_t *state, unsigned long long budget);
+
+/**
+ * Runs the loaded module for at most the given number of
+ * operations or until the given deadline (monotonic time
+ * in nanoseconds, zero for none), verifying the deadline
+ * between slices of the budget, the status indicates if
+ * the execution halted or if it may be resumed.
+ *
+ * @param state The virtual machine state.
+ * @param budget The maximum number of operations to run.
+ * @param deadline The (monotonic) time at which to stop.
+ * @param status The pointer to be set with the status.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_execute_until(
+    struct state_t *state,
+    unsigned long long budget,
+    unsigned long long deadline,
+    enum mingus_status_e *status
+);
+
+/**
+ * Retrieves the current monotonic time in nanoseconds,
+ * the time base for the execution deadlines.
+ *
+ * @return The current monotonic time in nanoseconds.
+ */
+unsigned long long mingus_time();
+
+/**
+ * Retrieves the value of the global variable with
+ * the provided index (results of the execution).
+ *
+ * @param state The virtual machine state.
+ * @param index The index of the global variable.
+ * @return The value of the global variable.
+ */
+size_t mingus_get_global(struct state_t *state, size_t index);
+
+/**
+ * Finds the index of the global variable (data element)
+ * with the provided name, using the debug section of the
+ * module, an error is raised in case the module has been
+ * stripped or no such global exists.
+ *
+ * @param state The virtual machine state.
+ * @param name The name of the global variable.
+ * @param index_pointer Pointer to the index to be set.
+ * @return The resulting error code.
+ */
+ERROR_CODE mingus_find_global(struct state_t *state, char *name, size_t *index_pointer);
+
+/**
+ * Retrieves the value of the virtual register with
+ * the provided index (results of the execution).
+ *
+ * @param state The virtual machine state.
+ * @param index The index of the register.
+ * @return The value of the register.
+ */
+unsigned int mingus_get_register(struct state_t *state, size_t index);
 
 /**
- * Shows the state of the stack for the provided
- * state structure.
+ * Writes a binary record for the operation about to be
+ * executed (current program counter) into the trace ring
+ * buffer, should be called using MINGUS_TRACE_STEP.
  *
+ * @param trace The trace ring buffer to be written.
  * @param state The current virtual machine state.
  */
-void show_stack(struct state_t *state);
+void mingus_trace_record(struct trace_t *trace, struct state_t *state);
@@ -0,0 +1,176 @@
+/*
+ Mingus Virtual Machine
+ Copyright (c) 2008-2020 Hive Solutions Lda.
+
+ This file is part of Mingus Virtual Machine.
+
+ Mingus Virtual Machine is free software: you can redistribute it and/or modify
+ it under the terms of the Apache License as published by the Apache
+ Foundation, either version 2.0 of the License, or (at your option) any
+ later version.
+
+ Mingus Virtual Machine is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ Apache License for more details.
+
+ You should have received a copy of the Apache License along with
+ Mingus Virtual Machine. If not, see <http://www.apache.org/licenses/>.
+
+ __author__    = João Magalhães <joamag@hive.pt>
+ __version__   = 1.0.0
+ __revision__  = $LastChangedRevision$
+ __date__      = $LastChangedDate$
+ __copyright__ = Copyright (c) 2008-2020 João Magalhães
+ __license__   = Apache License, Version 2.0
+*/
+
+#include "stdafx.h"
+
+#include "mingus.h"
+#include "ngram.h"
+
+const char *opcode_names[MINGUS_OPERATION_COUNT] = MINGUS_OPERATION_NAMES;
+
+static int compare_ngrams(const void *first, const void *second) {
+    unsigned long long first_count = ((struct ngram_t *) first)->count;
+    unsigned long long second_count = ((struct ngram_t *) second)->count;
+    if(first_count == second_count) { return 0; }
+    return first_count < second_count ? 1 : -1;
+}
+
+ERROR_CODE mingus_ngram_run(struct state_t *state, unsigned long long *hits) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* iterates while the running flag is set counting
+    the hit for the current program counter and then
+    running the operation through the switch engine */
+    while(state->running == TRUE) {
+        hits[state->pc]++;
+        return_value = mingus_eval(state, mingus_fetch(state));
+        if(IS_ERROR_CODE(return_value)) { mingus_output_flush(&state->output); RAISE_AGAIN(return_value); }
+    }
+
+    /* flushes the buffered output of the program so that
+    it's written before the report */
+    mingus_output_flush(&state->output);
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE mingus_ngram_report(struct state_t *state, unsigned long long *hits) {
+    /* allocates space for the indexes used in the iteration
+    and for the size of the n-grams being reported */
+    unsigned int index;
+    unsigned int offset;
+    unsigned int hash;
+    unsigned char size;
+
+    /* allocates space for the total number of dispatches
+    and for the list of (unique) n-grams found */
+    unsigned long long total = 0;
+    size_t count;
+    struct ngram_t *ngrams;
+    struct ngram_t *ngram;
+
+    /* allocates space for the (open addressing) hash table of
+    the n-grams, each slot holds the index of an n-gram plus
+    one (zero for an empty slot) and its capacity is a power
+    of two of at least twice the number of instructions */
+    unsigned int *slots;
+    size_t capacity = 2;
+
+    /* counts the total number of executed instructions, used
+    as reference for the percentages in the report */
+    for(index = 0; index < state->header.code_count; index++) {
+        total += hits[index];
+    }
+    PRINTF_F("Executed %llu instructions\n", total);
+
+    /* allocates the list of n-grams, there's at most one
+    (unique) n-gram per instruction for each size */
+    while(capacity < (size_t) state->header.code_count * 2) { capacity *= 2; }
+    ngrams = (struct ngram_t *) MALLOC(state->header.code_count * sizeof(struct ngram_t));
+    slots = (unsigned int *) MALLOC(capacity * sizeof(unsigned int));
+    if(ngrams == NULL || slots == NULL) {
+        if(ngrams != NULL) { FREE(ngrams); }
+        if(slots != NULL) { FREE(slots); }
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem allocating n-grams"
+        );
+    }
+
+    for(size = 2; size <= MINGUS_NGRAM_SIZE; size++) {
+        /* gathers the n-gram starting at each of the executed
+        instructions, merging it with an equal one if found in
+        the hash table (keyed by the opcodes of the n-gram) */
+        count = 0;
+        memset(slots, 0, capacity * sizeof(unsigned int));
+        for(index = 0; index + size <= state->header.code_count; index++) {
+            if(hits[index] == 0) { continue; }
+
+            /* skips the sequences where control never flows from
+            one operation into the next (not possible to fuse) */
+            for(offset = 0; offset + 1 < size; offset++) {
+                switch(state->operations[index + offset].opcode) {
+                    case HALT:
+                    case JMP:
+                    case JMP_ABS:
+                    case CALL:
+                    case RET:
+                        offset = size;
+                        break;
+                }
+            }
+            if(offset > size) { continue; }
+
+            for(offset = 0, hash = 0; offset < size; offset++) {
+                hash = (hash << 8) | state->operations[index + offset].opcode;
+            }
+            hash = (unsigned int) ((hash * 2654435761U) & (capacity - 1));
+            while(slots[hash] != 0) {
+                ngram = &ngrams[slots[hash] - 1];
+                for(offset = 0; offset < size; offset++) {
+                    if(ngram->opcodes[offset] != state->operations[index + offset].opcode) { break; }
+                }
+                if(offset == size) { break; }
+                hash = (unsigned int) ((hash + 1) & (capacity - 1));
+            }
+            if(slots[hash] == 0) {
+                ngram = &ngrams[count];
+                for(offset = 0; offset < size; offset++) {
+                    ngram->opcodes[offset] = state->operations[index + offset].opcode;
+                }
+                ngram->size = size;
+                ngram->count = 0;
+                slots[hash] = (unsigned int) ++count;
+            }
+
+            /* weights the n-gram by the dispatches saved in case
+            it's fused, all of its operations but the first one */
+            ngram = &ngrams[slots[hash] - 1];
+            ngram->count += hits[index] * (size - 1);
+        }
+
+        /* sorts the n-grams by their count (hottest first) and
+        prints the ones at the top of the list */
+        qsort(ngrams, count, sizeof(struct ngram_t), compare_ngrams);
+        PRINTF_F("Hottest %d-grams:\n", (int) size);
+        for(index = 0; index < count && index < MINGUS_NGRAM_LIMIT; index++) {
+            ngram = &ngrams[index];
+            PRINTF_F("  %12llu %6.2f%% ", ngram->count, total ? 100.0 * ngram->count / total : 0.0);
+            for(offset = 0; offset < size; offset++) {
+                PRINTF_F(" %s", opcode_names[ngram->opcodes[offset]]);
+            }
+            PRINTF_F("%s", "\n");
+        }
+    }
+
+    /* releases the list of n-grams and the hash table and
+    returns the control flow with no error */
+    FREE(slots);
+    FREE(ngrams);
+    RAISE_NO_ERROR;
+}
@@ -0,0 +1,77 @@
+/*
+ Mingus Virtual Machine
+ Copyright (c) 2008-2020 Hive Solutions Lda.
+
+ This file is part of Mingus Virtual Machine.
+
+ Mingus Virtual Machine is free software: you can redistribute it and/or modify
+ it under the terms of the Apache License as published by the Apache
+ Foundation, either version 2.0 of the License, or (at your option) any
+ later version.
+
+ Mingus Virtual Machine is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ Apache License for more details.
+
+ You should have received a copy of the Apache License along with
+ Mingus Virtual Machine. If not, see <http://www.apache.org/licenses/>.
+
+ __author__    = João Magalhães <joamag@hive.pt>
+ __version__   = 1.0.0
+ __revision__  = $LastChangedRevision$
+ __date__      = $LastChangedDate$
+ __copyright__ = Copyright (c) 2008-2020 João Magalhães
+ __license__   = Apache License, Version 2.0
+*/
+
+#pragma once
+
+/**
+ * The maximum length of the opcode sequences (n-grams)
+ * that are reported by the profiling mode.
+ */
+#define MINGUS_NGRAM_SIZE 3
+
+/**
+ * The number of n-grams (of each length) that are
+ * listed in the profiling report.
+ */
+#define MINGUS_NGRAM_LIMIT 10
+
+/**
+ * Structure describing an opcode sequence (n-gram) and
+ * the number of dispatches saved in case it's fused.
+ */
+typedef struct ngram_t {
+    unsigned char opcodes[MINGUS_NGRAM_SIZE];
+    unsigned char size;
+    unsigned long long count;
+} ngram;
+
+/**
+ * Runs the program loaded in the provided state counting
+ * the number of times each program counter is executed,
+ * the counts are set in the provided (zeroed) hits array
+ * that must contain one entry per instruction.
+ *
+ * Should be run over unfused operations so that the
+ * reported sequences are the ones in the bytecode.
+ *
+ * @param state The current virtual machine state.
+ * @param hits The array of per instruction counters.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_ngram_run(struct state_t *state, unsigned long long *hits);
+
+/**
+ * Prints a report with the hottest opcode sequences of
+ * each length (from two to MINGUS_NGRAM_SIZE), a sequence
+ * is weighted by the hits of its first instruction times
+ * its size minus one, the dispatches saved by fusing it.
+ *
+ * @param state The virtual machine state that has run.
+ * @param hits The array of per instruction counters.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_ngram_report(struct state_t *state, unsigned long long *hits);
@@ -0,0 +1,347 @@
+/*
+ Mingus Virtual Machine
+ Copyright (c) 2008-2020 Hive Solutions Lda.
+
+ This file is part of Mingus Virtual Machine.
+
+ Mingus Virtual Machine is free software: you can redistribute it and/or modify
+ it under the terms of the Apache License as published by the Apache
+ Foundation, either version 2.0 of the License, or (at your option) any
+ later version.
+
+ Mingus Virtual Machine is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ Apache License for more details.
+
+ You should have received a copy of the Apache License along with
+ Mingus Virtual Machine. If not, see <http://www.apache.org/licenses/>.
+
+ __author__    = João Magalhães <joamag@hive.pt>
+ __version__   = 1.0.0
+ __revision__  = $LastChangedRevision$
+ __date__      = $LastChangedDate$
+ __copyright__ = Copyright (c) 2008-2020 João Magalhães
+ __license__   = Apache License, Version 2.0
+*/
+
+#include "stdafx.h"
+
+#include "mingus.h"
+#include "cache.h"
+#include "pool.h"
+
+#ifndef _WIN32
+#define POOL_LOCK(mutex) pthread_mutex_lock(mutex)
+#define POOL_UNLOCK(mutex) pthread_mutex_unlock(mutex)
+#else
+#define POOL_LOCK(mutex)
+#define POOL_UNLOCK(mutex)
+#endif
+
+static struct job_t *pool_pop(struct worker_t *worker) {
+    /* takes the most recent job from the bottom of the queue
+    of the worker (if any) */
+    struct deque_t *deque = &worker->deque;
+    struct job_t *job = NULL;
+    POOL_LOCK(&deque->mutex);
+    if(deque->bottom > deque->top) {
+        deque->bottom--;
+        job = &worker->pool->jobs[deque->indexes[deque->bottom]];
+    }
+    POOL_UNLOCK(&deque->mutex);
+    return job;
+}
+
+static struct job_t *pool_steal(struct worker_t *worker) {
+    /* allocates space for the offset of the victim worker
+    and for the queue being stolen from */
+    size_t offset;
+    struct deque_t *deque;
+    struct job_t *job = NULL;
+    struct pool_t *pool = worker->pool;
+
+    /* tries to steal the oldest job from the top of the queues
+    of the other workers, starting with the next one */
+    for(offset = 1; offset < pool->threads && job == NULL; offset++) {
+        deque = &pool->workers[(worker->index + offset) % pool->threads].deque;
+        POOL_LOCK(&deque->mutex);
+        if(deque->bottom > deque->top) {
+            job = &pool->jobs[deque->indexes[deque->top]];
+            deque->top++;
+        }
+        POOL_UNLOCK(&deque->mutex);
+    }
+    if(job != NULL) { worker->steals++; }
+    return job;
+}
+
+static void pool_job(struct worker_t *worker, struct job_t *job) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* allocates space for the module and for the state */
+    struct pool_t *pool = worker->pool;
+    struct module_t *module;
+    struct state_t *state;
+
+    /* allocates space for the flag that controls if the error
+    of the job has been raised by the state (and copied) */
+    unsigned char failed = FALSE;
+
+    /* retrieves the (shared) module of the program from the
+    cache and runs it in a new state with the prints kept in
+    (growable) memory, the output is then moved into the job
+    and the error of the state (if any) copied into the job */
+    return_value = mingus_cache_get(pool->cache, job->path, &module);
+    if(!IS_ERROR_CODE(return_value)) {
+        return_value = mingus_create(&state);
+        if(!IS_ERROR_CODE(return_value)) {
+            mingus_set_output_memory(state, NULL, 0);
+            return_value = mingus_attach(state, module);
+            if(!IS_ERROR_CODE(return_value)) {
+                return_value = mingus_execute(state, MINGUS_BUDGET_UNLIMITED);
+            }
+            if(IS_ERROR_CODE(return_value)) {
+                SPRINTF(job->error, sizeof(job->error), "%s", mingus_error(state));
+                failed = TRUE;
+            }
+            job->output = state->output;
+            mingus_output_init(&state->output, -1);
+            mingus_delete(state);
+        }
+        mingus_module_release(module);
+    }
+
+    /* stores the result of the job and in case the outputs are
+    flushed writes it as a whole (releasing it right away, as
+    it's no longer needed), the errors of the loading of
+    the module (or of the creation of the state) are process
+    wide so they're copied under the lock of the pool */
+    job->result = return_value;
+    if(IS_ERROR_CODE(return_value) || pool->flush == TRUE) {
+        POOL_LOCK(&pool->mutex);
+        if(IS_ERROR_CODE(return_value) && failed == FALSE) {
+            SPRINTF(job->error, sizeof(job->error), "%s", (char *) GET_ERROR());
+        }
+        if(pool->flush == TRUE) {
+            if(job->output.size > 0) { fwrite(job->output.buffer, 1, job->output.size, stdout); }
+            fflush(stdout);
+            mingus_output_release(&job->output);
+            if(IS_ERROR_CODE(return_value)) {
+                fprintf(stderr, "Job %s failed (%s)\n", job->path, job->error);
+            }
+        }
+        POOL_UNLOCK(&pool->mutex);
+    }
+    worker->runs++;
+}
+
+static void *pool_worker(void *arguments) {
+    /* runs jobs from the queue of the worker and once it's empty
+    steals them from the other workers, as no new jobs are created
+    while running, no job left in any queue means the end */
+    struct worker_t *worker = (struct worker_t *) arguments;
+    struct job_t *job;
+    while(TRUE) {
+        job = pool_pop(worker);
+        if(job == NULL) { job = pool_steal(worker); }
+        if(job == NULL) { break; }
+        pool_job(worker, job);
+    }
+    return NULL;
+}
+
+ERROR_CODE mingus_pool_create(struct pool_t **pool_pointer, size_t threads, unsigned char flush) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* allocates the pool structure and populates
+    it with the default (empty) values */
+    struct pool_t *pool = (struct pool_t *) MALLOC(sizeof(struct pool_t));
+    if(pool == NULL) {
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem allocating pool"
+        );
+    }
+    pool->jobs = NULL;
+    pool->count = 0;
+    pool->capacity = 0;
+    pool->workers = NULL;
+#ifndef _WIN32
+    pool->threads = threads < 1 ? 1 : threads;
+#else
+    pool->threads = 1;
+#endif
+    pool->flush = flush;
+    return_value = mingus_cache_create(&pool->cache, TRUE);
+    if(IS_ERROR_CODE(return_value)) { FREE(pool); RAISE_AGAIN(return_value); }
+#ifndef _WIN32
+    pthread_mutex_init(&pool->mutex, NULL);
+#endif
+
+    /* sets the pool in the pointer and returns with no error */
+    *pool_pointer = pool;
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE mingus_pool_delete(struct pool_t *pool) {
+    /* allocates space for the index of the job */
+    size_t index;
+
+    /* releases the paths and outputs of the jobs, the module
+    cache (and with it the modules) and then the pool */
+    for(index = 0; index < pool->count; index++) {
+        FREE(pool->jobs[index].path);
+        mingus_output_release(&pool->jobs[index].output);
+    }
+    if(pool->jobs != NULL) { FREE(pool->jobs); }
+    mingus_cache_delete(pool->cache);
+#ifndef _WIN32
+    pthread_mutex_destroy(&pool->mutex);
+#endif
+    FREE(pool);
+
+    /* returns with no error */
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE mingus_pool_add(struct pool_t *pool, char *path) {
+    /* allocates space for the new array of jobs and
+    for the job being added */
+    struct job_t *jobs;
+    struct job_t *job;
+
+    /* grows the array of jobs (doubling it) in case
+    there's no more space for the new job */
+    if(pool->count == pool->capacity) {
+        pool->capacity = pool->capacity == 0 ? 16 : pool->capacity * 2;
+        jobs = (struct job_t *) REALLOC(pool->jobs, pool->capacity * sizeof(struct job_t));
+        if(jobs == NULL) {
+            RAISE_ERROR_M(
+                RUNTIME_EXCEPTION_ERROR_CODE,
+                (unsigned char *) "Problem allocating jobs"
+            );
+        }
+        pool->jobs = jobs;
+    }
+
+    /* populates the new job with a copy of the path and
+    with an empty output buffer */
+    job = &pool->jobs[pool->count];
+    job->path = (char *) MALLOC(strlen(path) + 1);
+    if(job->path == NULL) {
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem allocating job path"
+        );
+    }
+    memcpy(job->path, path, strlen(path) + 1);
+    mingus_output_init(&job->output, -1);
+    job->result = 0;
+    job->error[0] = '\0';
+    pool->count++;
+
+    /* returns with no error */
+    RAISE_NO_ERROR;
+}
+
+static void pool_release(struct pool_t *pool, size_t count) {
+    /* allocates space for the index of the worker */
+    size_t index;
+
+    /* releases the queues of the first workers (the ones that
+    have been initialized) and then the workers */
+    for(index = 0; index < count; index++) {
+        FREE(pool->workers[index].deque.indexes);
+#ifndef _WIN32
+        pthread_mutex_destroy(&pool->workers[index].deque.mutex);
+#endif
+    }
+    FREE(pool->workers);
+    pool->workers = NULL;
+}
+
+ERROR_CODE mingus_pool_run(struct pool_t *pool) {
+    /* allocates space for the index of the worker, for the
+    range of jobs of the worker and for the worker itself */
+    size_t index;
+    size_t position;
+    size_t offset;
+    size_t count;
+    size_t started;
+    struct worker_t *worker;
+
+#ifndef _WIN32
+    /* allocates space for the number of processors (online) */
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+
+    /* clamps the number of workers to the number of jobs and
+    to the number of processors, more workers than any of them
+    would only be idle (or compete for the same processors) */
+    if(pool->threads > pool->count) { pool->threads = pool->count; }
+    if(processors > 0 && pool->threads > (size_t) processors) { pool->threads = (size_t) processors; }
+    if(pool->threads < 1) { pool->threads = 1; }
+#endif
+
+    /* allocates the workers and the (fixed) queues of jobs, the
+    jobs are split in contiguous ranges among the workers, pushed
+    in reverse so that each worker runs its range in order */
+    pool->workers = (struct worker_t *) MALLOC(pool->threads * sizeof(struct worker_t));
+    if(pool->workers == NULL) {
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem allocating workers"
+        );
+    }
+    for(index = 0, offset = 0; index < pool->threads; index++, offset += count) {
+        worker = &pool->workers[index];
+        count = pool->count / pool->threads + (index < pool->count % pool->threads ? 1 : 0);
+        worker->index = index;
+        worker->pool = pool;
+        worker->runs = 0;
+        worker->steals = 0;
+        worker->deque.indexes = (size_t *) MALLOC((count + 1) * sizeof(size_t));
+        if(worker->deque.indexes == NULL) {
+            pool_release(pool, index);
+            RAISE_ERROR_M(
+                RUNTIME_EXCEPTION_ERROR_CODE,
+                (unsigned char *) "Problem allocating job queues"
+            );
+        }
+        worker->deque.top = 0;
+        worker->deque.bottom = count;
+        for(position = 0; position < count; position++) {
+            worker->deque.indexes[position] = offset + count - position - 1;
+        }
+#ifndef _WIN32
+        pthread_mutex_init(&worker->deque.mutex, NULL);
+#endif
+    }
+
+    /* runs the first worker in the current thread and the other
+    ones in their own threads, waiting for all of them to finish,
+    in case a thread can't be created no more are created and the
+    queues of the workers not started are stolen by the others */
+    started = 1;
+#ifndef _WIN32
+    for(; started < pool->threads; started++) {
+        if(pthread_create(&pool->workers[started].thread, NULL, pool_worker, &pool->workers[started]) != 0) { break; }
+    }
+#endif
+    pool_worker(&pool->workers[0]);
+#ifndef _WIN32
+    for(index = 1; index < started; index++) {
+        pthread_join(pool->workers[index].thread, NULL);
+    }
+#endif
+
+    /* releases the workers and their queues */
+    pool_release(pool, pool->threads);
+
+    /* returns with no error */
+    RAISE_NO_ERROR;
+}
@@ -0,0 +1,213 @@
+/*
+ Mingus Virtual Machine
+ Copyright (c) 2008-2020 Hive Solutions Lda.
+
+ This file is part of Mingus Virtual Machine.
+
+ Mingus Virtual Machine is free software: you can redistribute it and/or modify
+ it under the terms of the Apache License as published by the Apache
+ Foundation, either version 2.0 of the License, or (at your option) any
+ later version.
+
+ Mingus Virtual Machine is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ Apache License for more details.
+
+ You should have received a copy of the Apache License along with
+ Mingus Virtual Machine. If not, see <http://www.apache.org/licenses/>.
+
+ __author__    = João Magalhães <joamag@hive.pt>
+ __version__   = 1.0.0
+ __revision__  = $LastChangedRevision$
+ __date__      = $LastChangedDate$
+ __copyright__ = Copyright (c) 2008-2020 João Magalhães
+ __license__   = Apache License, Version 2.0
+*/
+
+#pragma once
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+/**
+ * Structure describing a job of the pool, a program (object
+ * file) to be run, its buffered output and its result.
+ */
+typedef struct job_t {
+    /**
+     * The path to the object file of the program.
+     */
+    char *path;
+
+    /**
+     * The output of the prints of the job, buffered so that
+     * the output of different jobs is never interleaved.
+     */
+    struct output_t output;
+
+    /**
+     * The error code of the execution of the job and the
+     * message of the error (in case of error).
+     */
+    ERROR_CODE result;
+    char error[256];
+} job;
+
+/**
+ * Structure describing the double ended queue of jobs of a
+ * worker, the worker takes jobs from the bottom (most recent)
+ * while the other workers steal them from the top (oldest).
+ */
+typedef struct deque_t {
+    /**
+     * The (fixed) array of job indexes, the queue is filled
+     * before the workers start (jobs never spawn jobs).
+     */
+    size_t *indexes;
+
+    /**
+     * The index of the oldest job (top) and the index after
+     * the most recent job (bottom) of the queue.
+     */
+    size_t top;
+    size_t bottom;
+
+#ifndef _WIN32
+    /**
+     * The mutex protecting the queue, only contended when
+     * another worker is stealing from it.
+     */
+    pthread_mutex_t mutex;
+#endif
+} deque;
+
+/**
+ * Structure describing a worker (thread) of the pool.
+ */
+typedef struct worker_t {
+    /**
+     * The index of the worker in the pool.
+     */
+    size_t index;
+
+    /**
+     * The queue of jobs of the worker.
+     */
+    struct deque_t deque;
+
+    /**
+     * The pool the worker belongs to.
+     */
+    struct pool_t *pool;
+
+    /**
+     * The number of jobs run by the worker and the number
+     * of them that were stolen from other workers.
+     */
+    size_t runs;
+    size_t steals;
+
+#ifndef _WIN32
+    /**
+     * The identifier of the thread running the worker.
+     */
+    pthread_t thread;
+#endif
+} worker;
+
+/**
+ * Structure describing a pool of worker threads running
+ * a batch of jobs (programs) with work stealing, sharing
+ * the modules of the programs through the module cache.
+ */
+typedef struct pool_t {
+    /**
+     * The (growable) array of jobs added to the pool.
+     */
+    struct job_t *jobs;
+
+    /**
+     * The number of jobs in the pool and the number
+     * that fit in the allocated array.
+     */
+    size_t count;
+    size_t capacity;
+
+    /**
+     * The workers of the pool, one per thread.
+     */
+    struct worker_t *workers;
+
+    /**
+     * The number of workers (threads) of the pool.
+     */
+    size_t threads;
+
+    /**
+     * The module cache shared by all the workers.
+     */
+    struct cache_t *cache;
+
+    /**
+     * If the output of each job should be written to the
+     * standard output (as a whole) once the job finishes,
+     * otherwise it's kept in the job for the caller.
+     */
+    unsigned char flush;
+
+#ifndef _WIN32
+    /**
+     * The mutex serializing the writes of the outputs.
+     */
+    pthread_mutex_t mutex;
+#endif
+} pool;
+
+/**
+ * Creates a new (empty) pool with the given number of
+ * worker threads.
+ *
+ * @param pool_pointer The pointer to the pool to be created.
+ * @param threads The number of worker threads.
+ * @param flush If the output of the jobs is written once finished.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_pool_create(struct pool_t **pool_pointer, size_t threads, unsigned char flush);
+
+/**
+ * Deletes the pool, releasing its jobs (and outputs).
+ *
+ * @param pool The pool to be deleted.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_pool_delete(struct pool_t *pool);
+
+/**
+ * Adds a job running the program in the given path
+ * to the pool (the path is copied).
+ *
+ * @param pool The pool.
+ * @param path The path to the object file of the program.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_pool_add(struct pool_t *pool, char *path);
+
+/**
+ * Runs all the jobs of the pool in its worker threads,
+ * returning once all of them have finished, the jobs are
+ * initially split among the workers and the workers with
+ * no more jobs steal them from the other ones.
+ *
+ * The number of workers is clamped to the number of jobs
+ * and to the number of (online) processors, the calling
+ * thread runs the first worker.
+ *
+ * The result of each job is kept in the job, an error is
+ * only raised in case the pool itself fails.
+ *
+ * @param pool The pool.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_pool_run(struct pool_t *pool);
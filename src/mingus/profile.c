@@ -0,0 +1,496 @@
+/*
+ Mingus Virtual Machine
+ Copyright (c) 2008-2020 Hive Solutions Lda.
+
+ This file is part of Mingus Virtual Machine.
+
+ Mingus Virtual Machine is free software: you can redistribute it and/or modify
+ it under the terms of the Apache License as published by the Apache
+ Foundation, either version 2.0 of the License, or (at your option) any
+ later version.
+
+ Mingus Virtual Machine is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ Apache License for more details.
+
+ You should have received a copy of the Apache License along with
+ Mingus Virtual Machine. If not, see <http://www.apache.org/licenses/>.
+
+ __author__    = João Magalhães <joamag@hive.pt>
+ __version__   = 1.0.0
+ __revision__  = $LastChangedRevision$
+ __date__      = $LastChangedDate$
+ __copyright__ = Copyright (c) 2008-2020 João Magalhães
+ __license__   = Apache License, Version 2.0
+*/
+
+#include "stdafx.h"
+
+#include "mingus.h"
+#include "counters.h"
+#include "profile.h"
+
+static const char *profile_names[MINGUS_OPERATION_COUNT] = MINGUS_OPERATION_NAMES;
+static const char *profile_events[MINGUS_COUNTER_COUNT] = MINGUS_COUNTER_NAMES;
+
+#ifndef _WIN32
+
+/**
+ * The state being sampled by the profiling timer, as the timer
+ * is process wide only one state may be sampled at a time.
+ */
+static struct state_t *volatile profile_state = NULL;
+
+#endif
+
+static int compare_hits(const void *first, const void *second) {
+    unsigned long long first_count = **((unsigned long long **) first);
+    unsigned long long second_count = **((unsigned long long **) second);
+    if(first_count == second_count) { return 0; }
+    return first_count < second_count ? 1 : -1;
+}
+
+static int compare_functions(const void *first, const void *second) {
+    unsigned long long first_time = ((struct profile_function_t *) first)->inclusive;
+    unsigned long long second_time = ((struct profile_function_t *) second)->inclusive;
+    if(first_time == second_time) { return 0; }
+    return first_time < second_time ? 1 : -1;
+}
+
+static ERROR_CODE profile_enter(struct state_t *state, struct profile_t *profile, unsigned int function) {
+    /* allocates space for the index of the node of the function
+    and for the new array of nodes (in case it's grown) */
+    unsigned int index;
+    struct profile_node_t *nodes;
+    struct profile_node_t *node;
+
+    /* calls beyond the maximum depth of the tree are accounted
+    in the deepest node, only counting them to match the returns */
+    if(profile->depth == MINGUS_PROFILE_DEPTH) {
+        profile->overflow++;
+        profile->nodes[profile->current].calls++;
+        RAISE_NO_ERROR;
+    }
+
+    /* searches the children of the current node for the one of
+    the function, appending a new node in case there's none */
+    for(index = profile->nodes[profile->current].child; index != 0; index = profile->nodes[index].sibling) {
+        if(profile->nodes[index].function == function) { break; }
+    }
+    if(index == 0) {
+        if(profile->node_count == profile->node_capacity) {
+            nodes = (struct profile_node_t *) REALLOC(
+                profile->nodes, profile->node_capacity * 2 * sizeof(struct profile_node_t)
+            );
+            if(nodes == NULL) {
+                MINGUS_RAISE_M(
+                    state,
+                    RUNTIME_EXCEPTION_ERROR_CODE,
+                    (unsigned char *) "Problem allocating profile nodes"
+                );
+            }
+            profile->nodes = nodes;
+            profile->node_capacity *= 2;
+        }
+        index = (unsigned int) profile->node_count++;
+        node = &profile->nodes[index];
+        node->function = function;
+        node->parent = profile->current;
+        node->child = 0;
+        node->sibling = profile->nodes[profile->current].child;
+        node->calls = 0;
+        node->exclusive = 0;
+        profile->nodes[profile->current].child = index;
+    }
+
+    /* makes the node of the function the current one */
+    profile->nodes[index].calls++;
+    profile->current = index;
+    profile->depth++;
+    RAISE_NO_ERROR;
+}
+
+static void profile_leave(struct profile_t *profile) {
+    if(profile->overflow > 0) { profile->overflow--; return; }
+    if(profile->depth == 0) { return; }
+    profile->current = profile->nodes[profile->current].parent;
+    profile->depth--;
+}
+
+static void profile_path(FILE *file, struct profile_t *profile, unsigned int index) {
+    /* prints the path of the parent first (root first order)
+    and then the function of the node itself */
+    struct profile_node_t *node = &profile->nodes[index];
+    if(index != 0) {
+        profile_path(file, profile, node->parent);
+        fprintf(file, ";#%08x", node->function);
+    } else {
+        fprintf(file, "%s", "main");
+    }
+}
+
+ERROR_CODE mingus_profile_create(struct profile_t **profile_pointer, struct state_t *state) {
+    /* allocates the profile and its per instruction counters,
+    and the calling context tree with the root node */
+    struct profile_t *profile = (struct profile_t *) MALLOC(sizeof(struct profile_t));
+    if(profile == NULL) {
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem allocating profile"
+        );
+    }
+    memset(profile, 0, sizeof(struct profile_t));
+    profile->code_count = state->header.code_count;
+    profile->hits = (unsigned long long *) MALLOC((profile->code_count + 1) * sizeof(unsigned long long));
+    profile->node_capacity = 64;
+    profile->nodes = (struct profile_node_t *) MALLOC(profile->node_capacity * sizeof(struct profile_node_t));
+    if(profile->hits == NULL || profile->nodes == NULL) {
+        mingus_profile_delete(profile);
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem allocating profile"
+        );
+    }
+    memset(profile->hits, 0, (profile->code_count + 1) * sizeof(unsigned long long));
+    memset(profile->nodes, 0, sizeof(struct profile_node_t));
+    profile->nodes[0].function = MINGUS_PROFILE_ROOT;
+    profile->node_count = 1;
+
+    /* updates the pointer with the profile and
+    returns with no error */
+    *profile_pointer = profile;
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE mingus_profile_delete(struct profile_t *profile) {
+    if(profile->hits != NULL) { FREE(profile->hits); }
+    if(profile->nodes != NULL) { FREE(profile->nodes); }
+    FREE(profile);
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE mingus_profile_run(struct state_t *state, struct profile_t *profile) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* allocates space for the operation being executed, for
+    its program counter and opcode and for the clock readings */
+    struct operation_t *operation;
+    unsigned int pc;
+    unsigned char opcode;
+    unsigned long long end;
+    unsigned long long elapsed;
+    unsigned long long start;
+
+    /* allocates space for the index of the event and for the
+    readings of the counters (before and after the operation) */
+    size_t index;
+    unsigned long long previous[MINGUS_COUNTER_COUNT];
+    unsigned long long current[MINGUS_COUNTER_COUNT];
+
+    /* reads the initial values of the counters (if any) and of
+    the clock, each reading is the start of the next operation */
+    if(profile->counters != NULL) { mingus_counters_read(profile->counters, previous); }
+    start = MINGUS_PROFILE_CLOCK();
+
+    /* iterates while the running flag is set running each
+    operation through the switch engine and accounting the time
+    since the previous one to its opcode, its instruction and
+    the function (calling context) where it runs */
+    while(state->running == TRUE) {
+        pc = state->pc;
+        operation = mingus_fetch(state);
+        opcode = operation->opcode;
+        return_value = mingus_eval(state, operation);
+        end = MINGUS_PROFILE_CLOCK();
+        elapsed = end - start;
+        start = end;
+        profile->counts[opcode]++;
+        profile->times[opcode] += elapsed;
+        profile->hits[pc]++;
+        profile->nodes[profile->current].exclusive += elapsed;
+        profile->total += elapsed;
+        if(profile->counters != NULL) {
+            mingus_counters_read(profile->counters, current);
+            for(index = 0; index < MINGUS_COUNTER_COUNT; index++) {
+                profile->events[opcode][index] += current[index] - previous[index];
+                previous[index] = current[index];
+            }
+            start = MINGUS_PROFILE_CLOCK();
+        }
+        if(IS_ERROR_CODE(return_value)) { mingus_output_flush(&state->output); RAISE_AGAIN(return_value); }
+
+        /* follows the calls and returns in the calling context
+        tree, the (shadow) path mirrors the call stack */
+        if(opcode == CALL) {
+            return_value = profile_enter(state, profile, (unsigned int) operation->operand);
+            if(IS_ERROR_CODE(return_value)) { mingus_output_flush(&state->output); RAISE_AGAIN(return_value); }
+        } else if(opcode == RET) {
+            profile_leave(profile);
+        }
+    }
+
+    /* flushes the buffered output of the program so that
+    it's written before the report */
+    mingus_output_flush(&state->output);
+    RAISE_NO_ERROR;
+}
+
+#ifndef _WIN32
+
+static void profile_signal(int number) {
+    /* retrieves the state being sampled and accounts the sample
+    to the operation before its program counter, the one the
+    engine has dispatched last (as the counter is incremented
+    at dispatch), a sample taken after a branch or a call is
+    (approximately) charged to the operation before its target */
+    struct state_t *state = profile_state;
+    unsigned int pc;
+    if(state == NULL || state->samples == NULL) { return; }
+    pc = state->pc;
+    state->samples[pc > 0 && pc <= state->header.code_count ? pc - 1 : state->header.code_count]++;
+}
+
+ERROR_CODE mingus_profile_sample(struct state_t *state, struct profile_t *profile) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* allocates space for the signal handlers, for the timer
+    configuration, for the start of the execution and for
+    the index of the instruction (when counting the samples) */
+    struct sigaction action;
+    struct sigaction previous;
+    struct itimerval timer;
+    unsigned long long start;
+    unsigned int index;
+
+    /* installs the handler of the profiling signal and starts
+    the timer, that only counts the (user and system) time of
+    the process, the samples are charged directly into the hits
+    of the profile (through the state) */
+    memset(&action, 0, sizeof(struct sigaction));
+    action.sa_handler = profile_signal;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    state->samples = profile->hits;
+    profile->sampled = TRUE;
+    profile_state = state;
+    sigaction(SIGPROF, &action, &previous);
+    memset(&timer, 0, sizeof(struct itimerval));
+    timer.it_interval.tv_usec = MINGUS_PROFILE_INTERVAL;
+    timer.it_value.tv_usec = MINGUS_PROFILE_INTERVAL;
+    setitimer(ITIMER_PROF, &timer, NULL);
+
+    /* runs the program to completion through the regular engine,
+    the timer reads the program counter it already keeps in the
+    state so that sampling has no cost per operation */
+    start = mingus_time();
+    return_value = mingus_execute(state, MINGUS_BUDGET_UNLIMITED);
+    profile->total = mingus_time() - start;
+
+    /* stops the timer and restores the previous handler */
+    memset(&timer, 0, sizeof(struct itimerval));
+    setitimer(ITIMER_PROF, &timer, NULL);
+    sigaction(SIGPROF, &previous, NULL);
+    profile_state = NULL;
+    state->samples = NULL;
+
+    /* counts the samples taken from the hits of the instructions */
+    for(index = 0; index <= profile->code_count; index++) { profile->samples += profile->hits[index]; }
+    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+    RAISE_NO_ERROR;
+}
+
+#else
+
+ERROR_CODE mingus_profile_sample(struct state_t *state, struct profile_t *profile) {
+    MINGUS_RAISE_M(
+        state,
+        RUNTIME_EXCEPTION_ERROR_CODE,
+        (unsigned char *) "Sampling profiler not available"
+    );
+}
+
+#endif
+
+ERROR_CODE mingus_profile_report(struct state_t *state, struct profile_t *profile) {
+    /* allocates space for the indexes used in the iteration,
+    for the total of hits and for the sorted instructions */
+    unsigned int index;
+    unsigned int other;
+    unsigned long long total = 0;
+    unsigned long long **sorted;
+
+    /* allocates space for the inclusive time of each node and
+    for the (merged) functions of the calling context tree */
+    unsigned long long *inclusive;
+    struct profile_function_t *functions;
+    struct profile_function_t *function;
+    size_t count = 0;
+
+    /* prints the header of the report, the sampled profile
+    only has the hits of the instructions */
+    for(index = 0; index <= profile->code_count; index++) { total += profile->hits[index]; }
+    if(profile->sampled == TRUE) {
+        PRINTF_F(
+            "Sampled %llu times (every %d us) in %.3f ms\n",
+            profile->samples, MINGUS_PROFILE_INTERVAL, profile->total / 1000000.0
+        );
+    } else {
+        PRINTF_F("Executed %llu instructions in %llu %s\n", total, profile->total, MINGUS_PROFILE_UNIT);
+        PRINTF_F("%s", "Opcodes:\n");
+        for(index = 0; index < MINGUS_OPERATION_COUNT; index++) {
+            if(profile->counts[index] == 0) { continue; }
+            PRINTF_F(
+                "  %-10s %12llu %16llu %s %6.2f%% %8.1f/op\n",
+                profile_names[index],
+                profile->counts[index],
+                profile->times[index],
+                MINGUS_PROFILE_UNIT,
+                profile->total ? 100.0 * profile->times[index] / profile->total : 0.0,
+                (double) profile->times[index] / profile->counts[index]
+            );
+        }
+    }
+
+    /* prints the events per operation of each of the opcodes,
+    only for the counters available in the host */
+    if(profile->counters != NULL) {
+        PRINTF_F("%s", "Opcode events (per operation):\n");
+        PRINTF_F("  %-10s", "opcode");
+        for(other = 0; other < MINGUS_COUNTER_COUNT; other++) {
+            if(!MINGUS_COUNTER_AVAILABLE(profile->counters, other)) { continue; }
+            PRINTF_F(" %14s", profile_events[other]);
+        }
+        PRINTF_F("%s", "\n");
+        for(index = 0; index < MINGUS_OPERATION_COUNT; index++) {
+            if(profile->counts[index] == 0) { continue; }
+            PRINTF_F("  %-10s", profile_names[index]);
+            for(other = 0; other < MINGUS_COUNTER_COUNT; other++) {
+                if(!MINGUS_COUNTER_AVAILABLE(profile->counters, other)) { continue; }
+                PRINTF_F(" %14.2f", (double) profile->events[index][other] / profile->counts[index]);
+            }
+            PRINTF_F("%s", "\n");
+        }
+    }
+
+    /* sorts the instructions by their hits (hottest first) and
+    prints the ones at the top of the list */
+    sorted = (unsigned long long **) MALLOC((profile->code_count + 1) * sizeof(unsigned long long *));
+    if(sorted == NULL) {
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem allocating profile report"
+        );
+    }
+    for(index = 0; index <= profile->code_count; index++) { sorted[index] = &profile->hits[index]; }
+    qsort(sorted, profile->code_count + 1, sizeof(unsigned long long *), compare_hits);
+    PRINTF_F("%s", "Hottest instructions:\n");
+    for(index = 0; index <= profile->code_count && index < MINGUS_PROFILE_LIMIT; index++) {
+        if(*sorted[index] == 0) { break; }
+        other = (unsigned int) (sorted[index] - profile->hits);
+        PRINTF_F(
+            "  #%08x %-10s %12llu %6.2f%%\n",
+            other,
+            other < profile->code_count ? profile_names[state->operations[other].opcode] : "(none)",
+            *sorted[index],
+            total ? 100.0 * *sorted[index] / total : 0.0
+        );
+    }
+    FREE(sorted);
+    if(profile->sampled == TRUE) { RAISE_NO_ERROR; }
+
+    /* computes the inclusive time of each node (the exclusive
+    time of its subtree), as the parent of a node always precedes
+    it the nodes are accumulated into their parents in reverse */
+    inclusive = (unsigned long long *) MALLOC(profile->node_count * sizeof(unsigned long long));
+    functions = (struct profile_function_t *) MALLOC(profile->node_count * sizeof(struct profile_function_t));
+    if(inclusive == NULL || functions == NULL) {
+        if(inclusive != NULL) { FREE(inclusive); }
+        if(functions != NULL) { FREE(functions); }
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem allocating profile report"
+        );
+    }
+    for(index = 0; index < profile->node_count; index++) { inclusive[index] = profile->nodes[index].exclusive; }
+    for(index = (unsigned int) profile->node_count - 1; index > 0; index--) {
+        inclusive[profile->nodes[index].parent] += inclusive[index];
+    }
+
+    /* merges the nodes of each function, the inclusive time is
+    only added for the outermost node of a recursion (no ancestor
+    of the same function) so that it's never counted twice */
+    for(index = 1; index < profile->node_count; index++) {
+        for(other = 0; other < count; other++) {
+            if(functions[other].function == profile->nodes[index].function) { break; }
+        }
+        function = &functions[other];
+        if(other == count) {
+            function->function = profile->nodes[index].function;
+            function->calls = 0;
+            function->inclusive = 0;
+            function->exclusive = 0;
+            count++;
+        }
+        function->calls += profile->nodes[index].calls;
+        function->exclusive += profile->nodes[index].exclusive;
+        for(other = profile->nodes[index].parent; other != 0; other = profile->nodes[other].parent) {
+            if(profile->nodes[other].function == function->function) { break; }
+        }
+        if(other == 0) { function->inclusive += inclusive[index]; }
+    }
+
+    /* sorts the functions by their inclusive time and prints
+    the ones at the top of the list (preceded by the top level) */
+    qsort(functions, count, sizeof(struct profile_function_t), compare_functions);
+    PRINTF_F("Functions (%s):\n", MINGUS_PROFILE_UNIT);
+    PRINTF_F("  %-9s %12s %16s %16s\n", "entry", "calls", "inclusive", "exclusive");
+    PRINTF_F("  %-9s %12d %16llu %16llu\n", "main", 1, inclusive[0], profile->nodes[0].exclusive);
+    for(index = 0; index < count && index < MINGUS_PROFILE_LIMIT; index++) {
+        function = &functions[index];
+        PRINTF_F(
+            "  #%08x %12llu %16llu %16llu\n",
+            function->function, function->calls, function->inclusive, function->exclusive
+        );
+    }
+
+    /* releases the temporary structures and returns
+    the control flow with no error */
+    FREE(functions);
+    FREE(inclusive);
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE mingus_profile_folded(struct profile_t *profile, char *path) {
+    /* allocates space for the index of the node and
+    for the file where the stacks are written */
+    unsigned int index;
+    FILE *file;
+
+    /* opens the file for writing raising an error
+    in case it's not possible to open it */
+    FOPEN(&file, path, "wb");
+    if(file == NULL) {
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem opening folded stacks file"
+        );
+    }
+
+    /* writes a line per node with time spent in the function
+    itself, the path of the functions (root first) separated by
+    semicolons followed by the time, as used by flame graphs */
+    for(index = 0; index < profile->node_count; index++) {
+        if(profile->nodes[index].exclusive == 0) { continue; }
+        profile_path(file, profile, index);
+        fprintf(file, " %llu\n", profile->nodes[index].exclusive);
+    }
+    fclose(file);
+
+    /* returns with no error */
+    RAISE_NO_ERROR;
+}
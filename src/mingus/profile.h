@@ -0,0 +1,248 @@
+/*
+ Mingus Virtual Machine
+ Copyright (c) 2008-2020 Hive Solutions Lda.
+
+ This file is part of Mingus Virtual Machine.
+
+ Mingus Virtual Machine is free software: you can redistribute it and/or modify
+ it under the terms of the Apache License as published by the Apache
+ Foundation, either version 2.0 of the License, or (at your option) any
+ later version.
+
+ Mingus Virtual Machine is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ Apache License for more details.
+
+ You should have received a copy of the Apache License along with
+ Mingus Virtual Machine. If not, see <http://www.apache.org/licenses/>.
+
+ __author__    = João Magalhães <joamag@hive.pt>
+ __version__   = 1.0.0
+ __revision__  = $LastChangedRevision$
+ __date__      = $LastChangedDate$
+ __copyright__ = Copyright (c) 2008-2020 João Magalhães
+ __license__   = Apache License, Version 2.0
+*/
+
+#pragma once
+
+/**
+ * The maximum depth of the calling context tree of the
+ * profiler, deeper calls (deep recursion) are accounted
+ * in the deepest node.
+ */
+#define MINGUS_PROFILE_DEPTH 256
+
+/**
+ * The number of entries (instructions and functions)
+ * listed in each of the tables of the profiling report.
+ */
+#define MINGUS_PROFILE_LIMIT 10
+
+/**
+ * The interval (in microseconds) of the profiling timer
+ * (SIGPROF) used by the sampling mode.
+ */
+#define MINGUS_PROFILE_INTERVAL 1000
+
+/**
+ * The pseudo function of the root node of the calling
+ * context tree (the top level code of the program).
+ */
+#define MINGUS_PROFILE_ROOT 0xffffffff
+
+/**
+ * The clock used to measure the operations by the profiler,
+ * the time stamp counter (cycles) where available and the
+ * monotonic clock (nanoseconds) otherwise.
+ */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MINGUS_PROFILE_CLOCK() __rdtsc()
+#define MINGUS_PROFILE_UNIT "cycles"
+#else
+#define MINGUS_PROFILE_CLOCK() mingus_time()
+#define MINGUS_PROFILE_UNIT "ns"
+#endif
+
+/**
+ * Structure describing a node of the calling context tree,
+ * a function as called through a specific path of calls,
+ * nodes are only appended so a parent precedes its children.
+ */
+typedef struct profile_node_t {
+    /**
+     * The entry (program counter) of the function of the
+     * node, MINGUS_PROFILE_ROOT for the root node.
+     */
+    unsigned int function;
+
+    /**
+     * The indexes of the parent node, of the first child node
+     * and of the next sibling node (zero meaning none, as the
+     * root node is never a child).
+     */
+    unsigned int parent;
+    unsigned int child;
+    unsigned int sibling;
+
+    /**
+     * The number of calls that entered the node.
+     */
+    unsigned long long calls;
+
+    /**
+     * The time spent in the function itself (exclusive
+     * time) while called through this path.
+     */
+    unsigned long long exclusive;
+} profile_node;
+
+/**
+ * Structure describing the totals of a function, merged
+ * from all the nodes of the calling context tree where
+ * it's called (used only by the report).
+ */
+typedef struct profile_function_t {
+    unsigned int function;
+    unsigned long long calls;
+    unsigned long long inclusive;
+    unsigned long long exclusive;
+} profile_function;
+
+/**
+ * Structure describing the data gathered by the profiler,
+ * either by the instrumented run (counts and times of every
+ * operation and function) or by the sampling mode (only the
+ * program counters seen by the timer).
+ */
+typedef struct profile_t {
+    /**
+     * The number of executions and the total time of each
+     * of the opcodes (indexed by opcode).
+     */
+    unsigned long long counts[MINGUS_OPERATION_COUNT];
+    unsigned long long times[MINGUS_OPERATION_COUNT];
+
+    /**
+     * The number of hits (executions or samples) of each
+     * of the instructions (indexed by program counter).
+     */
+    unsigned long long *hits;
+
+    /**
+     * The number of instructions of the profiled program.
+     */
+    unsigned int code_count;
+
+    /**
+     * The (growable) array of nodes of the calling context
+     * tree, the first one being the root node.
+     */
+    struct profile_node_t *nodes;
+    size_t node_count;
+    size_t node_capacity;
+
+    /**
+     * The index of the node of the function currently
+     * running, its depth and the number of calls beyond
+     * the maximum depth of the tree.
+     */
+    unsigned int current;
+    unsigned int depth;
+    unsigned int overflow;
+
+    /**
+     * The total time of the execution and the number of
+     * samples taken (only in the sampling mode).
+     */
+    unsigned long long total;
+    unsigned long long samples;
+
+    /**
+     * If the profile has been gathered by the sampling mode
+     * (even if no sample has been taken).
+     */
+    unsigned char sampled;
+
+    /**
+     * The performance counters read around every operation
+     * by the instrumented run (unset means none) and the
+     * events counted for each of the opcodes.
+     */
+    struct counters_t *counters;
+    unsigned long long events[MINGUS_OPERATION_COUNT][MINGUS_COUNTER_COUNT];
+} profile;
+
+/**
+ * Creates a profile for the program loaded in the provided
+ * state, with zeroed counters and a calling context tree
+ * with only the root node.
+ *
+ * @param profile_pointer The pointer to the profile to create.
+ * @param state The state with the program to be profiled.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_profile_create(struct profile_t **profile_pointer, struct state_t *state);
+
+/**
+ * Deletes the profile, releasing all of its data.
+ *
+ * @param profile The profile to be deleted.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_profile_delete(struct profile_t *profile);
+
+/**
+ * Runs the program loaded in the provided state measuring
+ * every operation (with the cycle counter when available),
+ * accounting its time to the opcode, to the instruction and
+ * to the calling context (function) where it's executed, the
+ * (started) performance counters of the profile (if any) are
+ * read around every operation and accounted to its opcode.
+ *
+ * Should be run over unfused operations so that the
+ * reported opcodes are the ones in the bytecode.
+ *
+ * @param state The current virtual machine state.
+ * @param profile The profile where the data is gathered.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_profile_run(struct state_t *state, struct profile_t *profile);
+
+/**
+ * Runs the program loaded in the provided state with the
+ * regular engine while a profiling timer (SIGPROF) samples
+ * the program counter kept in the state (charging the samples
+ * through its samples array), with no overhead per operation,
+ * only one state may be sampled at a time (per process).
+ *
+ * @param state The current virtual machine state.
+ * @param profile The profile where the samples are gathered.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_profile_sample(struct state_t *state, struct profile_t *profile);
+
+/**
+ * Prints the report of the profile, the counts and times per
+ * opcode (and the events per operation of each opcode in case
+ * of counters), the hottest instructions and the inclusive and
+ * exclusive times per function (only the hottest instructions
+ * in case of a sampled profile).
+ *
+ * @param state The virtual machine state that has run.
+ * @param profile The profile to be reported.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_profile_report(struct state_t *state, struct profile_t *profile);
+
+/**
+ * Writes the calling context tree of the profile as folded
+ * stacks (one line per path of calls with its exclusive time)
+ * that may be used directly to render a flame graph.
+ *
+ * @param profile The (instrumented) profile to be written.
+ * @param path The path to the file to be written.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_profile_folded(struct profile_t *profile, char *path);
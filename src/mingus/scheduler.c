@@ -0,0 +1,147 @@
+/*
+ Mingus Virtual Machine
+ Copyright (c) 2008-2020 Hive Solutions Lda.
+
+ This file is part of Mingus Virtual Machine.
+
+ Mingus Virtual Machine is free software: you can redistribute it and/or modify
+ it under the terms of the Apache License as published by the Apache
+ Foundation, either version 2.0 of the License, or (at your option) any
+ later version.
+
+ Mingus Virtual Machine is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ Apache License for more details.
+
+ You should have received a copy of the Apache License along with
+ Mingus Virtual Machine. If not, see <http://www.apache.org/licenses/>.
+
+ __author__    = João Magalhães <joamag@hive.pt>
+ __version__   = 1.0.0
+ __revision__  = $LastChangedRevision$
+ __date__      = $LastChangedDate$
+ __copyright__ = Copyright (c) 2008-2020 João Magalhães
+ __license__   = Apache License, Version 2.0
+*/
+
+#include "stdafx.h"
+
+#include "mingus.h"
+#include "scheduler.h"
+
+ERROR_CODE mingus_scheduler_create(struct scheduler_t **scheduler_pointer, unsigned long long slice) {
+    /* allocates the scheduler structure and populates
+    it with the default (empty) values */
+    struct scheduler_t *scheduler = (struct scheduler_t *) MALLOC(sizeof(struct scheduler_t));
+    if(scheduler == NULL) {
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem allocating scheduler"
+        );
+    }
+    scheduler->states = NULL;
+    scheduler->count = 0;
+    scheduler->capacity = 0;
+    scheduler->current = 0;
+    scheduler->slice = slice == 0 ? MINGUS_SCHEDULER_SLICE : slice;
+    scheduler->turns = 0;
+    scheduler->latency = 0;
+
+    /* sets the scheduler in the pointer and returns with no error */
+    *scheduler_pointer = scheduler;
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE mingus_scheduler_delete(struct scheduler_t *scheduler) {
+    /* releases the array of states and then the scheduler */
+    if(scheduler->states != NULL) { FREE(scheduler->states); }
+    FREE(scheduler);
+
+    /* returns with no error */
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE mingus_scheduler_add(struct scheduler_t *scheduler, struct state_t *state) {
+    /* allocates space for the new array of states */
+    struct state_t **states;
+
+    /* grows the array of states (doubling it) in case
+    there's no more space for the new state */
+    if(scheduler->count == scheduler->capacity) {
+        scheduler->capacity = scheduler->capacity == 0 ? 16 : scheduler->capacity * 2;
+        states = (struct state_t **) REALLOC(
+            scheduler->states, scheduler->capacity * sizeof(struct state_t *)
+        );
+        if(states == NULL) {
+            RAISE_ERROR_M(
+                RUNTIME_EXCEPTION_ERROR_CODE,
+                (unsigned char *) "Problem allocating scheduler states"
+            );
+        }
+        scheduler->states = states;
+    }
+
+    /* adds the state to the end of the array of states */
+    scheduler->states[scheduler->count] = state;
+    scheduler->count++;
+
+    /* returns with no error */
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE mingus_scheduler_run(
+    struct scheduler_t *scheduler,
+    unsigned long long deadline,
+    struct state_t **failed_pointer
+) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* allocates space for the state of the turn, for its
+    status and for the times used to measure the turn */
+    struct state_t *state;
+    enum mingus_status_e status;
+    unsigned long long start;
+    unsigned long long end = mingus_time();
+
+    /* unsets the failed state, only set on error */
+    *failed_pointer = NULL;
+
+    /* runs turns while there are states in the scheduler and
+    the deadline has not been reached (verified between turns) */
+    while(scheduler->count > 0 && (deadline == 0 || end < deadline)) {
+        if(scheduler->current >= scheduler->count) { scheduler->current = 0; }
+        state = scheduler->states[scheduler->current];
+
+        /* runs the state for the slice of the turn measuring
+        its time, the longest turn is the latency */
+        start = end;
+        return_value = mingus_execute_until(state, scheduler->slice, 0, &status);
+        end = mingus_time();
+        if(end - start > scheduler->latency) { scheduler->latency = end - start; }
+        scheduler->turns++;
+
+        /* in case the state is still running (budget exhausted)
+        moves to the next one, otherwise (halted or failed) the
+        state is replaced by the last one, that has not had its
+        turn yet in this round (the round order is kept fair) */
+        if(!IS_ERROR_CODE(return_value) && status != MINGUS_HALTED) {
+            scheduler->current++;
+            continue;
+        }
+        scheduler->count--;
+        scheduler->states[scheduler->current] = scheduler->states[scheduler->count];
+
+        /* in case the state has failed sets it in the pointer and
+        raises the error, the other states may still be resumed */
+        if(IS_ERROR_CODE(return_value)) {
+            *failed_pointer = state;
+            RAISE_AGAIN(return_value);
+        }
+    }
+
+    /* returns with no error */
+    RAISE_NO_ERROR;
+}
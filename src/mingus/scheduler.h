@@ -0,0 +1,124 @@
+/*
+ Mingus Virtual Machine
+ Copyright (c) 2008-2020 Hive Solutions Lda.
+
+ This file is part of Mingus Virtual Machine.
+
+ Mingus Virtual Machine is free software: you can redistribute it and/or modify
+ it under the terms of the Apache License as published by the Apache
+ Foundation, either version 2.0 of the License, or (at your option) any
+ later version.
+
+ Mingus Virtual Machine is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ Apache License for more details.
+
+ You should have received a copy of the Apache License along with
+ Mingus Virtual Machine. If not, see <http://www.apache.org/licenses/>.
+
+ __author__    = João Magalhães <joamag@hive.pt>
+ __version__   = 1.0.0
+ __revision__  = $LastChangedRevision$
+ __date__      = $LastChangedDate$
+ __copyright__ = Copyright (c) 2008-2020 João Magalhães
+ __license__   = Apache License, Version 2.0
+*/
+
+#pragma once
+
+/**
+ * Structure describing a (single threaded) round robin
+ * scheduler of virtual machine states, each state runs
+ * for a slice of budget per turn so that many scripts are
+ * multiplexed on one thread with a bounded latency.
+ */
+typedef struct scheduler_t {
+    /**
+     * The (growable) array of states still running, in the
+     * order of their turns, the states are not owned by the
+     * scheduler (the caller deletes them).
+     */
+    struct state_t **states;
+
+    /**
+     * The number of states currently in the scheduler.
+     */
+    size_t count;
+
+    /**
+     * The number of states that fit in the allocated array.
+     */
+    size_t capacity;
+
+    /**
+     * The index of the state with the next turn.
+     */
+    size_t current;
+
+    /**
+     * The budget (in operations) of each turn.
+     */
+    unsigned long long slice;
+
+    /**
+     * The number of turns run and the longest of them (in
+     * nanoseconds), the latency of the scheduler.
+     */
+    unsigned long long turns;
+    unsigned long long latency;
+} scheduler;
+
+/**
+ * The default budget (in operations) of each turn.
+ */
+#define MINGUS_SCHEDULER_SLICE 4096
+
+/**
+ * Creates a new (empty) scheduler.
+ *
+ * @param scheduler_pointer The pointer to the scheduler to be created.
+ * @param slice The budget (in operations) of each turn.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_scheduler_create(struct scheduler_t **scheduler_pointer, unsigned long long slice);
+
+/**
+ * Deletes the scheduler, the states in it are not deleted.
+ *
+ * @param scheduler The scheduler to be deleted.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_scheduler_delete(struct scheduler_t *scheduler);
+
+/**
+ * Adds the state (with a loaded module) to the scheduler,
+ * the state gets its turn after all the other ones.
+ *
+ * @param scheduler The scheduler.
+ * @param state The state to be added.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_scheduler_add(struct scheduler_t *scheduler, struct state_t *state);
+
+/**
+ * Runs the states of the scheduler in turns (round robin)
+ * until all of them have halted or until the deadline is
+ * reached (monotonic time in nanoseconds, zero for none).
+ *
+ * The states that halt are removed from the scheduler, in
+ * case a state raises an error it's removed as well, set in
+ * the failed pointer and the error is raised (its message
+ * in the failed state, mingus_error), a new call resumes
+ * the execution of the remaining states.
+ *
+ * @param scheduler The scheduler.
+ * @param deadline The (monotonic) time at which to stop.
+ * @param failed_pointer The pointer to be set with the failed state.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_scheduler_run(
+    struct scheduler_t *scheduler,
+    unsigned long long deadline,
+    struct state_t **failed_pointer
+);
@@ -0,0 +1,119 @@
+/*
+ Mingus Virtual Machine
+ Copyright (c) 2008-2020 Hive Solutions Lda.
+
+ This file is part of Mingus Virtual Machine.
+
+ Mingus Virtual Machine is free software: you can redistribute it and/or modify
+ it under the terms of the Apache License as published by the Apache
+ Foundation, either version 2.0 of the License, or (at your option) any
+ later version.
+
+ Mingus Virtual Machine is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ Apache License for more details.
+
+ You should have received a copy of the Apache License along with
+ Mingus Virtual Machine. If not, see <http://www.apache.org/licenses/>.
+
+ __author__    = João Magalhães <joamag@hive.pt>
+ __version__   = 1.0.0
+ __revision__  = $LastChangedRevision$
+ __date__      = $LastChangedDate$
+ __copyright__ = Copyright (c) 2008-2020 João Magalhães
+ __license__   = Apache License, Version 2.0
+*/
+
+#include "stdafx.h"
+
+#include "mingus.h"
+
+ERROR_CODE mingus_trace_create(struct trace_t **trace_pointer, char *file_path, size_t capacity) {
+    /* allocates the trace structure and the ring buffer
+    of records, raising an error in case of failure */
+    struct trace_t *trace = (struct trace_t *) MALLOC(sizeof(struct trace_t));
+    if(trace == NULL) {
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem allocating trace"
+        );
+    }
+    trace->records = (struct trace_record_t *) MALLOC(capacity * sizeof(struct trace_record_t));
+    if(trace->records == NULL) {
+        FREE(trace);
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem allocating trace records"
+        );
+    }
+
+    /* populates the trace structure with the initial
+    values and sets it in the provided pointer */
+    trace->capacity = capacity;
+    trace->total = 0;
+    trace->file_path = file_path;
+    *trace_pointer = trace;
+
+    /* raises no error */
+    RAISE_NO_ERROR;
+}
+
+void mingus_trace_record(struct trace_t *trace, struct state_t *state) {
+    /* retrieves the next record in the ring buffer (wraps around
+    using the capacity mask) and the operation to be executed */
+    struct trace_record_t *record = &trace->records[trace->total & (trace->capacity - 1)];
+    struct operation_t *operation = &state->operations[state->pc];
+
+    /* populates the record with the current values of
+    the state and increments the total counter */
+    record->pc = state->pc;
+    record->opcode = operation->opcode;
+    record->arg1 = operation->arg1;
+    record->so = (unsigned short) state->so;
+    record->operand = operation->operand;
+    record->top = state->so > 0 ? state->stack[state->so - 1] : 0;
+    trace->total++;
+}
+
+ERROR_CODE mingus_trace_close(struct trace_t *trace) {
+    /* allocates space for the header of the file, for
+    the index of the oldest record and the file itself */
+    struct trace_header_t header;
+    size_t start;
+    FILE *file;
+
+    /* populates the header of the trace file, only the
+    records still in the ring buffer are written */
+    memcpy(header.magic, "MTRC", 4);
+    header.version = MINGUS_TRACE_VERSION;
+    header.record_size = sizeof(struct trace_record_t);
+    header.count = (unsigned int) (trace->total < trace->capacity ? trace->total : trace->capacity);
+    header.total = trace->total;
+
+    /* opens the trace file for writing, in case of failure
+    releases the trace and raises the error */
+    FOPEN(&file, trace->file_path, "wb");
+    if(file == NULL) {
+        FREE(trace->records);
+        FREE(trace);
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem opening trace file"
+        );
+    }
+
+    /* writes the header and then the records, starting from the
+    oldest one in the ring buffer (chronological order) */
+    start = (size_t) (trace->total < trace->capacity ? 0 : trace->total & (trace->capacity - 1));
+    fwrite(&header, sizeof(struct trace_header_t), 1, file);
+    fwrite(&trace->records[start], sizeof(struct trace_record_t), header.count - start, file);
+    fwrite(trace->records, sizeof(struct trace_record_t), start, file);
+    fclose(file);
+
+    /* releases the trace structures and
+    returns with no error */
+    FREE(trace->records);
+    FREE(trace);
+    RAISE_NO_ERROR;
+}
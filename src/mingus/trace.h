@@ -0,0 +1,118 @@
+/*
+ Mingus Virtual Machine
+ Copyright (c) 2008-2020 Hive Solutions Lda.
+
+ This file is part of Mingus Virtual Machine.
+
+ Mingus Virtual Machine is free software: you can redistribute it and/or modify
+ it under the terms of the Apache License as published by the Apache
+ Foundation, either version 2.0 of the License, or (at your option) any
+ later version.
+
+ Mingus Virtual Machine is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ Apache License for more details.
+
+ You should have received a copy of the Apache License along with
+ Mingus Virtual Machine. If not, see <http://www.apache.org/licenses/>.
+
+ __author__    = João Magalhães <joamag@hive.pt>
+ __version__   = 1.0.0
+ __revision__  = $LastChangedRevision$
+ __date__      = $LastChangedDate$
+ __copyright__ = Copyright (c) 2008-2020 João Magalhães
+ __license__   = Apache License, Version 2.0
+*/
+
+#pragma once
+
+/**
+ * The version of the trace file format, any change
+ * to the record or header structures should increment
+ * this value.
+ */
+#define MINGUS_TRACE_VERSION 1
+
+/**
+ * The default number of records kept in the trace ring
+ * buffer, only the latest records are kept (and written)
+ * once the buffer is full.
+ */
+#define MINGUS_TRACE_CAPACITY 65536
+
+/**
+ * Structure describing a (compact) binary trace record,
+ * created for each operation executed while tracing.
+ */
+typedef struct trace_record_t {
+    unsigned int pc;
+    unsigned char opcode;
+    unsigned char arg1;
+    unsigned short so;
+    int operand;
+    unsigned int top;
+} trace_record;
+
+/**
+ * The header of the trace file, followed by the records
+ * in chronological order (oldest first).
+ */
+typedef struct trace_header_t {
+    char magic[4];
+    unsigned int version;
+    unsigned int record_size;
+    unsigned int count;
+    unsigned long long total;
+} trace_header;
+
+/**
+ * Structure describing the (in memory) trace ring buffer
+ * associated with a virtual machine state.
+ */
+typedef struct trace_t {
+    /**
+     * The ring buffer of records, written in a circular
+     * fashion overriding the oldest records.
+     */
+    struct trace_record_t *records;
+
+    /**
+     * The number of records that fit in the ring buffer,
+     * must be a power of two (cheap wrap around).
+     */
+    size_t capacity;
+
+    /**
+     * The total number of records written to the ring
+     * buffer since its creation.
+     */
+    unsigned long long total;
+
+    /**
+     * The path to the file where the records are going
+     * to be written once the trace is closed.
+     */
+    char *file_path;
+} trace;
+
+/**
+ * Creates a new trace ring buffer with the given capacity
+ * (a power of two) that is going to be written to the
+ * provided file path once closed.
+ *
+ * @param trace_pointer The pointer to the trace to be created.
+ * @param file_path The path of the trace file to be written.
+ * @param capacity The number of records in the ring buffer.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_trace_create(struct trace_t **trace_pointer, char *file_path, size_t capacity);
+
+/**
+ * Writes the records currently in the ring buffer to the
+ * trace file (oldest first) and releases the trace.
+ *
+ * @param trace The trace to be written and released.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_trace_close(struct trace_t *trace);
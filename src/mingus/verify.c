@@ -0,0 +1,416 @@
+/*
+ Mingus Virtual Machine
+ Copyright (c) 2008-2020 Hive Solutions Lda.
+
+ This file is part of Mingus Virtual Machine.
+
+ Mingus Virtual Machine is free software: you can redistribute it and/or modify
+ it under the terms of the Apache License as published by the Apache
+ Foundation, either version 2.0 of the License, or (at your option) any
+ later version.
+
+ Mingus Virtual Machine is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ Apache License for more details.
+
+ You should have received a copy of the Apache License along with
+ Mingus Virtual Machine. If not, see <http://www.apache.org/licenses/>.
+
+ __author__    = João Magalhães <joamag@hive.pt>
+ __version__   = 1.0.0
+ __revision__  = $LastChangedRevision$
+ __date__      = $LastChangedDate$
+ __copyright__ = Copyright (c) 2008-2020 João Magalhães
+ __license__   = Apache License, Version 2.0
+*/
+
+#include "stdafx.h"
+
+#include "mingus.h"
+#include "verify.h"
+
+/**
+ * The tag of the operations not (yet) reached by
+ * the abstract interpretation.
+ */
+#define VERIFY_UNVISITED ((unsigned int) -1)
+
+static void verify_effect(unsigned char opcode, int *pops, int *pushes) {
+    /* sets the number of stack values read (popped) and written
+    (pushed) by the operation, the peeks are considered to be a
+    pop followed by a push of the same value */
+    switch(opcode) {
+        case LOAD:
+        case LOADI:
+            *pops = 0; *pushes = 1;
+            break;
+
+        case STORE:
+        case POP:
+        case JMP_EQ:
+        case JMP_NEQ:
+            *pops = 1; *pushes = 0;
+            break;
+
+        case ADD:
+        case SUB:
+            *pops = 2; *pushes = 1;
+            break;
+
+        case CMP:
+            *pops = 2; *pushes = 2;
+            break;
+
+        case PRINT:
+        case PRINTS:
+            *pops = 1; *pushes = 1;
+            break;
+
+        default:
+            *pops = 0; *pushes = 0;
+            break;
+    }
+}
+
+static ERROR_CODE verify_visit(
+    int *depths,
+    unsigned int *tags,
+    unsigned int index,
+    unsigned int count,
+    int depth,
+    unsigned int tag,
+    unsigned int *work,
+    unsigned int *work_count
+) {
+    /* verifies that the execution does not fall off the end
+    of the code (branch targets are verified by the loader) */
+    if(index >= count) {
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Execution falls off the end of the code"
+        );
+    }
+
+    /* in case the operation is reached for the first time sets its
+    (relative) depth and function and queues it, otherwise both must
+    be the same as in the previous visit (statically known depth),
+    so that each operation is only queued once */
+    if(tags[index] == VERIFY_UNVISITED) {
+        depths[index] = depth;
+        tags[index] = tag;
+        work[(*work_count)++] = index;
+    } else if(depths[index] != depth || tags[index] != tag) {
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Inconsistent stack depth at #%08x",
+            index
+        );
+    }
+
+    /* raises no error */
+    RAISE_NO_ERROR;
+}
+
+#define VERIFY_VISIT(INDEX, DEPTH, TAG)\
+    do {\
+        return_value = verify_visit(depths, tags, INDEX, count, DEPTH, TAG, work, &work_count);\
+        if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }\
+    } while(0)
+
+#define VERIFY_FAIL(MESSAGE, INDEX)\
+    RAISE_ERROR_F(\
+        RUNTIME_EXCEPTION_ERROR_CODE,\
+        (unsigned char *) MESSAGE,\
+        (unsigned int) (INDEX)\
+    )
+
+static ERROR_CODE verify_module(
+    struct module_t *module,
+    int *depths,
+    unsigned int *tags,
+    int *returns,
+    unsigned char *returned,
+    int *lows,
+    int *highs,
+    unsigned int *work,
+    unsigned int *links
+) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* allocates space for the indexes and values used in
+    the iterations of the abstract interpretation */
+    unsigned int index;
+    unsigned int target;
+    unsigned int tag;
+    unsigned int link;
+    unsigned int functions;
+    unsigned int depth_frame;
+    unsigned int work_count = 0;
+    unsigned int head;
+    unsigned int tail;
+    int depth;
+    int pops;
+    int pushes;
+
+    /* retrieves the operations of the module to be verified */
+    unsigned int count = module->header.code_count;
+    struct operation_t *operations = module->operations;
+    struct operation_t *operation;
+
+    /* an empty code section has no halt instruction, the execution
+    falls off the end immediately */
+    if(count == 0) {
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Execution falls off the end of the code"
+        );
+    }
+
+    /* starts every operation as not reached and every function
+    with no known return depth, an empty depth range and no calls
+    waiting for it (the links hold the head of the list of calls
+    per function followed by the next call per call) */
+    for(index = 0; index < count; index++) {
+        tags[index] = VERIFY_UNVISITED;
+        returned[index] = FALSE;
+        lows[index] = 0;
+        highs[index] = 0;
+        links[index] = VERIFY_UNVISITED;
+    }
+
+    /* the entry of the program and the targets of every call are
+    the entries of the functions, all starting at depth zero */
+    depths[0] = 0;
+    tags[0] = 0;
+    work[work_count++] = 0;
+    for(index = 0; index < count; index++) {
+        if(operations[index].opcode != CALL) { continue; }
+        target = (unsigned int) operations[index].operand;
+        if(tags[target] == target) { continue; }
+        VERIFY_VISIT(target, 0, target);
+    }
+
+    /* runs the abstract interpretation of the (relative) stack depth
+    over the worklist until it's empty, the call operations only fall
+    through once the return depth of the called function is known,
+    until then they wait in the list of calls of the function */
+    while(work_count > 0) {
+        index = work[--work_count];
+        operation = &operations[index];
+        depth = depths[index];
+        tag = tags[index];
+        target = (unsigned int) operation->operand;
+        verify_effect(operation->opcode, &pops, &pushes);
+
+        switch(operation->opcode) {
+            case JMP_EQ:
+            case JMP_NEQ:
+                VERIFY_VISIT(target, depth - 1, tag);
+                VERIFY_VISIT(index + 1, depth - 1, tag);
+                break;
+
+            case JMP:
+            case JMP_ABS:
+                VERIFY_VISIT(target, depth, tag);
+                break;
+
+            case RJMP_EQ:
+            case RJMP_NEQ:
+            case RJMP_NZ:
+                VERIFY_VISIT(target, depth, tag);
+                VERIFY_VISIT(index + 1, depth, tag);
+                break;
+
+            case CALL:
+                if(returned[target] == FALSE) {
+                    links[count + index] = links[target];
+                    links[target] = index;
+                    break;
+                }
+                VERIFY_VISIT(index + 1, depth + returns[target], tag);
+                break;
+
+            case RET:
+                if(tag == 0) { VERIFY_FAIL("Return outside of a function at #%08x", index); }
+                if(returned[tag] == FALSE) {
+                    returns[tag] = depth;
+                    returned[tag] = TRUE;
+                    for(link = links[tag]; link != VERIFY_UNVISITED; link = links[count + link]) {
+                        work[work_count++] = link;
+                    }
+                } else if(returns[tag] != depth) {
+                    VERIFY_FAIL("Inconsistent return depth at #%08x", index);
+                }
+                break;
+
+            case HALT:
+                break;
+
+            default:
+                VERIFY_VISIT(index + 1, depth - pops + pushes, tag);
+                break;
+        }
+    }
+
+    /* computes the lowest and highest depth of the operations of
+    each function and verifies the global indexes, the loads must
+    reference the globals table and the strings are never stored */
+    for(index = 0; index < count; index++) {
+        if(tags[index] == VERIFY_UNVISITED) { continue; }
+
+        operation = &operations[index];
+        tag = tags[index];
+        verify_effect(operation->opcode, &pops, &pushes);
+        if(depths[index] - pops < lows[tag]) { lows[tag] = depths[index] - pops; }
+        if(depths[index] > highs[tag]) { highs[tag] = depths[index]; }
+
+        switch(operation->opcode) {
+            case LOAD:
+            case RLOAD:
+                if(operation->operand < 0 || (unsigned int) operation->operand >= module->global_count) {
+                    VERIFY_FAIL("Invalid global index at #%08x", index);
+                }
+                break;
+
+            case STORE:
+            case RSTORE:
+                if((unsigned int) operation->operand < module->header.data_count &&
+                    module->data_entries[operation->operand].type == BYTE_T) {
+                    VERIFY_FAIL("Store into string global at #%08x", index);
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    /* links every (reached) call into the list of calls of the
+    called function and queues every function, the returned flags
+    are reused to mark the queued functions and the return depths
+    to count the times each function has been queued */
+    for(index = 0, functions = 0; index < count; index++) {
+        links[index] = VERIFY_UNVISITED;
+    }
+    for(index = 0; index < count; index++) {
+        if(tags[index] == index) {
+            work[functions++] = index;
+            returned[index] = TRUE;
+            returns[index] = 1;
+        }
+        if(tags[index] == VERIFY_UNVISITED || operations[index].opcode != CALL) { continue; }
+        target = (unsigned int) operations[index].operand;
+        links[count + index] = links[target];
+        links[target] = index;
+    }
+
+    /* propagates the lowest depth of the called functions into the
+    callers (relative to the call depth), as in a shortest path, a
+    function queued more than once per function means that a
+    recursion underflows the stack without any bound (the queue is
+    circular as each function is at most once in it) */
+    for(head = 0, tail = functions, work_count = functions; work_count > 0; work_count--) {
+        target = work[head];
+        head = (head + 1) % count;
+        returned[target] = FALSE;
+        for(link = links[target]; link != VERIFY_UNVISITED; link = links[count + link]) {
+            tag = tags[link];
+            if(depths[link] + lows[target] >= lows[tag]) { continue; }
+            lows[tag] = depths[link] + lows[target];
+            if(returned[tag] == TRUE) { continue; }
+            if((unsigned int) returns[tag] > functions) {
+                RAISE_ERROR_M(
+                    RUNTIME_EXCEPTION_ERROR_CODE,
+                    (unsigned char *) "Unbounded stack underflow in recursion"
+                );
+            }
+            work[tail] = tag;
+            tail = (tail + 1) % count;
+            work_count++;
+            returned[tag] = TRUE;
+            returns[tag]++;
+        }
+    }
+    if(lows[0] < 0) {
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Stack underflow in program"
+        );
+    }
+
+    /* verifies that the program halts with an empty stack and
+    that the stack frame of each function covers its highest
+    depth, as the frames are used to reserve the stacks */
+    for(index = 0; index < count; index++) {
+        if(tags[index] == 0 && operations[index].opcode == HALT && depths[index] != 0) {
+            VERIFY_FAIL("Non empty stack on halt at #%08x", index);
+        }
+        if(tags[index] != index) { continue; }
+        return_value = mingus_frame(module, index, &depth_frame);
+        if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+        if(depth_frame < (unsigned int) highs[index]) {
+            VERIFY_FAIL("Invalid stack frame for function #%08x", index);
+        }
+    }
+
+    /* raises no error */
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE mingus_verify(struct module_t *module) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* allocates the per operation analysis arrays, the stack depth
+    at the start of the operation (relative to the entry of its
+    function) and the function (entry index) it belongs to, and the
+    per function arrays (indexed by entry), the depth at return, the
+    lowest depth reached (including callees) and the highest one */
+    size_t count = module->header.code_count + 1;
+    int *depths = (int *) MALLOC(count * sizeof(int));
+    unsigned int *tags = (unsigned int *) MALLOC(count * sizeof(unsigned int));
+    int *returns = (int *) MALLOC(count * sizeof(int));
+    unsigned char *returned = (unsigned char *) MALLOC(count * sizeof(unsigned char));
+    int *lows = (int *) MALLOC(count * sizeof(int));
+    int *highs = (int *) MALLOC(count * sizeof(int));
+
+    /* allocates the worklist of the operations (each one is queued
+    when first reached and a call once more when its function
+    returns) and the lists of calls of each function */
+    unsigned int *work = (unsigned int *) MALLOC(2 * count * sizeof(unsigned int));
+    unsigned int *links = (unsigned int *) MALLOC(2 * count * sizeof(unsigned int));
+
+    /* verifies that every one of the analysis arrays has been
+    allocated, the verification is only run in such case */
+    unsigned char allocated = depths != NULL && tags != NULL &&
+        returns != NULL && returned != NULL && lows != NULL &&
+        highs != NULL && work != NULL && links != NULL;
+
+    /* runs the verification of the module and releases the
+    analysis arrays, propagating the (possible) error */
+    return_value = allocated ? verify_module(
+        module, depths, tags, returns, returned, lows, highs, work, links
+    ) : RUNTIME_EXCEPTION_ERROR_CODE;
+    if(depths != NULL) { FREE(depths); }
+    if(tags != NULL) { FREE(tags); }
+    if(returns != NULL) { FREE(returns); }
+    if(returned != NULL) { FREE(returned); }
+    if(lows != NULL) { FREE(lows); }
+    if(highs != NULL) { FREE(highs); }
+    if(work != NULL) { FREE(work); }
+    if(links != NULL) { FREE(links); }
+    if(allocated == FALSE) {
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem allocating verification arrays"
+        );
+    }
+    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+
+    /* raises no error */
+    RAISE_NO_ERROR;
+}
@@ -0,0 +1,49 @@
+/*
+ Mingus Virtual Machine
+ Copyright (c) 2008-2020 Hive Solutions Lda.
+
+ This file is part of Mingus Virtual Machine.
+
+ Mingus Virtual Machine is free software: you can redistribute it and/or modify
+ it under the terms of the Apache License as published by the Apache
+ Foundation, either version 2.0 of the License, or (at your option) any
+ later version.
+
+ Mingus Virtual Machine is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ Apache License for more details.
+
+ You should have received a copy of the Apache License along with
+ Mingus Virtual Machine. If not, see <http://www.apache.org/licenses/>.
+
+ __author__    = João Magalhães <joamag@hive.pt>
+ __version__   = 1.0.0
+ __revision__  = $LastChangedRevision$
+ __date__      = $LastChangedDate$
+ __copyright__ = Copyright (c) 2008-2020 João Magalhães
+ __license__   = Apache License, Version 2.0
+*/
+
+#pragma once
+
+/**
+ * Verifies the (pre-decoded and unfused) operations of the
+ * module, running once at load time so that the engines are
+ * able to run the operations without any further checks.
+ *
+ * The verification runs an abstract interpretation of the
+ * stack depth over the control flow graph of the program and
+ * of each function, proving that the depth is statically
+ * known at each operation, that the stack never underflows
+ * (including through calls and recursion), that execution
+ * never falls off the end of the code, that return is only
+ * used inside functions, that the global indexes are within
+ * the globals table (and string globals are never stored)
+ * and that the stack frames of the module cover the maximum
+ * stack depth of each function.
+ *
+ * @param module The module with the operations to verify.
+ * @return The error code on the function execution.
+ */
+ERROR_CODE mingus_verify(struct module_t *module);
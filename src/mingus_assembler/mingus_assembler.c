@@ -33,9 +33,67 @@
  */
 #define _UNDEFINED -127
 
+/**
+ * The undefined value for the (integer wide)
+ * immediate value of the instructions.
+ */
+#define _UNDEFINED_IMMEDIATE (-2147483647 - 1)
+
+/**
+ * The size in bytes of the chunks in which the input
+ * file is read, a token crossing the end of a chunk is
+ * carried into the next one (growing the buffer only in
+ * case the token is larger than the chunk).
+ */
+#define MINGUS_CHUNK_SIZE 65536
+
+/**
+ * The minimum size in bytes of each of the parts in which
+ * the input file is split to be assembled in parallel, so
+ * that small inputs are assembled sequentially.
+ */
+#define MINGUS_PART_SIZE 262144
+
+/**
+ * The vectorized scanning of the input is available for the
+ * x86-64 targets built with GCC (or compatible), SSE2 is part
+ * of the baseline of the architecture and AVX2 is selected at
+ * runtime, the remaining targets use the scalar scanning.
+ */
+#if defined(__GNUC__) && defined(__x86_64__)
+#define MINGUS_SCAN_SIMD
+#endif
+
 /* starts the memory structures */
 START_MEMORY;
 
+/**
+ * Function that classifies a block of 64 bytes of the input
+ * setting a bit (per byte) in each of the classes, the blanks
+ * (space, line ends and null), the line ends (including null)
+ * and the quotes.
+ */
+typedef void (*mingus_classify)(
+    char *pointer,
+    unsigned long long *blanks,
+    unsigned long long *lines,
+    unsigned long long *quotes
+);
+
+/**
+ * The structural index of a chunk of the input, the bitmaps
+ * (a bit per byte) of the classes of bytes that change the
+ * state of the parser, so that the bytes in between may be
+ * skipped in bulk (whitespace runs, tokens, comments and strings).
+ */
+typedef struct scan_index_t {
+    unsigned long long *blanks;
+    unsigned long long *lines;
+    unsigned long long *quotes;
+    size_t capacity;
+    mingus_classify classify;
+} scan_index;
+
 /**
  * Enumeration defining all the possible
  * states for the mingus assembler parser.
@@ -56,6 +114,101 @@ typedef enum mingus_sections_e {
     DATA
 } mingus_sections;
 
+/**
+ * Growable byte buffer used to accumulate the contents
+ * of a section while parsing.
+ */
+typedef struct section_buffer_t {
+    char *pointer;
+    size_t size;
+    size_t capacity;
+} section_buffer;
+
+/**
+ * The mnemonic of an opcode, with the number of operands
+ * that follow it (zero for the complete instructions).
+ */
+typedef struct mnemonic_t {
+    const char *name;
+    size_t size;
+    enum opcodes_e opcode;
+    size_t operands;
+} mnemonic;
+
+/**
+ * The perfect hash of a mnemonic (no collisions for the
+ * complete set of mnemonics), computed from the first, second
+ * and last characters and the size of the (null terminated)
+ * string, indexing the mnemonic slots table.
+ */
+#define MINGUS_MNEMONIC_HASH(STRING, SIZE) ((\
+    (unsigned char) (STRING)[0] * 4 +\
+    (unsigned char) (STRING)[1] +\
+    (unsigned char) (STRING)[(SIZE) - 1] * 5 +\
+    (SIZE)) & 127)
+
+/**
+ * The complete set of mnemonics (including the aliases
+ * of the branches), indexed by the mnemonic slots.
+ */
+static struct mnemonic_t mnemonics[] = {
+    { "load", 4, LOAD, 1 },
+    { "loadi", 5, LOADI, 1 },
+    { "store", 5, STORE, 1 },
+    { "add", 3, ADD, 0 },
+    { "sub", 3, SUB, 0 },
+    { "pop", 3, POP, 0 },
+    { "cmp", 3, CMP, 1 },
+    { "jmp", 3, JMP, 1 },
+    { "jmp_eq", 6, JMP_EQ, 1 },
+    { "jeq", 3, JMP_EQ, 1 },
+    { "jmp_neq", 7, JMP_NEQ, 1 },
+    { "jneq", 4, JMP_NEQ, 1 },
+    { "jmp_abs", 7, JMP_ABS, 1 },
+    { "jabs", 4, JMP_ABS, 1 },
+    { "call", 4, CALL, 2 },
+    { "ret", 3, RET, 0 },
+    { "print", 5, PRINT, 0 },
+    { "prints", 6, PRINTS, 0 },
+    { "halt", 4, HALT, 0 },
+    { "rload", 5, RLOAD, 2 },
+    { "rloadi", 6, RLOADI, 2 },
+    { "rstore", 6, RSTORE, 2 },
+    { "rmov", 4, RMOV, 2 },
+    { "radd", 4, RADD, 3 },
+    { "rsub", 4, RSUB, 3 },
+    { "raddi", 5, RADDI, 2 },
+    { "rsubi", 5, RSUBI, 2 },
+    { "rcmp_eq", 7, RCMP_EQ, 3 },
+    { "rcmp_neq", 8, RCMP_NEQ, 3 },
+    { "rjmp_eq", 7, RJMP_EQ, 2 },
+    { "rjeq", 4, RJMP_EQ, 2 },
+    { "rjmp_neq", 8, RJMP_NEQ, 2 },
+    { "rjneq", 5, RJMP_NEQ, 2 },
+    { "rjmp_nz", 7, RJMP_NZ, 2 },
+    { "rjnz", 4, RJMP_NZ, 2 },
+    { "rprint", 6, RPRINT, 1 },
+    { "rprints", 7, RPRINTS, 1 }
+};
+
+/**
+ * The slots of the perfect hash table, the index (plus
+ * one) of the mnemonic with the hash or zero for none,
+ * filled from the mnemonics table at startup.
+ */
+static unsigned char mnemonic_slots[128];
+
+/**
+ * Reference to a label not yet defined (forward reference)
+ * from a branch instruction, backpatched once the complete
+ * input has been parsed, the name is an offset into the
+ * references buffer of the parser.
+ */
+typedef struct fixup_t {
+    size_t instruction;
+    size_t name;
+} fixup;
+
 /**
  * Primary structure to be used in the parsing
  * of the assembly input file, should contain all
@@ -93,12 +246,50 @@ typedef struct mingus_parser_t {
      */
     struct instructionf_t *instruction;
 
+    /**
+     * The number of instructions that fit in the currently
+     * allocated instructions and targets arrays (grown on demand).
+     */
+    size_t instruction_capacity;
+
     /**
      * Array that contains the complete set of instructions for
-     * the program, the static based allocation of memory poses
-     * a limitation on the assembled number of instructions.
+     * the program, grown (doubling) as the instructions are parsed.
+     */
+    struct instructionf_t *instructions;
+
+    /**
+     * The resolved (absolute) target instruction index for each
+     * of the branch instructions, filled while parsing (or when
+     * backpatching the forward references) so that the code may
+     * be rewritten before the final encoding.
+     */
+    size_t *targets;
+
+    /**
+     * The number of forward references waiting for the
+     * definition of their label.
+     */
+    size_t fixup_count;
+
+    /**
+     * The number of fixups that fit in the currently
+     * allocated fixups array (grown on demand).
+     */
+    size_t fixup_capacity;
+
+    /**
+     * The forward references to the labels, backpatched
+     * once the complete input has been parsed, the ones to
+     * labels of other units are kept as the relocations.
      */
-    struct instructionf_t instructions[1024];
+    struct fixup_t *fixups;
+
+    /**
+     * The (null terminated) names of the labels referenced
+     * by the fixups, in order.
+     */
+    struct section_buffer_t references;
 
     /**
      * Integer variable that control the number of data elements
@@ -106,6 +297,12 @@ typedef struct mingus_parser_t {
      */
     size_t data_element_count;
 
+    /**
+     * The number of data elements that fit in the currently
+     * allocated data elements array (grown on demand).
+     */
+    size_t data_element_capacity;
+
     /**
      * The reference to the current data element in parsing so that its
      * attributes can be directly manipulated.
@@ -116,7 +313,48 @@ typedef struct mingus_parser_t {
      * The complete set of data elements available parsed, to be used
      * latter in the output of the file.
      */
-    struct data_elementf_t data_elements[64];
+    struct data_elementf_t *data_elements;
+
+    /**
+     * The packed values of the data elements, each element aligned
+     * to the width of its type, the contents of the value section.
+     */
+    struct section_buffer_t values;
+
+    /**
+     * The (null terminated) names of the data elements in order,
+     * the contents of the debug section.
+     */
+    struct section_buffer_t names;
+
+    /**
+     * Integer variable that control the number of constants
+     * stored in the constant pool of the module.
+     */
+    size_t constant_count;
+
+    /**
+     * The number of constants that fit in the currently
+     * allocated constant pool (grown on demand).
+     */
+    size_t constant_capacity;
+
+    /**
+     * The constant pool with the values that do not fit the
+     * immediate field of the instructions, referenced by index.
+     */
+    int *constants;
+
+    /**
+     * The stack frames (entry and maximum stack depth) of
+     * the program entry and of each of the called functions.
+     */
+    struct frame_entry_t *frames;
+
+    /**
+     * The number of stack frames, sorted by their entry.
+     */
+    size_t frame_count;
 
     /**
      * The hash map that maps the label name (as a string) to the
@@ -125,13 +363,89 @@ typedef struct mingus_parser_t {
     struct hash_map_t *labels;
 
     /**
-     * The hash map that associates the index of the data elements
-     * (effective global memory offset position) with the effective
-     * data element structure for it.
+     * The hash map that associates the name of the data elements
+     * with their index (effective global memory offset position),
+     * stored incremented by one as for the labels.
      */
     struct hash_map_t *elements;
+
+    /**
+     * If the parser is one of the parsers of a parallel assembly,
+     * in which case the labels with numeric names are rejected as
+     * they're ambiguous with the numeric targets of the other parts.
+     */
+    char parallel;
+
+    /**
+     * The index of the part of the input parsed in a parallel
+     * assembly, the parts other than the first one allow neither
+     * data sections nor absolute numeric targets.
+     */
+    size_t part;
+
+    /**
+     * The label definitions (the instruction of each label and
+     * its name in the references), the symbol table of the unit
+     * and the labels of a part merged into the first part.
+     */
+    size_t definition_count;
+    size_t definition_capacity;
+    struct fixup_t *definitions;
+
+    /**
+     * The references of a part (other than the first one) to data
+     * elements, resolved with the data elements of the first part.
+     */
+    size_t unknown_count;
+    size_t unknown_capacity;
+    struct fixup_t *unknowns;
+
+    /**
+     * The buffer for the chunks of the input and its size,
+     * only grown in case a token is larger than a chunk.
+     */
+    char *buffer;
+    size_t buffer_capacity;
+
+    /**
+     * The structural index of the current chunk.
+     */
+    struct scan_index_t scan;
 } mingus_parser;
 
+/**
+ * A part of the input assembled in parallel, a range of lines
+ * of the file parsed by its own parser (first phase) and then
+ * linked at its base into the parser of the first part (second
+ * phase), each phase runs one thread per part.
+ */
+typedef struct part_t {
+    struct mingus_parser_t *parser;
+    struct mingus_parser_t *first;
+    char *file_path;
+    size_t begin;
+    size_t end;
+    size_t base;
+    char final;
+    ERROR_CODE (*phase)(struct part_t *part);
+    ERROR_CODE result;
+#ifndef _WIN32
+    pthread_t thread;
+#endif
+} part;
+
+/**
+ * The heat of a function of the program (the time spent in
+ * it by a profiled run) used by the linker to place the hot
+ * functions together, the rank is the position of the function
+ * in the layout with no profile (the order of the ties).
+ */
+typedef struct heat_t {
+    unsigned long long heat;
+    size_t rank;
+    size_t chain;
+} heat;
+
 #define MINGUS_MARK(FOR) MINGUS_MARK_N(FOR, 0)
 #define MINGUS_MARK_BACK(FOR) MINGUS_MARK_N(FOR, 1)
 #define MINGUS_MARK_N(FOR, N)\
@@ -141,9 +455,8 @@ typedef struct mingus_parser_t {
 
 #define MINGUS_CALLBACK(FOR)\
     do {\
-        if(on_##FOR(&parser) != 0) {\
-            RAISE_ERROR_M(RUNTIME_EXCEPTION_ERROR_CODE, (unsigned char *) "Problem handling callback"); \
-        }\
+        ERROR_CODE callback_value = on_##FOR(parser);\
+        if(IS_ERROR_CODE(callback_value)) { RAISE_AGAIN(callback_value); }\
     } while(0)
 
 #define MINGUS_CALLBACK_DATA(FOR) MINGUS_CALLBACK_DATA_N(FOR, 0)
@@ -151,13 +464,32 @@ typedef struct mingus_parser_t {
 #define MINGUS_CALLBACK_DATA_N(FOR, N)\
     do {\
         if(FOR##_mark) {\
-            if(on_##FOR(&parser, FOR##_mark, pointer - FOR##_mark - N) != 0) {\
-                RAISE_ERROR_M(RUNTIME_EXCEPTION_ERROR_CODE, (unsigned char *) "Problem handling callback"); \
-            }\
+            ERROR_CODE callback_value = on_##FOR(parser, FOR##_mark, pointer - FOR##_mark - N);\
+            if(IS_ERROR_CODE(callback_value)) { RAISE_AGAIN(callback_value); }\
             FOR##_mark = NULL;\
         }\
     } while(0)
 
+#if defined(__GNUC__)
+#define MINGUS_CTZ(value) ((size_t) __builtin_ctzll(value))
+#else
+#define MINGUS_CTZ(value) count_trailing(value)
+#endif
+
+#ifdef _WIN32
+#define MINGUS_MKDIR(path) _mkdir(path)
+#else
+#define MINGUS_MKDIR(path) mkdir(path, 0755)
+#endif
+
+#define MINGUS_SCAN(CLASS, MATCH)\
+    do {\
+        position = (size_t) (pointer - start);\
+        value = (scan->CLASS[position >> 6] ^ (MATCH ? 0ULL : ~0ULL)) >> (position & 63);\
+        if(value == 0) { pointer = start + scan_next(scan->CLASS, position, count, MATCH); }\
+        else { pointer += MINGUS_CTZ(value); if(pointer > end) { pointer = end; } }\
+    } while(0)
+
 void put_code(unsigned int instruction, FILE *file) {
     putc((instruction & 0x000000ff), file);
     putc((instruction & 0x0000ff00) >> 8, file);
@@ -166,618 +498,3409 @@ void put_code(unsigned int instruction, FILE *file) {
 }
 
 void put_buffer(char *buffer, size_t size, FILE *file) {
+    if(size == 0) { return; }
     fwrite(buffer, 1, size, file);
 }
 
-ERROR_CODE on_token_end(struct mingus_parser_t *parser, char *pointer, size_t size) {
-    /* allocates space for the token string to be parsed and
-    copies the contents from the current pointer to it */
-    char *string = MALLOC(size + 1);
-    memcpy(string, pointer, size);
-    string[size] = '\0';
-
-    /* in case the string starts with a dot it must represent a section
-    changer and must be treated as such */
-    if(string[0] == '.') {
-        if(strcmp(string, ".text") == 0) {
-            parser->section = TEXT;
-        } else if(strcmp(string, ".data") == 0) {
-            parser->section = DATA;
-        } else {
-            RAISE_ERROR_F(
-                RUNTIME_EXCEPTION_ERROR_CODE,
-                (unsigned char *) "Invalid section %s",
-                string
-            );
-        }
+void append_section(struct section_buffer_t *section, char *data, size_t size) {
+    /* grows the buffer (doubling its capacity) until the new
+    data fits and then copies the data (zeros if unset) to it */
+    if(size == 0) { return; }
+    while(section->size + size > section->capacity) {
+        section->capacity = section->capacity == 0 ? 256 : section->capacity * 2;
+        section->pointer = (char *) REALLOC(section->pointer, section->capacity);
     }
+    if(data == NULL) { memset(section->pointer + section->size, 0, size); }
+    else { memcpy(section->pointer + section->size, data, size); }
+    section->size += size;
+}
 
-    else if(parser->section == DATA) {
-        /* in case the token ends with a colon then this is a
-        new data allocation */
-        if(string[size - 1] == ':') {
-            parser->data_element = &parser->data_elements[parser->data_element_count];
+void put_padding(size_t offset, FILE *file) {
+    /* writes zero bytes until the (current) offset is
+    aligned to the section alignment of the format */
+    for(; offset != MINGUS_ALIGN(offset); offset++) { putc(0, file); }
+}
 
-            parser->data_element->offset = parser->data_element_count;
-            parser->data_element->type = UNSET_T;
-            parser->data_element->size = 0;
+ERROR_CODE get_register(char *string, char *index) {
+    long value;
+    char *end;
 
-            memcpy(parser->data_element->name, string, size - 1);
-            parser->data_element->name[size - 1] = '\0';
+    /* parses the register index from the token (eg: r12), the token
+    must be the prefix followed only by the digits of a valid index */
+    value = -1;
+    if(string[0] == 'r' && string[1] >= '0' && string[1] <= '9') {
+        value = strtol(string + 1, &end, 10);
+        if(*end != '\0') { value = -1; }
+    }
+    if(value < 0 || value >= MINGUS_REGISTER_COUNT) {
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Invalid register %s",
+            string
+        );
+    }
+    *index = (char) value;
 
-            set_value_string_hash_map(parser->elements, (unsigned char *) parser->data_element->name, parser->data_element);
+    /* raises no error */
+    RAISE_NO_ERROR;
+}
 
-            /* increments the number of data elements meaning
-            that a new data element has been found */
-            parser->data_element_count++;
-        }
-        else if(parser->data_element->type == UNSET_T) {
-            if(strcmp(string, "db") == 0) {
-                parser->data_element->type = BYTE_T;
-            } else if(strcmp(string, "dw") == 0) {
-                parser->data_element->type = WORD_T;
-            } else if(strcmp(string, "dd") == 0) {
-                parser->data_element->type = DWORD_T;
-            } else if(strcmp(string, "dq") == 0) {
-                parser->data_element->type = QWORD_T;
-            }
-        }
-    }
+ERROR_CODE get_immediate(char *string, int *immediate) {
+    long long value;
 
-    /* otherwise in case the last character in the string is a
-    colon this token is considered to be a label */
-    else if(string[size - 1] == ':') {
-        string[size - 1] = '\0';
-        set_value_string_hash_map(parser->labels, (unsigned char *) string, (void *) parser->instruction_count);
-        V_DEBUG_F("label '%s' #%08x\n", string, (unsigned int) parser->instruction_count);
+    /* parses the literal with a wider type so that a value that
+    does not fit the (integer wide) immediate is an error instead
+    of being wrapped, the pool takes any 32 bit value other than
+    the minimum one (the undefined immediate) */
+    value = strtoll(string, NULL, 10);
+    if(value <= _UNDEFINED_IMMEDIATE || value > 2147483647LL) {
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Immediate out of range %s",
+            string
+        );
     }
+    *immediate = (int) value;
 
-    /* otherwise it's considered to be an opcode reference
-    and should be processed normally */
-    else if(parser->instruction == NULL) {
-        /* sets the current instruction pointer in the
-        parser for correct execution */
-        parser->instruction = &parser->instructions[parser->instruction_count];
-
-        /* increments the number of instructions processed
-        (this is the instruction counter) */
-        parser->instruction_count++;
-
-        /* initializes the new instruction that has been created
-        with the default values (as expecteed) */
-        parser->instruction->code = 0x00000000;
-        parser->instruction->opcode = UNSET_OPCODE;
-        parser->instruction->arg1 = _UNDEFINED;
-        parser->instruction->arg2 = _UNDEFINED;
-        parser->instruction->arg3 = _UNDEFINED;
-        parser->instruction->immediate = _UNDEFINED;
-        parser->instruction->position = parser->instruction_count;
+    /* raises no error */
+    RAISE_NO_ERROR;
+}
 
-        V_DEBUG_F("opcode '%s'\n", string);
+size_t get_label(struct mingus_parser_t *parser, char *string, size_t *address) {
+    /* retrieves the address of the label from the labels map, the
+    addresses are stored incremented by one so that a label on the
+    first instruction is not confused with a missing one */
+    size_t value;
+    get_value_string_hash_map(parser->labels, (unsigned char *) string, (void **) &value);
+    if(value == (size_t) NULL) { return FALSE; }
+    *address = value - 1;
+    return TRUE;
+}
 
-        if(strcmp(string, "load") == 0) {
-            parser->instruction->opcode = LOAD;
-        } else if(strcmp(string, "loadi") == 0) {
-            parser->instruction->opcode = LOADI;
-        } else if(strcmp(string, "store") == 0) {
-            parser->instruction->opcode = STORE;
-        } else if(strcmp(string, "add") == 0) {
-            parser->instruction->opcode = ADD;
-            parser->instruction = NULL;
-        } else if(strcmp(string, "sub") == 0) {
-            parser->instruction->opcode = SUB;
-            parser->instruction = NULL;
-        } else if(strcmp(string, "pop") == 0) {
-            parser->instruction->opcode = POP;
-            parser->instruction = NULL;
-        } else if(strcmp(string, "cmp") == 0) {
-            parser->instruction->opcode = CMP;
-        } else if(strcmp(string, "jmp") == 0) {
-            parser->instruction->opcode = JMP;
-        } else if(strcmp(string, "jmp_eq") == 0 || strcmp(string, "jeq") == 0) {
-            parser->instruction->opcode = JMP_EQ;
-        } else if(strcmp(string, "jmp_neq") == 0 || strcmp(string, "jneq") == 0) {
-            parser->instruction->opcode = JMP_NEQ;
-        } else if(strcmp(string, "jmp_abs") == 0 || strcmp(string, "jabs") == 0) {
-            parser->instruction->opcode = JMP_ABS;
-        } else if(strcmp(string, "call") == 0) {
-            parser->instruction->opcode = CALL;
-        } else if(strcmp(string, "ret") == 0) {
-            parser->instruction->opcode = RET;
-        } else if(strcmp(string, "print") == 0)  {
-            parser->instruction->opcode = PRINT;
-            parser->instruction = NULL;
-        } else if(strcmp(string, "prints") == 0)  {
-            parser->instruction->opcode = PRINTS;
-            parser->instruction = NULL;
-        } else if(strcmp(string, "halt") == 0) {
-            parser->instruction->opcode = HALT;
-            parser->instruction = NULL;
-        } else {
+size_t get_element(struct mingus_parser_t *parser, char *string, int *index) {
+    /* retrieves the index of the data element from the elements
+    map, stored incremented by one (as for the labels) */
+    size_t value;
+    get_value_string_hash_map(parser->elements, (unsigned char *) string, (void **) &value);
+    if(value == (size_t) NULL) { return FALSE; }
+    *index = (int) value - 1;
+    return TRUE;
+}
+
+size_t is_branch(enum opcodes_e opcode) {
+    switch(opcode) {
+        case JMP:
+        case JMP_EQ:
+        case JMP_NEQ:
+        case JMP_ABS:
+        case CALL:
+        case RJMP_EQ:
+        case RJMP_NEQ:
+        case RJMP_NZ:
+            return TRUE;
+
+        default:
+            return FALSE;
+    }
+}
+
+size_t is_relative(enum opcodes_e opcode) {
+    switch(opcode) {
+        case JMP:
+        case JMP_EQ:
+        case JMP_NEQ:
+        case RJMP_EQ:
+        case RJMP_NEQ:
+        case RJMP_NZ:
+            return TRUE;
+
+        default:
+            return FALSE;
+    }
+}
+
+ERROR_CODE init_mnemonics() {
+    size_t index;
+    size_t hash;
+
+    /* fills the slots of the perfect hash table with the index
+    (plus one) of each of the mnemonics, verifying that no two
+    of them share the same slot (the hash must be perfect) */
+    memset(mnemonic_slots, 0, sizeof(mnemonic_slots));
+    for(index = 0; index < sizeof(mnemonics) / sizeof(struct mnemonic_t); index++) {
+        hash = MINGUS_MNEMONIC_HASH(mnemonics[index].name, mnemonics[index].size);
+        if(mnemonic_slots[hash] != 0) {
             RAISE_ERROR_F(
                 RUNTIME_EXCEPTION_ERROR_CODE,
-                (unsigned char *) "Invalid opcode %s",
-                string
+                (unsigned char *) "Mnemonic hash collision %s %s",
+                mnemonics[mnemonic_slots[hash] - 1].name,
+                mnemonics[index].name
             );
         }
+        mnemonic_slots[hash] = (unsigned char) (index + 1);
     }
 
-    /* otherwise it should be one of the operands to the processing
-    of the current context, should add more information */
-    else {
-        switch(parser->instruction->opcode) {
-            case HALT:
-                break;
-
-            case LOAD:
-                if(parser->instruction->immediate == _UNDEFINED) {
-                    get_value_string_hash_map(parser->elements, (unsigned char *) string, (void **) &parser->data_element);
-                    parser->instruction->immediate = parser->data_element->offset;
-                    parser->instruction = NULL;
-                }
-
-                break;
-
-            case LOADI:
-            case STORE:
-                if(parser->instruction->immediate == _UNDEFINED) {
-                    parser->instruction->immediate = atoi(string);
-                    parser->instruction = NULL;
-                }
+    /* returns with no error */
+    RAISE_NO_ERROR;
+}
 
-                break;
+struct mnemonic_t *get_mnemonic(char *string, size_t size) {
+    /* retrieves the only possible mnemonic for the string from
+    the perfect hash and verifies that it's the same string */
+    struct mnemonic_t *mnemonic;
+    size_t index = mnemonic_slots[MINGUS_MNEMONIC_HASH(string, size)];
+    if(index == 0) { return NULL; }
+    mnemonic = &mnemonics[index - 1];
+    if(mnemonic->size != size || memcmp(mnemonic->name, string, size) != 0) { return NULL; }
+    return mnemonic;
+}
 
-            case JMP:
-            case JMP_EQ:
-            case JMP_NEQ:
-                if(parser->instruction->immediate == _UNDEFINED) {
-                    memcpy(parser->instruction->string, string, size + 1);
-                    parser->instruction->immediate = atoi(string);
-                    parser->instruction = NULL;
-                }
+struct instructionf_t *new_instruction(struct mingus_parser_t *parser) {
+    struct instructionf_t *instruction;
 
-                break;
+    /* grows the instructions and targets arrays (doubling their
+    capacity) in case there's no space for the new instruction */
+    if(parser->instruction_count == parser->instruction_capacity) {
+        parser->instruction_capacity = parser->instruction_capacity == 0 ? 1024 : parser->instruction_capacity * 2;
+        parser->instructions = (struct instructionf_t *) REALLOC(
+            parser->instructions,
+            parser->instruction_capacity * sizeof(struct instructionf_t)
+        );
+        parser->targets = (size_t *) REALLOC(
+            parser->targets,
+            parser->instruction_capacity * sizeof(size_t)
+        );
+    }
 
-            case CALL:
-                if(parser->instruction->immediate == _UNDEFINED) {
-                    memcpy(parser->instruction->string, string, size + 1);
-                    parser->instruction->immediate = atoi(string);
-                } else if(parser->instruction->arg1 == _UNDEFINED) {
-                    parser->instruction->arg1 = atoi(string);
-                    parser->instruction = NULL;
-                }
+    /* initializes the new instruction with the default
+    values and increments the instruction counter */
+    instruction = &parser->instructions[parser->instruction_count];
+    instruction->opcode = UNSET_OPCODE;
+    instruction->arg1 = _UNDEFINED;
+    instruction->arg2 = _UNDEFINED;
+    instruction->arg3 = _UNDEFINED;
+    instruction->immediate = _UNDEFINED_IMMEDIATE;
+    parser->targets[parser->instruction_count] = 0;
+    parser->instruction_count++;
+    return instruction;
+}
 
-                break;
+void add_fixup(
+    struct mingus_parser_t *parser,
+    struct fixup_t **fixups,
+    size_t *count,
+    size_t *capacity,
+    size_t instruction,
+    char *string,
+    size_t size
+) {
+    /* grows the fixups array (doubling its capacity) in case there's
+    no space for the new fixup and then adds it, appending the name
+    (null terminated) to the references of the parser */
+    if(*count == *capacity) {
+        *capacity = *capacity == 0 ? 256 : *capacity * 2;
+        *fixups = (struct fixup_t *) REALLOC(*fixups, *capacity * sizeof(struct fixup_t));
+    }
+    (*fixups)[*count].instruction = instruction;
+    (*fixups)[*count].name = parser->references.size;
+    append_section(&parser->references, string, size + 1);
+    (*count)++;
+}
 
-            case ADD:
-            case SUB:
-                break;
+size_t is_number(char *string) {
+    /* verifies that the complete string is a (base ten)
+    number, as the numeric targets of the branches */
+    char *end;
+    strtol(string, &end, 10);
+    return end != string && *end == '\0';
+}
 
-            case CMP:
-                if(parser->instruction->arg1 == _UNDEFINED) {
-                    parser->instruction->arg1 = atoi(string);
-                    parser->instruction = NULL;
-                }
+ERROR_CODE add_reference(struct mingus_parser_t *parser, char *string, size_t size) {
+    size_t index = parser->instruction_count - 1;
+    size_t address;
+    long value;
 
-                break;
+    /* in case the label is already defined (backward reference)
+    the target of the branch is resolved right away */
+    if(get_label(parser, string, &address)) {
+        parser->targets[index] = address;
+        RAISE_NO_ERROR;
+    }
 
-            default:
-                break;
+    /* in case the token is a number the target is either relative
+    to the position (index plus one) of the instruction or absolute */
+    if(is_number(string)) {
+        value = strtol(string, NULL, 10);
+        if(is_relative(parser->instructions[index].opcode)) {
+            parser->targets[index] = (size_t) ((long) parser->instruction_count + value);
+        } else if(parser->part == 0) {
+            parser->targets[index] = (size_t) value;
+        } else {
+            RAISE_ERROR_F(
+                RUNTIME_EXCEPTION_ERROR_CODE,
+                (unsigned char *) "Absolute target %s in parallel part",
+                string
+            );
         }
+        RAISE_NO_ERROR;
     }
 
-    /* releases the current string memory (avoids any
-    possible memory leak */
-    FREE(string);
+    /* otherwise this is a forward reference and a fixup is added
+    so that the target is backpatched once the label is defined */
+    add_fixup(
+        parser,
+        &parser->fixups,
+        &parser->fixup_count,
+        &parser->fixup_capacity,
+        index,
+        string,
+        size
+    );
 
-    /* raises no error */
     RAISE_NO_ERROR;
 }
 
-ERROR_CODE on_comment_end(struct mingus_parser_t *parser, char *pointer, size_t size) {
-    char *string = MALLOC(size + 1);
-    memcpy(string, pointer, size);
-    string[size] = '\0';
-
-    FREE(string);
-
-    /* raises no error */
+ERROR_CODE add_element(struct mingus_parser_t *parser, char *string, size_t size) {
+    /* resolves the data element of the current (load) instruction,
+    in a part other than the first one the data elements are those
+    of the first part so the reference is resolved when linking */
+    if(get_element(parser, string, &parser->instruction->immediate)) { RAISE_NO_ERROR; }
+    if(parser->part == 0) {
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Invalid data element %s",
+            string
+        );
+    }
+    add_fixup(
+        parser,
+        &parser->unknowns,
+        &parser->unknown_count,
+        &parser->unknown_capacity,
+        parser->instruction_count - 1,
+        string,
+        size
+    );
+    parser->instruction->immediate = 0;
     RAISE_NO_ERROR;
 }
 
-ERROR_CODE on_string_end(struct mingus_parser_t *parser, char *pointer, size_t size) {
-    char *string = MALLOC(size + 1);
-    memcpy(string, pointer + 1, size - 1);
-    string[size - 1] = '\0';
+ERROR_CODE close_element(struct mingus_parser_t *parser) {
+    /* in case there's no data element being parsed there's
+    nothing remaining to be done */
+    if(parser->data_element == NULL) { RAISE_NO_ERROR; }
 
-    if(parser->section == DATA && parser->data_element) {
-        parser->data_element->size = size - 1;
-        memcpy(parser->data_element->value, string, size - 1);
-        parser->data_element = NULL;
+    /* verifies that the type of the data element has been
+    set (otherwise there's no value for it) */
+    if(parser->data_element->type == UNSET_T) {
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Data element without type"
+        );
     }
 
-    FREE(string);
-
-    /* raises no error */
+    /* sets the size of the data element from the values added
+    to the buffer, the byte values are null terminated so that
+    they may be used as strings in place */
+    parser->data_element->size = (unsigned int) (parser->values.size - parser->data_element->offset);
+    if(parser->data_element->type == BYTE_T) { append_section(&parser->values, NULL, 1); }
+    parser->data_element = NULL;
     RAISE_NO_ERROR;
 }
 
-ERROR_CODE build_code(struct instructionf_t *instruction) {
-    instruction->code = 0x00000000;
-    instruction->code |= (instruction->opcode & 0x0000ffff) << 16;
+ERROR_CODE on_data_token(struct mingus_parser_t *parser, char *string, size_t size) {
+    /* allocates space for the value of a numeric token, the
+    width of the current type and the end of the number */
+    long long value;
+    size_t width;
+    char *end;
 
-    if(instruction->arg1 != _UNDEFINED) {
-        instruction->code |= (instruction->arg1 & 0x0000000f) << 8;
-    }
-
-    if(instruction->arg2 != _UNDEFINED) {
-        instruction->code |= (instruction->arg2 & 0x0000000f) << 4;
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* in case the token ends with a colon then this is a
+    new data allocation, the previous one is closed */
+    if(string[size - 1] == ':') {
+        return_value = close_element(parser);
+        if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+
+        if(parser->data_element_count == parser->data_element_capacity) {
+            parser->data_element_capacity = parser->data_element_capacity == 0 ? 64 : parser->data_element_capacity * 2;
+            parser->data_elements = (struct data_elementf_t *) REALLOC(
+                parser->data_elements,
+                parser->data_element_capacity * sizeof(struct data_elementf_t)
+            );
+        }
+        parser->data_element = &parser->data_elements[parser->data_element_count];
+        parser->data_element->type = UNSET_T;
+        parser->data_element->offset = 0;
+        parser->data_element->size = 0;
+        parser->data_element->name = (unsigned int) parser->names.size;
+
+        string[size - 1] = '\0';
+        append_section(&parser->names, string, size);
+
+        set_value_string_hash_map(parser->elements, (unsigned char *) string, (void *) (parser->data_element_count + 1));
+
+        /* increments the number of data elements meaning
+        that a new data element has been found */
+        parser->data_element_count++;
+    }
+    else if(parser->data_element == NULL) {
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Unexpected data token %s",
+            string
+        );
     }
+    else if(parser->data_element->type == UNSET_T) {
+        /* the data type directives are all two characters long
+        starting with a d, identified by the second character */
+        switch(size == 2 && string[0] == 'd' ? string[1] : '\0') {
+            case 'b':
+                parser->data_element->type = BYTE_T;
+                break;
 
-    if(instruction->arg3 != _UNDEFINED) {
-        instruction->code |= instruction->arg3 & 0x0000000f;
+            case 'w':
+                parser->data_element->type = WORD_T;
+                break;
+
+            case 'd':
+                parser->data_element->type = DWORD_T;
+                break;
+
+            case 'q':
+                parser->data_element->type = QWORD_T;
+                break;
+
+            default:
+                RAISE_ERROR_F(
+                    RUNTIME_EXCEPTION_ERROR_CODE,
+                    (unsigned char *) "Invalid data type %s",
+                    string
+                );
+        }
+
+        /* aligns the values buffer to the width of the type
+        so that the values may be read in place */
+        width = MINGUS_DATA_WIDTH(parser->data_element->type);
+        append_section(&parser->values, NULL, (width - parser->values.size % width) % width);
+        parser->data_element->offset = (unsigned int) parser->values.size;
+    }
+    else {
+        /* parses the numeric value (the separating comma is
+        optional) and appends it (little endian) to the values */
+        value = strtoll(string, &end, 0);
+        if(end == string || (*end != '\0' && strcmp(end, ",") != 0)) {
+            RAISE_ERROR_F(
+                RUNTIME_EXCEPTION_ERROR_CODE,
+                (unsigned char *) "Invalid data value %s",
+                string
+            );
+        }
+        for(width = MINGUS_DATA_WIDTH(parser->data_element->type); width > 0; width--) {
+            append_section(&parser->values, (char *) &value, 1);
+            value >>= 8;
+        }
+    }
+
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE on_token_end(struct mingus_parser_t *parser, char *pointer, size_t size) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* allocates space for the address of a label (used to
+    detect duplicated definitions) */
+    size_t address;
+
+    /* allocates space for the mnemonic of an opcode */
+    struct mnemonic_t *mnemonic;
+
+    /* the token is used in place (zero copy) from the input buffer
+    terminated by overwriting the delimiter that follows it (already
+    consumed by the parser) with a null byte */
+    char *string = pointer;
+    string[size] = '\0';
+
+    /* in case the string starts with a dot it must represent a section
+    changer and must be treated as such */
+    if(string[0] == '.') {
+        return_value = close_element(parser);
+        if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+        if(strcmp(string, ".text") == 0) {
+            parser->section = TEXT;
+        } else if(strcmp(string, ".data") == 0 && parser->part == 0) {
+            parser->section = DATA;
+        } else {
+            RAISE_ERROR_F(
+                RUNTIME_EXCEPTION_ERROR_CODE,
+                (unsigned char *) "Invalid section %s",
+                string
+            );
+        }
+    }
+
+    else if(parser->section == DATA) {
+        return_value = on_data_token(parser, string, size);
+        if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+    }
+
+    /* otherwise in case the last character in the string is a
+    colon this token is considered to be a label */
+    else if(string[size - 1] == ':') {
+        string[size - 1] = '\0';
+        if(get_label(parser, string, &address)) {
+            RAISE_ERROR_F(
+                RUNTIME_EXCEPTION_ERROR_CODE,
+                (unsigned char *) "Duplicate label %s",
+                string
+            );
+        }
+        if(parser->parallel && is_number(string)) {
+            RAISE_ERROR_F(
+                RUNTIME_EXCEPTION_ERROR_CODE,
+                (unsigned char *) "Numeric label %s in parallel part",
+                string
+            );
+        }
+        add_fixup(
+            parser,
+            &parser->definitions,
+            &parser->definition_count,
+            &parser->definition_capacity,
+            parser->instruction_count,
+            string,
+            size - 1
+        );
+        set_value_string_hash_map(parser->labels, (unsigned char *) string, (void *) (parser->instruction_count + 1));
+        V_DEBUG_F("label '%s' #%08x\n", string, (unsigned int) parser->instruction_count);
+    }
+
+    /* otherwise it's considered to be an opcode reference
+    and should be processed normally */
+    else if(parser->instruction == NULL) {
+        /* creates a new instruction (with the default values) and
+        sets it as the current one in the parser, so that it may be
+        completed with the operands */
+        parser->instruction = new_instruction(parser);
+
+        V_DEBUG_F("opcode '%s'\n", string);
+
+        /* retrieves the mnemonic from the perfect hash table, the
+        instructions with no operands are complete right away */
+        mnemonic = get_mnemonic(string, size);
+        if(mnemonic == NULL) {
+            RAISE_ERROR_F(
+                RUNTIME_EXCEPTION_ERROR_CODE,
+                (unsigned char *) "Invalid opcode %s",
+                string
+            );
+        }
+        parser->instruction->opcode = mnemonic->opcode;
+        if(mnemonic->operands == 0) { parser->instruction = NULL; }
+    }
+
+    /* otherwise it should be one of the operands to the processing
+    of the current context, should add more information */
+    else {
+        switch(parser->instruction->opcode) {
+            case HALT:
+                break;
+
+            case LOAD:
+                if(parser->instruction->immediate == _UNDEFINED_IMMEDIATE) {
+                    return_value = add_element(parser, string, size);
+                    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+                    parser->instruction = NULL;
+                }
+
+                break;
+
+            case LOADI:
+            case STORE:
+                if(parser->instruction->immediate == _UNDEFINED_IMMEDIATE) {
+                    return_value = get_immediate(string, &parser->instruction->immediate);
+                    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+                    parser->instruction = NULL;
+                }
+
+                break;
+
+            case JMP:
+            case JMP_EQ:
+            case JMP_NEQ:
+            case JMP_ABS:
+                if(parser->instruction->immediate == _UNDEFINED_IMMEDIATE) {
+                    return_value = add_reference(parser, string, size);
+                    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+                    parser->instruction->immediate = 0;
+                    parser->instruction = NULL;
+                }
+
+                break;
+
+            case CALL:
+                if(parser->instruction->immediate == _UNDEFINED_IMMEDIATE) {
+                    return_value = add_reference(parser, string, size);
+                    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+                    parser->instruction->immediate = 0;
+                } else if(parser->instruction->arg1 == _UNDEFINED) {
+                    parser->instruction->arg1 = atoi(string);
+                    parser->instruction = NULL;
+                }
+
+                break;
+
+            case ADD:
+            case SUB:
+                break;
+
+            case CMP:
+                if(parser->instruction->arg1 == _UNDEFINED) {
+                    parser->instruction->arg1 = atoi(string);
+                    parser->instruction = NULL;
+                }
+
+                break;
+
+            case RLOAD:
+                if(parser->instruction->arg1 == _UNDEFINED) {
+                    return_value = get_register(string, &parser->instruction->arg1);
+                    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+                } else if(parser->instruction->immediate == _UNDEFINED_IMMEDIATE) {
+                    return_value = add_element(parser, string, size);
+                    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+                    parser->instruction = NULL;
+                }
+
+                break;
+
+            case RLOADI:
+            case RSTORE:
+            case RADDI:
+            case RSUBI:
+                if(parser->instruction->arg1 == _UNDEFINED) {
+                    return_value = get_register(string, &parser->instruction->arg1);
+                    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+                } else if(parser->instruction->immediate == _UNDEFINED_IMMEDIATE) {
+                    return_value = get_immediate(string, &parser->instruction->immediate);
+                    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+                    parser->instruction = NULL;
+                }
+
+                break;
+
+            case RMOV:
+                if(parser->instruction->arg1 == _UNDEFINED) {
+                    return_value = get_register(string, &parser->instruction->arg1);
+                    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+                } else if(parser->instruction->arg2 == _UNDEFINED) {
+                    return_value = get_register(string, &parser->instruction->arg2);
+                    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+                    parser->instruction = NULL;
+                }
+
+                break;
+
+            case RADD:
+            case RSUB:
+            case RCMP_EQ:
+            case RCMP_NEQ:
+                if(parser->instruction->arg1 == _UNDEFINED) {
+                    return_value = get_register(string, &parser->instruction->arg1);
+                    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+                } else if(parser->instruction->arg2 == _UNDEFINED) {
+                    return_value = get_register(string, &parser->instruction->arg2);
+                    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+                } else if(parser->instruction->arg3 == _UNDEFINED) {
+                    return_value = get_register(string, &parser->instruction->arg3);
+                    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+                    parser->instruction = NULL;
+                }
+
+                break;
+
+            case RJMP_EQ:
+            case RJMP_NEQ:
+            case RJMP_NZ:
+                if(parser->instruction->arg1 == _UNDEFINED) {
+                    return_value = get_register(string, &parser->instruction->arg1);
+                    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+                } else if(parser->instruction->immediate == _UNDEFINED_IMMEDIATE) {
+                    return_value = add_reference(parser, string, size);
+                    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+                    parser->instruction->immediate = 0;
+                    parser->instruction = NULL;
+                }
+
+                break;
+
+            case RPRINT:
+            case RPRINTS:
+                if(parser->instruction->arg1 == _UNDEFINED) {
+                    return_value = get_register(string, &parser->instruction->arg1);
+                    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+                    parser->instruction = NULL;
+                }
+
+                break;
+
+            default:
+                break;
+        }
     }
 
-    if(instruction->immediate != _UNDEFINED) {
-        instruction->code |= instruction->immediate & 0x000000ff;
+    /* raises no error */
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE on_comment_end(struct mingus_parser_t *parser, char *pointer, size_t size) {
+    /* the comments are discarded (never copied) */
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE on_string_end(struct mingus_parser_t *parser, char *pointer, size_t size) {
+    /* the string is used in place from the input buffer, skipping
+    the opening quote (the closing one is not part of the token) */
+    char *string = pointer + 1;
+
+    /* the strings are only valid as the values of byte data
+    elements, appended to the values (without terminator) */
+    if(parser->section == DATA) {
+        if(parser->data_element == NULL || parser->data_element->type != BYTE_T) {
+            RAISE_ERROR_M(
+                RUNTIME_EXCEPTION_ERROR_CODE,
+                (unsigned char *) "String value outside byte data element"
+            );
+        }
+        append_section(&parser->values, string, size - 1);
     }
 
+    /* raises no error */
     RAISE_NO_ERROR;
 }
 
+unsigned int build_code(struct instructionf_t *instruction) {
+    unsigned int code = 0x00000000;
+    code |= (instruction->opcode & 0x000000ff) << 24;
+
+    if(instruction->arg1 != _UNDEFINED) {
+        code |= (instruction->arg1 & 0x0000000f) << 20;
+    }
+
+    if(instruction->arg2 != _UNDEFINED) {
+        code |= (instruction->arg2 & 0x0000000f) << 16;
+    }
+
+    if(instruction->arg3 != _UNDEFINED) {
+        code |= (instruction->arg3 & 0x0000000f) << 12;
+    }
+
+    /* the immediate is encoded with 24 bits for the opcodes without
+    argument fields and with 16 bits for the remaining ones */
+    if(instruction->immediate != _UNDEFINED_IMMEDIATE) {
+        if(MINGUS_WIDE(instruction->opcode)) {
+            code |= instruction->immediate & 0x00ffffff;
+        } else {
+            code |= instruction->immediate & 0x0000ffff;
+        }
+    }
+
+    return code;
+}
+
 ERROR_CODE add_instruction(
     struct mingus_parser_t *parser,
     enum opcodes_e opcode,
     char arg1,
     char arg2,
     char arg3,
-    char immediate
+    int immediate
 ) {
-    /* sets the current instruction pointer in the
-    parser for correct execution */
-    parser->instruction = &parser->instructions[parser->instruction_count];
-
-    /* increments the number of instruction processed
-    (this is the instruction counter) */
-    parser->instruction_count++;
-
-    /* initializes the parser's instruction code with
-    the default values (no issue) */
-    parser->instruction->code = 0x00000000;
+    /* creates a new instruction setting it as the current one
+    and then sets its values from the provided ones */
+    parser->instruction = new_instruction(parser);
     parser->instruction->opcode = opcode;
     parser->instruction->arg1 = arg1;
     parser->instruction->arg2 = arg2;
     parser->instruction->arg3 = arg3;
     parser->instruction->immediate = immediate;
-    parser->instruction->position = parser->instruction_count;
 
     /* raises no error as no problem occurred during execution */
     RAISE_NO_ERROR;
 }
 
-ERROR_CODE run(char *file_path, char *output_path) {
+ERROR_CODE resolve_targets(struct mingus_parser_t *parser) {
+    size_t index;
+    size_t count;
+    size_t address;
+    char *name;
+
+    /* iterates over the forward references to backpatch the target
+    of their branches, the references to labels not defined in the
+    unit are kept (in order) as its relocations, resolved when the
+    units are linked (the backward and numeric targets are resolved
+    while parsing) */
+    for(index = 0, count = 0; index < parser->fixup_count; index++) {
+        name = parser->references.pointer + parser->fixups[index].name;
+        if(!get_label(parser, name, &address)) {
+            parser->fixups[count++] = parser->fixups[index];
+            continue;
+        }
+        parser->targets[parser->fixups[index].instruction] = address;
+    }
+    parser->fixup_count = count;
+
+    /* raises no error */
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE visit_register(
+    int *depths,
+    size_t *tags,
+    size_t index,
+    size_t count,
+    int depth,
+    size_t tag,
+    size_t *changed
+) {
+    /* verifies that the target instruction exists and that the
+    stack is able to be mapped into the available registers */
+    if(index >= count) {
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Invalid branch target '%d'",
+            (int) index
+        );
+    }
+    if(depth < 0 || depth > MINGUS_REGISTER_COUNT) {
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Invalid stack depth %d at #%08x",
+            depth, (unsigned int) index
+        );
+    }
+
+    /* in case the instruction is visited for the first time sets
+    its depth and function, otherwise both must be consistent with
+    the previous visit for the mapping to be a valid one */
+    if(depths[index] < 0) {
+        depths[index] = depth;
+        tags[index] = tag;
+        *changed = TRUE;
+    } else if(depths[index] != depth || tags[index] != tag) {
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Inconsistent stack depth at #%08x",
+            (unsigned int) index
+        );
+    }
+
+    /* raises no error */
+    RAISE_NO_ERROR;
+}
+
+#define VISIT_REGISTER(INDEX, DEPTH, TAG)\
+    do {\
+        return_value = visit_register(depths, tags, INDEX, count, DEPTH, TAG, &changed);\
+        if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }\
+    } while(0)
+
+#define EMIT_REGISTER(OPCODE, ARG1, ARG2, ARG3, IMMEDIATE)\
+    do {\
+        output = &parser->instructions[offset];\
+        output->opcode = OPCODE;\
+        output->arg1 = ARG1;\
+        output->arg2 = ARG2;\
+        output->arg3 = ARG3;\
+        output->immediate = IMMEDIATE;\
+        offset++;\
+    } while(0)
+
+ERROR_CODE translate_registers(struct mingus_parser_t *parser) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    size_t index;
+    size_t offset;
+    size_t changed;
+    size_t count = parser->instruction_count;
+    size_t tag;
+    int depth;
+    char kind;
+    struct instructionf_t instruction;
+    struct instructionf_t *next;
+    struct instructionf_t *output;
+
+    /* allocates the per instruction analysis arrays, the stack depth
+    at the start of the instruction, the function (entry index) it
+    belongs to, the depth at return of each function, the new index
+    of each instruction and if the instruction is a branch target */
+    int *depths = (int *) MALLOC(count * sizeof(int));
+    size_t *tags = (size_t *) MALLOC(count * sizeof(size_t));
+    int *returns = (int *) MALLOC(count * sizeof(int));
+    size_t *remap = (size_t *) MALLOC(count * sizeof(size_t));
+    char *marks = (char *) MALLOC(count * sizeof(char));
+
+    for(index = 0; index < count; index++) {
+        depths[index] = -1;
+        returns[index] = -1;
+        marks[index] = FALSE;
+    }
+
+    for(index = 0; index < count; index++) {
+        if(!is_branch(parser->instructions[index].opcode)) { continue; }
+        if(parser->targets[index] >= count) { continue; }
+        marks[parser->targets[index]] = TRUE;
+    }
+
+    /* runs the abstract interpretation of the stack depth until a fixed
+    point is reached, the call instructions only fall through once the
+    return depth of the called function is known */
+    depths[0] = 0;
+    tags[0] = 0;
+    changed = TRUE;
+
+    while(changed) {
+        changed = FALSE;
+
+        for(index = 0; index < count; index++) {
+            if(depths[index] < 0) { continue; }
+
+            depth = depths[index];
+            tag = tags[index];
+
+            switch(parser->instructions[index].opcode) {
+                case LOAD:
+                case LOADI:
+                    VISIT_REGISTER(index + 1, depth + 1, tag);
+                    break;
+
+                case STORE:
+                case POP:
+                    VISIT_REGISTER(index + 1, depth - 1, tag);
+                    break;
+
+                case ADD:
+                case SUB:
+                    if(depth < 2) { depth = -1; }
+                    VISIT_REGISTER(index + 1, depth - 1, tag);
+                    break;
+
+                case CMP:
+                    if(depth < 2) { depth = -1; }
+                    VISIT_REGISTER(index + 1, depth, tag);
+                    break;
+
+                case PRINT:
+                case PRINTS:
+                    if(depth < 1) { depth = -1; }
+                    VISIT_REGISTER(index + 1, depth, tag);
+                    break;
+
+                case JMP_EQ:
+                case JMP_NEQ:
+                    VISIT_REGISTER(parser->targets[index], depth - 1, tag);
+                    VISIT_REGISTER(index + 1, depth - 1, tag);
+                    break;
+
+                case JMP:
+                case JMP_ABS:
+                    VISIT_REGISTER(parser->targets[index], depth, tag);
+                    break;
+
+                case CALL:
+                    VISIT_REGISTER(parser->targets[index], depth, parser->targets[index]);
+                    if(returns[parser->targets[index]] < 0) { break; }
+                    VISIT_REGISTER(index + 1, returns[parser->targets[index]], tag);
+                    break;
+
+                case RET:
+                    if(returns[tag] < 0) {
+                        returns[tag] = depth;
+                        changed = TRUE;
+                    } else if(returns[tag] != depth) {
+                        RAISE_ERROR_F(
+                            RUNTIME_EXCEPTION_ERROR_CODE,
+                            (unsigned char *) "Inconsistent return depth at #%08x",
+                            (unsigned int) index
+                        );
+                    }
+                    break;
+
+                case HALT:
+                    if(depth == 0) { break; }
+                    RAISE_ERROR_F(
+                        RUNTIME_EXCEPTION_ERROR_CODE,
+                        (unsigned char *) "Non empty stack on halt at #%08x",
+                        (unsigned int) index
+                    );
+
+                default:
+                    RAISE_ERROR_F(
+                        RUNTIME_EXCEPTION_ERROR_CODE,
+                        (unsigned char *) "Invalid opcode for translation at #%08x",
+                        (unsigned int) index
+                    );
+            }
+        }
+    }
+
+    /* emits the register based instructions in place (the output is
+    never larger than the input), each stack slot is mapped into the
+    register with the same index and unreachable code is dropped */
+    offset = 0;
+
+    for(index = 0; index < count; index++) {
+        remap[index] = offset;
+        if(depths[index] < 0) { continue; }
+
+        depth = depths[index];
+        instruction = parser->instructions[index];
+        next = index + 1 < count ? &parser->instructions[index + 1] : NULL;
+
+        /* tries to fuse the immediate load followed by an arithmetic
+        operation into a single register-immediate operation */
+        if(instruction.opcode == LOADI && next != NULL && !marks[index + 1] &&
+            (next->opcode == ADD || next->opcode == SUB) &&
+            instruction.immediate >= MINGUS_NARROW_MIN &&
+            instruction.immediate <= MINGUS_NARROW_MAX) {
+            EMIT_REGISTER(
+                next->opcode == ADD ? RADDI : RSUBI,
+                depth - 1, _UNDEFINED, _UNDEFINED, instruction.immediate
+            );
+            remap[++index] = offset - 1;
+            continue;
+        }
+
+        /* tries to fuse the comparison against zero followed by a
+        conditional jump into a single register based branch */
+        if(instruction.opcode == LOADI && instruction.immediate == 0 &&
+            index + 2 < count && !marks[index + 1] && !marks[index + 2] &&
+            next->opcode == CMP && (next->arg1 == 1 || next->arg1 == 2) &&
+            (parser->instructions[index + 2].opcode == JMP_EQ ||
+            parser->instructions[index + 2].opcode == JMP_NEQ)) {
+            kind = (next->arg1 == 1) == (parser->instructions[index + 2].opcode == JMP_EQ);
+            parser->targets[offset] = parser->targets[index + 2];
+            EMIT_REGISTER(
+                kind ? RJMP_NEQ : RJMP_NZ,
+                depth - 1, _UNDEFINED, _UNDEFINED, _UNDEFINED_IMMEDIATE
+            );
+            remap[++index] = offset - 1;
+            remap[++index] = offset - 1;
+            continue;
+        }
+
+        switch(instruction.opcode) {
+            case LOAD:
+                EMIT_REGISTER(RLOAD, depth, _UNDEFINED, _UNDEFINED, instruction.immediate);
+                break;
+
+            case LOADI:
+                EMIT_REGISTER(RLOADI, depth, _UNDEFINED, _UNDEFINED, instruction.immediate);
+                break;
+
+            case STORE:
+                EMIT_REGISTER(RSTORE, depth - 1, _UNDEFINED, _UNDEFINED, instruction.immediate);
+                break;
+
+            case ADD:
+                EMIT_REGISTER(RADD, depth - 2, depth - 2, depth - 1, _UNDEFINED_IMMEDIATE);
+                break;
+
+            case SUB:
+                EMIT_REGISTER(RSUB, depth - 2, depth - 2, depth - 1, _UNDEFINED_IMMEDIATE);
+                break;
+
+            case POP:
+                break;
+
+            case CMP:
+                if(instruction.arg1 == 1) {
+                    EMIT_REGISTER(RCMP_EQ, depth - 1, depth - 2, depth - 1, _UNDEFINED_IMMEDIATE);
+                } else if(instruction.arg1 == 2) {
+                    EMIT_REGISTER(RCMP_NEQ, depth - 1, depth - 2, depth - 1, _UNDEFINED_IMMEDIATE);
+                } else {
+                    EMIT_REGISTER(RLOADI, depth - 1, _UNDEFINED, _UNDEFINED, 0);
+                }
+                break;
+
+            case JMP_EQ:
+            case JMP_NEQ:
+                parser->targets[offset] = parser->targets[index];
+                EMIT_REGISTER(
+                    instruction.opcode == JMP_EQ ? RJMP_EQ : RJMP_NEQ,
+                    depth - 1, _UNDEFINED, _UNDEFINED, _UNDEFINED_IMMEDIATE
+                );
+                break;
+
+            case PRINT:
+                EMIT_REGISTER(RPRINT, depth - 1, _UNDEFINED, _UNDEFINED, _UNDEFINED_IMMEDIATE);
+                break;
+
+            case PRINTS:
+                EMIT_REGISTER(RPRINTS, depth - 1, _UNDEFINED, _UNDEFINED, _UNDEFINED_IMMEDIATE);
+                break;
+
+            default:
+                parser->targets[offset] = parser->targets[index];
+                parser->instructions[offset] = instruction;
+                offset++;
+                break;
+        }
+    }
+
+    /* updates the branch targets to the new instruction
+    indexes and the number of instructions in the parser */
+    for(index = 0; index < offset; index++) {
+        if(!is_branch(parser->instructions[index].opcode)) { continue; }
+        parser->targets[index] = remap[parser->targets[index]];
+    }
+    parser->instruction_count = offset;
+
+    /* releases the analysis arrays (avoids memory leaks) */
+    FREE(depths);
+    FREE(tags);
+    FREE(returns);
+    FREE(remap);
+    FREE(marks);
+
+    /* raises no error */
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE visit_frame(
+    int *depths,
+    size_t *tags,
+    size_t index,
+    size_t count,
+    int depth,
+    size_t tag,
+    size_t *work,
+    size_t *work_count
+) {
+    /* verifies that the target instruction exists */
+    if(index >= count) {
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Invalid branch target '%d'",
+            (int) index
+        );
+    }
+
+    /* in case the instruction is visited for the first time sets
+    its (relative) depth and function and queues it, otherwise both
+    must be the same as in the previous visit (statically known
+    depth), so that each instruction is only queued once */
+    if(tags[index] == (size_t) -1) {
+        depths[index] = depth;
+        tags[index] = tag;
+        work[(*work_count)++] = index;
+    } else if(depths[index] != depth || tags[index] != tag) {
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Inconsistent stack depth at #%08x",
+            (unsigned int) index
+        );
+    }
+
+    /* raises no error */
+    RAISE_NO_ERROR;
+}
+
+#define FREE_FRAMES()\
+    do {\
+        if(depths != NULL) { FREE(depths); }\
+        if(tags != NULL) { FREE(tags); }\
+        if(returns != NULL) { FREE(returns); }\
+        if(returned != NULL) { FREE(returned); }\
+        if(work != NULL) { FREE(work); }\
+        if(waiters != NULL) { FREE(waiters); }\
+    } while(0)
+
+#define VISIT_FRAME(INDEX, DEPTH, TAG)\
+    do {\
+        return_value = visit_frame(depths, tags, INDEX, count, DEPTH, TAG, work, &work_count);\
+        if(IS_ERROR_CODE(return_value)) { FREE_FRAMES(); RAISE_AGAIN(return_value); }\
+    } while(0)
+
+ERROR_CODE compute_frames(struct mingus_parser_t *parser) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    size_t index;
+    size_t count = parser->instruction_count;
+    size_t tag;
+    size_t target;
+    size_t waiter;
+    size_t work_count = 0;
+    int depth;
+
+    /* allocates the per instruction analysis arrays, the stack depth
+    at the start of the instruction (relative to the entry of its
+    function), the function (entry index) it belongs to and the
+    relative depth at return of each function, the worklist of the
+    instructions to be processed (each one is queued when first
+    visited and a call once more when its callee returns) and the
+    lists of the calls waiting for the return depth of a function
+    (head per function entry followed by the next call per call) */
+    int *depths = (int *) MALLOC(count * sizeof(int));
+    size_t *tags = (size_t *) MALLOC(count * sizeof(size_t));
+    int *returns = (int *) MALLOC(count * sizeof(int));
+    char *returned = (char *) MALLOC(count * sizeof(char));
+    size_t *work = (size_t *) MALLOC(2 * count * sizeof(size_t));
+    size_t *waiters = (size_t *) MALLOC(2 * count * sizeof(size_t));
+    if(depths == NULL || tags == NULL || returns == NULL ||
+        returned == NULL || work == NULL || waiters == NULL) {
+        FREE_FRAMES();
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem allocating frames"
+        );
+    }
+
+    for(index = 0; index < count; index++) {
+        tags[index] = (size_t) -1;
+        returned[index] = FALSE;
+        waiters[index] = (size_t) -1;
+    }
+
+    /* the entry of the program and the targets of every call are
+    the entries of the functions, all starting at depth zero */
+    depths[0] = 0;
+    tags[0] = 0;
+    work[work_count++] = 0;
+    for(index = 0; index < count; index++) {
+        if(parser->instructions[index].opcode != CALL) { continue; }
+        target = parser->targets[index];
+        if(target >= count || tags[target] == target) { continue; }
+        VISIT_FRAME(target, 0, target);
+    }
+
+    /* runs the abstract interpretation of the (relative) stack depth
+    over the worklist until it's empty, the call instructions only
+    fall through once the return depth of the called function is
+    known, until then they wait in the list of the function */
+    while(work_count > 0) {
+        index = work[--work_count];
+        depth = depths[index];
+        tag = tags[index];
+        target = parser->targets[index];
+
+        switch(parser->instructions[index].opcode) {
+            case LOAD:
+            case LOADI:
+            case LOADK:
+                VISIT_FRAME(index + 1, depth + 1, tag);
+                break;
+
+            case STORE:
+            case POP:
+            case ADD:
+            case SUB:
+                VISIT_FRAME(index + 1, depth - 1, tag);
+                break;
+
+            case JMP_EQ:
+            case JMP_NEQ:
+                VISIT_FRAME(target, depth - 1, tag);
+                VISIT_FRAME(index + 1, depth - 1, tag);
+                break;
+
+            case JMP:
+            case JMP_ABS:
+                VISIT_FRAME(target, depth, tag);
+                break;
+
+            case RJMP_EQ:
+            case RJMP_NEQ:
+            case RJMP_NZ:
+                VISIT_FRAME(target, depth, tag);
+                VISIT_FRAME(index + 1, depth, tag);
+                break;
+
+            case CALL:
+                if(target >= count) { break; }
+                if(returned[target] == FALSE) {
+                    waiters[count + index] = waiters[target];
+                    waiters[target] = index;
+                    break;
+                }
+                VISIT_FRAME(index + 1, depth + returns[target], tag);
+                break;
+
+            case RET:
+                if(returned[tag] == FALSE) {
+                    returns[tag] = depth;
+                    returned[tag] = TRUE;
+                    for(waiter = waiters[tag]; waiter != (size_t) -1; waiter = waiters[count + waiter]) {
+                        work[work_count++] = waiter;
+                    }
+                } else if(returns[tag] != depth) {
+                    FREE_FRAMES();
+                    RAISE_ERROR_F(
+                        RUNTIME_EXCEPTION_ERROR_CODE,
+                        (unsigned char *) "Inconsistent return depth at #%08x",
+                        (unsigned int) index
+                    );
+                }
+                break;
+
+            case HALT:
+                break;
+
+            default:
+                VISIT_FRAME(index + 1, depth, tag);
+                break;
+        }
+    }
+
+    /* creates the frames of the functions (sorted by entry), the
+    depth of each is the maximum depth of its instructions, the
+    returns array is reused to map each entry into its frame */
+    parser->frames = (struct frame_entry_t *) MALLOC(count * sizeof(struct frame_entry_t));
+    if(parser->frames == NULL) {
+        FREE_FRAMES();
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem allocating frames"
+        );
+    }
+    parser->frame_count = 0;
+    for(index = 0; index < count; index++) {
+        if(tags[index] != index) { continue; }
+        parser->frames[parser->frame_count].entry = (unsigned int) index;
+        parser->frames[parser->frame_count].depth = 0;
+        returns[index] = (int) parser->frame_count;
+        parser->frame_count++;
+    }
+    for(index = 0; index < count; index++) {
+        if(tags[index] == (size_t) -1 || depths[index] <= 0) { continue; }
+        tag = (size_t) returns[tags[index]];
+        if((unsigned int) depths[index] <= parser->frames[tag].depth) { continue; }
+        parser->frames[tag].depth = (unsigned int) depths[index];
+    }
+
+    /* releases the analysis arrays and returns with no error */
+    FREE_FRAMES();
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE pool_constant(struct mingus_parser_t *parser, int value, int *index) {
+    size_t _index;
+
+    /* tries to find the value in the current constant pool
+    so that repeated literals share the same entry */
+    for(_index = 0; _index < parser->constant_count; _index++) {
+        if(parser->constants[_index] != value) { continue; }
+        *index = (int) _index;
+        RAISE_NO_ERROR;
+    }
+
+    /* grows the constant pool (doubling its capacity) in
+    case there's no space for the new constant */
+    if(parser->constant_count == parser->constant_capacity) {
+        parser->constant_capacity = parser->constant_capacity == 0 ? 256 : parser->constant_capacity * 2;
+        parser->constants = (int *) REALLOC(
+            parser->constants,
+            parser->constant_capacity * sizeof(int)
+        );
+    }
+
+    parser->constants[parser->constant_count] = value;
+    *index = (int) parser->constant_count;
+    parser->constant_count++;
+
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE encode_immediates(struct mingus_parser_t *parser) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    size_t index;
+    int minimum;
+    int maximum;
+    struct instructionf_t *instruction;
+
+    /* iterates over the complete set of instructions moving the
+    immediate loads and the call targets that do not fit the
+    instruction into the constant pool and verifying that the
+    remaining immediates fit */
+    for(index = 0; index < parser->instruction_count; index++) {
+        instruction = &parser->instructions[index];
+        if(instruction->immediate == _UNDEFINED_IMMEDIATE) { continue; }
+
+        minimum = MINGUS_WIDE(instruction->opcode) ? MINGUS_WIDE_MIN : MINGUS_NARROW_MIN;
+        maximum = MINGUS_WIDE(instruction->opcode) ? MINGUS_WIDE_MAX : MINGUS_NARROW_MAX;
+
+        /* the absolute targets are unsigned so the range of
+        the field is doubled for them */
+        if(instruction->opcode == JMP_ABS || instruction->opcode == CALL) {
+            maximum = maximum * 2 + 1;
+            minimum = 0;
+        }
+
+        if(instruction->immediate >= minimum && instruction->immediate <= maximum) { continue; }
+
+        switch(instruction->opcode) {
+            case LOADI:
+            case RLOADI:
+                return_value = pool_constant(parser, instruction->immediate, &instruction->immediate);
+                if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+                if(instruction->immediate > maximum) {
+                    RAISE_ERROR_M(
+                        RUNTIME_EXCEPTION_ERROR_CODE,
+                        (unsigned char *) "Constant pool overflow"
+                    );
+                }
+                instruction->opcode = instruction->opcode == LOADI ? LOADK : RLOADK;
+                break;
+
+            case CALL:
+                return_value = pool_constant(parser, instruction->immediate, &instruction->immediate);
+                if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+                if(instruction->immediate > maximum) {
+                    RAISE_ERROR_M(
+                        RUNTIME_EXCEPTION_ERROR_CODE,
+                        (unsigned char *) "Constant pool overflow"
+                    );
+                }
+                instruction->opcode = CALLK;
+                break;
+
+            default:
+                RAISE_ERROR_F(
+                    RUNTIME_EXCEPTION_ERROR_CODE,
+                    (unsigned char *) "Immediate out of range at #%08x",
+                    (unsigned int) index
+                );
+        }
+    }
+
+    RAISE_NO_ERROR;
+}
+
+size_t count_trailing(unsigned long long value) {
+    /* counts the number of trailing zero bits of the (non
+    zero) value, the position of the lowest bit set (used
+    where there's no builtin for it, see MINGUS_CTZ) */
+    size_t count = 0;
+    for(; (value & 1) == 0; value >>= 1) { count++; }
+    return count;
+}
+
+void classify_scalar(
+    char *pointer,
+    unsigned long long *blanks,
+    unsigned long long *lines,
+    unsigned long long *quotes
+) {
+    size_t offset;
+    unsigned long long bit;
+
+    /* classifies the bytes of the block one at a time
+    setting the bit of the byte in each of its classes */
+    for(offset = 0; offset < 64; offset++) {
+        bit = 1ULL << offset;
+        switch(pointer[offset]) {
+            case '\r':
+            case '\n':
+            case '\0':
+                *lines |= bit;
+                *blanks |= bit;
+                break;
+
+            case ' ':
+                *blanks |= bit;
+                break;
+
+            case '"':
+                *quotes |= bit;
+                break;
+        }
+    }
+}
+
+#ifdef MINGUS_SCAN_SIMD
+
+void classify_sse2(
+    char *pointer,
+    unsigned long long *blanks,
+    unsigned long long *lines,
+    unsigned long long *quotes
+) {
+    size_t offset;
+    __m128i block;
+    __m128i line;
+    __m128i space = _mm_set1_epi8(' ');
+    __m128i carriage = _mm_set1_epi8('\r');
+    __m128i feed = _mm_set1_epi8('\n');
+    __m128i null = _mm_setzero_si128();
+    __m128i quote = _mm_set1_epi8('"');
+
+    /* classifies sixteen bytes at a time, the comparison masks
+    of each class are shifted into the position of the bytes */
+    for(offset = 0; offset < 64; offset += 16) {
+        block = _mm_loadu_si128((__m128i *) (pointer + offset));
+        line = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(block, carriage), _mm_cmpeq_epi8(block, feed)),
+            _mm_cmpeq_epi8(block, null)
+        );
+        *lines |= (unsigned long long) _mm_movemask_epi8(line) << offset;
+        *blanks |= (unsigned long long) _mm_movemask_epi8(
+            _mm_or_si128(line, _mm_cmpeq_epi8(block, space))
+        ) << offset;
+        *quotes |= (unsigned long long) _mm_movemask_epi8(_mm_cmpeq_epi8(block, quote)) << offset;
+    }
+}
+
+__attribute__((target("avx2")))
+void classify_avx2(
+    char *pointer,
+    unsigned long long *blanks,
+    unsigned long long *lines,
+    unsigned long long *quotes
+) {
+    size_t offset;
+    __m256i block;
+    __m256i line;
+    __m256i space = _mm256_set1_epi8(' ');
+    __m256i carriage = _mm256_set1_epi8('\r');
+    __m256i feed = _mm256_set1_epi8('\n');
+    __m256i null = _mm256_setzero_si256();
+    __m256i quote = _mm256_set1_epi8('"');
+
+    /* classifies thirty two bytes at a time (as for the
+    sixteen bytes of the SSE2 version) */
+    for(offset = 0; offset < 64; offset += 32) {
+        block = _mm256_loadu_si256((__m256i *) (pointer + offset));
+        line = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(block, carriage), _mm256_cmpeq_epi8(block, feed)),
+            _mm256_cmpeq_epi8(block, null)
+        );
+        *lines |= (unsigned long long) (unsigned int) _mm256_movemask_epi8(line) << offset;
+        *blanks |= (unsigned long long) (unsigned int) _mm256_movemask_epi8(
+            _mm256_or_si256(line, _mm256_cmpeq_epi8(block, space))
+        ) << offset;
+        *quotes |= (unsigned long long) (unsigned int) _mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(block, quote)
+        ) << offset;
+    }
+}
+
+#endif
+
+mingus_classify select_classify() {
+    /* selects the widest classification available in the
+    processor running the assembler, or the scalar one */
+#ifdef MINGUS_SCAN_SIMD
+    if(__builtin_cpu_supports("avx2")) { return classify_avx2; }
+    return classify_sse2;
+#else
+    return classify_scalar;
+#endif
+}
+
+void index_chunk(struct scan_index_t *index, char *pointer, size_t count) {
+    size_t word;
+    size_t words = (count + 63) / 64;
+    char tail[64];
+
+    /* grows the bitmaps of the index in case the chunk
+    (the buffer may grow) does not fit them */
+    if(words > index->capacity) {
+        index->capacity = words;
+        index->blanks = (unsigned long long *) REALLOC(index->blanks, words * sizeof(unsigned long long));
+        index->lines = (unsigned long long *) REALLOC(index->lines, words * sizeof(unsigned long long));
+        index->quotes = (unsigned long long *) REALLOC(index->quotes, words * sizeof(unsigned long long));
+    }
+
+    /* classifies the chunk in blocks of 64 bytes, the last
+    (partial) block is copied into a block padded with bytes
+    of no class so that the input is never read past its end */
+    memset(index->blanks, 0, words * sizeof(unsigned long long));
+    memset(index->lines, 0, words * sizeof(unsigned long long));
+    memset(index->quotes, 0, words * sizeof(unsigned long long));
+    for(word = 0; word < words; word++) {
+        if(count - word * 64 < 64) {
+            memset(tail, 'x', 64);
+            memcpy(tail, pointer + word * 64, count - word * 64);
+            index->classify(tail, &index->blanks[word], &index->lines[word], &index->quotes[word]);
+            break;
+        }
+        index->classify(pointer + word * 64, &index->blanks[word], &index->lines[word], &index->quotes[word]);
+    }
+}
+
+size_t scan_next(unsigned long long *bits, size_t position, size_t count, char match) {
+    /* retrieves the word of the position (inverted in case the
+    first byte not in the class is requested) with the bits of
+    the previous positions cleared */
+    unsigned long long invert = match ? 0ULL : ~0ULL;
+    size_t word = position / 64;
+    unsigned long long value = (bits[word] ^ invert) & (~0ULL << (position % 64));
+
+    /* iterates over the words until one with a bit set is
+    found, the position of the first byte with the requested
+    membership (limited to the end of the chunk) */
+    while(value == 0) {
+        word++;
+        if(word * 64 >= count) { return count; }
+        value = bits[word] ^ invert;
+    }
+    position = word * 64 + MINGUS_CTZ(value);
+    return position < count ? position : count;
+}
+
+void init_parser(struct mingus_parser_t *parser) {
+    /* updates the parser structure setting the initial state
+    (normal in the text section) and empty buffers */
+    parser->state = NORMAL;
+    parser->section = TEXT;
+    parser->output = NULL;
+    parser->instruction = NULL;
+    parser->instruction_count = 0;
+    parser->instruction_capacity = 0;
+    parser->instructions = NULL;
+    parser->targets = NULL;
+    parser->fixup_count = 0;
+    parser->fixup_capacity = 0;
+    parser->fixups = NULL;
+    memset(&parser->references, 0, sizeof(struct section_buffer_t));
+    parser->data_element = NULL;
+    parser->data_element_count = 0;
+    parser->data_element_capacity = 0;
+    parser->data_elements = NULL;
+    parser->frames = NULL;
+    parser->frame_count = 0;
+    memset(&parser->values, 0, sizeof(struct section_buffer_t));
+    memset(&parser->names, 0, sizeof(struct section_buffer_t));
+    parser->constant_count = 0;
+    parser->constant_capacity = 0;
+    parser->constants = NULL;
+    parser->parallel = FALSE;
+    parser->part = 0;
+    parser->definition_count = 0;
+    parser->definition_capacity = 0;
+    parser->definitions = NULL;
+    parser->unknown_count = 0;
+    parser->unknown_capacity = 0;
+    parser->unknowns = NULL;
+    parser->buffer = NULL;
+    parser->buffer_capacity = 0;
+
+    /* creates the structural index of the chunks, used to skip
+    in bulk the bytes that do not change the state of the parser */
+    parser->scan.blanks = NULL;
+    parser->scan.lines = NULL;
+    parser->scan.quotes = NULL;
+    parser->scan.capacity = 0;
+    parser->scan.classify = select_classify();
+
+    /* creates the hash maps to hold the labels
+    and the data elements */
+    create_hash_map(&parser->labels, 0);
+    create_hash_map(&parser->elements, 0);
+}
+
+void release_parser(struct mingus_parser_t *parser) {
+    /* releases the buffers, to avoid any memory leaking */
+    if(parser->buffer != NULL) { FREE(parser->buffer); }
+    if(parser->scan.blanks != NULL) { FREE(parser->scan.blanks); }
+    if(parser->scan.lines != NULL) { FREE(parser->scan.lines); }
+    if(parser->scan.quotes != NULL) { FREE(parser->scan.quotes); }
+    if(parser->instructions != NULL) { FREE(parser->instructions); }
+    if(parser->targets != NULL) { FREE(parser->targets); }
+    if(parser->fixups != NULL) { FREE(parser->fixups); }
+    if(parser->definitions != NULL) { FREE(parser->definitions); }
+    if(parser->unknowns != NULL) { FREE(parser->unknowns); }
+    if(parser->references.pointer != NULL) { FREE(parser->references.pointer); }
+    if(parser->constants != NULL) { FREE(parser->constants); }
+    if(parser->data_elements != NULL) { FREE(parser->data_elements); }
+    if(parser->values.pointer != NULL) { FREE(parser->values.pointer); }
+    if(parser->names.pointer != NULL) { FREE(parser->names.pointer); }
+    if(parser->frames != NULL) { FREE(parser->frames); }
+    delete_hash_map(parser->labels);
+    delete_hash_map(parser->elements);
+}
+
+ERROR_CODE parse_range(
+    struct mingus_parser_t *parser,
+    FILE *file,
+    char *file_path,
+    size_t size,
+    char final
+) {
+    /* allocates space for the byte to be used
+    durring the parsing of the file */
+    char byte;
+
+    char is_final;
+
+    size_t count;
+    size_t carry;
+    size_t remaining;
+
+    char *pointer;
+    char *end;
+    char *mark;
+
+    char *start;
+    size_t position;
+    unsigned long long value;
+    struct scan_index_t *scan;
+
+    char *token_end_mark;
+    char *comment_end_mark;
+    char *string_end_mark;
+
+    /* allocates the buffer for the chunks of the file, the file
+    is never read completely into memory (streaming) */
+    if(parser->buffer == NULL) {
+        parser->buffer_capacity = MINGUS_CHUNK_SIZE;
+        parser->buffer = (char *) MALLOC(parser->buffer_capacity);
+    }
+    scan = &parser->scan;
+    remaining = size;
+    carry = 0;
+    token_end_mark = NULL;
+    comment_end_mark = NULL;
+    string_end_mark = NULL;
+
+    /* unsets the is final variable as the first cycle is
+    never the final one */
+    is_final = FALSE;
+
+    /* iterates over the chunks of the range until the end of it
+    is reached, in case the range is the final one a null byte is
+    parsed after its last chunk so that the last token is closed */
+    while(is_final == FALSE) {
+        /* reads the next chunk after the bytes carried from the
+        previous one (up to the end of the range), an empty read
+        means the end of the range */
+        count = parser->buffer_capacity - carry;
+        if(count > remaining) { count = remaining; }
+        count = fread(parser->buffer + carry, 1, count, file);
+        remaining -= count;
+        if(count == 0) {
+            if(ferror(file)) {
+                RAISE_ERROR_F(
+                    RUNTIME_EXCEPTION_ERROR_CODE,
+                    (unsigned char *) "Problem reading file %s",
+                    file_path
+                );
+            }
+            if(!final) { break; }
+            parser->buffer[carry] = '\0';
+            count = 1;
+            is_final = TRUE;
+        }
+
+        /* indexes the chunk and then iterates over its bytes
+        to parse them and generate the instructions */
+        start = parser->buffer + carry;
+        end = start + count;
+        index_chunk(scan, start, count);
+        for(pointer = start; pointer < end; pointer++) {
+            /* skips in bulk the bytes that do not change the state
+            of the parser (the rest of a whitespace run, token, comment
+            or string) stopping at the next relevant byte */
+            switch(parser->state) {
+                case NORMAL:
+                    MINGUS_SCAN(blanks, FALSE);
+                    break;
+
+                case TOKEN:
+                    MINGUS_SCAN(blanks, TRUE);
+                    break;
+
+                case COMMENT:
+                    MINGUS_SCAN(lines, TRUE);
+                    break;
+
+                case STRING:
+                    MINGUS_SCAN(quotes, TRUE);
+                    break;
+            }
+            if(pointer == end) { break; }
+
+            byte = *pointer;
+
+            /* switches over the current state of the parser
+            to operate accordingly over the current buffer */
+            switch(parser->state) {
+                case NORMAL:
+                    switch(byte) {
+                        case ';':
+                            parser->state = COMMENT;
+
+                            MINGUS_MARK(comment_end);
+
+                            /* breaks the switch */
+                            break;
+
+                        case '"':
+                            parser->state = STRING;
+
+                            MINGUS_MARK(string_end);
+
+                            /* breaks the switch */
+                            break;
+
+                        case ' ':
+                        case '\r':
+                        case '\n':
+                        case '\0':
+                            /* breaks the switch */
+                            break;
+
+                        default:
+                            /* sets the current parsing state as
+                            token to be used in the parsing loop */
+                            parser->state = TOKEN;
+
+                            /* marks the beggining of the token
+                            to be used latter in the callback */
+                            MINGUS_MARK(token_end);
+
+                            /* breaks the switch */
+                            break;
+                    }
+
+                    /* breaks the switch */
+                    break;
+
+                case TOKEN:
+                    switch(byte) {
+                        case ' ':
+                        case '\r':
+                        case '\n':
+                        case '\0':
+                            parser->state = NORMAL;
+
+                            MINGUS_CALLBACK_DATA(token_end);
+
+                            /* breaks the switch */
+                            break;
+
+                        default:
+                            /* breaks the switch */
+                            break;
+                    }
+
+                    /* breaks the switch */
+                    break;
+
+                case COMMENT:
+                    switch(byte) {
+                        case '\r':
+                        case '\n':
+                        case '\0':
+                            parser->state = NORMAL;
+
+                            MINGUS_CALLBACK_DATA(comment_end);
+
+                            /* breaks the switch */
+                            break;
+
+                        default:
+                            /* breaks the switch */
+                            break;
+                    }
+
+                    /* breaks the switch */
+                    break;
+
+                case STRING:
+                    switch(byte) {
+                        case '"':
+                            parser->state = NORMAL;
+
+                            MINGUS_CALLBACK_DATA(string_end);
+
+                            /* breaks the switch */
+                            break;
+
+                        default:
+                            /* breaks the switch */
+                            break;
+                    }
+
+                    /* breaks the switch */
+                    break;
+            }
+        }
+
+        /* carries the pending token (comment or string) to the start
+        of the buffer so that it's completed by the next chunk, the
+        buffer is only grown in case the token fills all of it */
+        mark = token_end_mark ? token_end_mark : comment_end_mark ? comment_end_mark : string_end_mark;
+        carry = mark == NULL ? 0 : (size_t) (end - mark);
+        if(carry == 0) { continue; }
+        memmove(parser->buffer, mark, carry);
+        if(carry == parser->buffer_capacity) {
+            parser->buffer_capacity *= 2;
+            parser->buffer = (char *) REALLOC(parser->buffer, parser->buffer_capacity);
+        }
+        if(token_end_mark) { token_end_mark = parser->buffer; }
+        if(comment_end_mark) { comment_end_mark = parser->buffer; }
+        if(string_end_mark) { string_end_mark = parser->buffer; }
+    }
+
+
+    /* raises no error */
+    RAISE_NO_ERROR;
+}
+
+static void *part_worker(void *arguments) {
+    /* runs the current phase over the part, the result
+    is kept in the part (verified once all are done) */
+    struct part_t *part = (struct part_t *) arguments;
+    part->result = part->phase(part);
+    return NULL;
+}
+
+void run_parts(struct part_t *parts, size_t count, ERROR_CODE (*phase)(struct part_t *part)) {
+    size_t index;
+
+    /* runs the phase over every part (one thread per part) and
+    waits for all of them to finish, without threads the parts
+    run in sequence in the current thread */
+    for(index = 0; index < count; index++) { parts[index].phase = phase; }
+#ifndef _WIN32
+    for(index = 0; index < count; index++) {
+        pthread_create(&parts[index].thread, NULL, part_worker, &parts[index]);
+    }
+    for(index = 0; index < count; index++) {
+        pthread_join(parts[index].thread, NULL);
+    }
+#else
+    for(index = 0; index < count; index++) { part_worker(&parts[index]); }
+#endif
+}
+
+ERROR_CODE parse_part(struct part_t *part) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* allocates space for the (own) handle to the input
+    file so that the parts are read concurrently */
+    FILE *file;
+
+    /* opens the input file positioned at the start of the
+    part and parses the range of the part */
+    FOPEN(&file, part->file_path, "rb");
+    if(file == NULL) {
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem opening file %s",
+            part->file_path
+        );
+    }
+    fseek(file, (long) part->begin, SEEK_SET);
+    return_value = parse_range(part->parser, file, part->file_path, part->end - part->begin, part->final);
+    fclose(file);
+    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+
+    /* raises no error */
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE link_part(struct part_t *part) {
+    size_t index;
+    size_t count;
+    size_t address;
+    char *name;
+    struct instructionf_t *instruction;
+    struct mingus_parser_t *parser = part->parser;
+    struct mingus_parser_t *first = part->first;
+
+    /* copies the instructions of the part into their final position
+    (the first part is already in place) rebasing the targets of its
+    branches, the relative numeric targets are part relative */
+    if(parser != first) {
+        memcpy(
+            first->instructions + part->base,
+            parser->instructions,
+            parser->instruction_count * sizeof(struct instructionf_t)
+        );
+        for(index = 0; index < parser->instruction_count; index++) {
+            first->targets[part->base + index] = parser->targets[index];
+            if(is_branch(parser->instructions[index].opcode)) { first->targets[part->base + index] += part->base; }
+        }
+    }
+
+    /* backpatches the forward references of the part with the
+    merged labels of all the parts (as the sequential resolution),
+    the ones to labels of other units are kept in the part */
+    for(index = 0, count = 0; index < parser->fixup_count; index++) {
+        name = parser->references.pointer + parser->fixups[index].name;
+        if(!get_label(first, name, &address)) {
+            parser->fixups[count++] = parser->fixups[index];
+            continue;
+        }
+        first->targets[part->base + parser->fixups[index].instruction] = address;
+    }
+    parser->fixup_count = count;
+
+    /* resolves the references to the data elements (all of
+    them defined in the data section of the first part) */
+    for(index = 0; index < parser->unknown_count; index++) {
+        name = parser->references.pointer + parser->unknowns[index].name;
+        instruction = &first->instructions[part->base + parser->unknowns[index].instruction];
+        if(!get_element(first, name, &instruction->immediate)) {
+            RAISE_ERROR_F(
+                RUNTIME_EXCEPTION_ERROR_CODE,
+                (unsigned char *) "Invalid data element %s",
+                name
+            );
+        }
+    }
+
+    /* raises no error */
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE parse_parallel(struct mingus_parser_t *parser, char *file_path, size_t jobs, char *parallel) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    size_t index;
+    size_t count;
+    size_t size;
+    size_t offset;
+    size_t position;
+    size_t total;
+    size_t address;
+    char *name;
+    int byte;
+    struct mingus_parser_t *current;
+    struct fixup_t *definition;
+    struct part_t *parts;
+    FILE *file;
+
+    /* retrieves the size of the input file, the number of parts is
+    limited by the number of jobs and by the minimum size of a part,
+    in case there's a single part the parsing is sequential */
+    *parallel = FALSE;
+    FOPEN(&file, file_path, "rb");
+    if(file == NULL) { RAISE_NO_ERROR; }
+    fseek(file, 0, SEEK_END);
+    size = (size_t) ftell(file);
+    count = size / MINGUS_PART_SIZE;
+    if(count > jobs) { count = jobs; }
+    if(count < 2) {
+        fclose(file);
+        RAISE_NO_ERROR;
+    }
+
+    /* splits the input at line boundaries, each part ends right
+    after the first line end from the end of its share of the input
+    (the last part at the end of the input) so that no token crosses
+    two parts, a long line may leave less parts than requested */
+    parts = (struct part_t *) MALLOC(count * sizeof(struct part_t));
+    for(index = 0, position = 0; index < count && position < size; index++) {
+        parts[index].begin = position;
+        offset = index == count - 1 ? size : (index + 1) * (size / count);
+        if(offset < position) { offset = position; }
+        fseek(file, (long) offset, SEEK_SET);
+        while(offset < size) {
+            byte = getc(file);
+            offset++;
+            if(byte == '\n' || byte == EOF) { break; }
+        }
+        parts[index].end = offset;
+        position = offset;
+    }
+    fclose(file);
+    count = index;
+
+    /* creates a parser for each of the parts (the first part
+    uses the provided parser) and parses them in parallel */
+    for(index = 0; index < count; index++) {
+        parts[index].first = parser;
+        parts[index].file_path = file_path;
+        parts[index].final = index == count - 1;
+        parts[index].base = 0;
+        parts[index].result = 0;
+        if(index == 0) {
+            parts[index].parser = parser;
+        } else {
+            parts[index].parser = (struct mingus_parser_t *) MALLOC(sizeof(struct mingus_parser_t));
+            init_parser(parts[index].parser);
+        }
+        parts[index].parser->parallel = TRUE;
+        parts[index].parser->part = index;
+    }
+    run_parts(parts, count, parse_part);
+
+    /* verifies that the parts were parsed, every part other than the
+    last must end in the text section with no instruction or data
+    element pending (their operands can't continue in another part)
+    and computes the base of each part in the merged instructions */
+    return_value = 0;
+    for(index = 0, total = 0; index < count; index++) {
+        current = parts[index].parser;
+        if(IS_ERROR_CODE(parts[index].result)) { return_value = parts[index].result; }
+        if(!parts[index].final && (current->state != NORMAL || current->section != TEXT
+            || current->instruction != NULL || current->data_element != NULL)) {
+            return_value = RUNTIME_EXCEPTION_ERROR_CODE;
+        }
+        parts[index].base = total;
+        total += current->instruction_count;
+    }
+
+    /* merges the label definitions of the parts into the labels
+    of the first part (rebased), a duplicated label is an error */
+    for(index = 1; index < count && !IS_ERROR_CODE(return_value); index++) {
+        current = parts[index].parser;
+        for(position = 0; position < current->definition_count; position++) {
+            definition = &current->definitions[position];
+            name = current->references.pointer + definition->name;
+            if(get_label(parser, name, &address)) {
+                return_value = RUNTIME_EXCEPTION_ERROR_CODE;
+                break;
+            }
+            set_value_string_hash_map(
+                parser->labels,
+                (unsigned char *) name,
+                (void *) (parts[index].base + definition->instruction + 1)
+            );
+            add_fixup(
+                parser,
+                &parser->definitions,
+                &parser->definition_count,
+                &parser->definition_capacity,
+                parts[index].base + definition->instruction,
+                name,
+                strlen(name)
+            );
+        }
+    }
+
+    /* grows the instructions of the first part to hold all of
+    them and links the parts in parallel, each part writes its
+    own range of the instructions (no locking required) */
+    if(!IS_ERROR_CODE(return_value)) {
+        if(total > parser->instruction_capacity) {
+            parser->instruction_capacity = total;
+            parser->instructions = (struct instructionf_t *) REALLOC(
+                parser->instructions,
+                parser->instruction_capacity * sizeof(struct instructionf_t)
+            );
+            parser->targets = (size_t *) REALLOC(
+                parser->targets,
+                parser->instruction_capacity * sizeof(size_t)
+            );
+        }
+        run_parts(parts, count, link_part);
+        for(index = 0; index < count; index++) {
+            if(IS_ERROR_CODE(parts[index].result)) { return_value = parts[index].result; }
+        }
+
+        /* moves the references of the parts to labels of other
+        units into the first part (rebased), in order */
+        for(index = 1; index < count; index++) {
+            current = parts[index].parser;
+            for(position = 0; position < current->fixup_count; position++) {
+                name = current->references.pointer + current->fixups[position].name;
+                add_fixup(
+                    parser,
+                    &parser->fixups,
+                    &parser->fixup_count,
+                    &parser->fixup_capacity,
+                    parts[index].base + current->fixups[position].instruction,
+                    name,
+                    strlen(name)
+                );
+            }
+        }
+        parser->instruction_count = total;
+        parser->instruction = NULL;
+    }
+
+    /* releases the parsers of the parts (other than the first)
+    and the parts, the instructions are now in the first one */
+    for(index = 1; index < count; index++) {
+        release_parser(parts[index].parser);
+        FREE(parts[index].parser);
+    }
+    FREE(parts);
+
+    /* in case any of the parts failed raises an error so that the
+    input is parsed sequentially (with the sequential errors) */
+    if(IS_ERROR_CODE(return_value)) {
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem assembling parts"
+        );
+    }
+
+    /* sets the parsing as parallel and
+    returns with no error */
+    *parallel = TRUE;
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE parse_unit(struct mingus_parser_t *parser, char *file_path, size_t jobs) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* flag set in case the input was parsed in parallel */
+    char parallel;
+
+    /* allocates space for the file structure to
+    hold the reference to be assembled */
+    FILE *file;
+
+    /* in case more than one job is requested tries to parse the
+    input in parallel parts, in case that fails (eg: a part ending
+    inside a string) the parser is reset and the input is parsed
+    sequentially */
+    parallel = FALSE;
+    if(jobs > 1) {
+        return_value = parse_parallel(parser, file_path, jobs, &parallel);
+        if(IS_ERROR_CODE(return_value)) {
+            release_parser(parser);
+            init_parser(parser);
+        }
+    }
+
+    if(!parallel) {
+        /* tries to open the asm file to be assembled in binary
+        mode (required for parsing) and in case there's an issue
+        with the opening raises an error */
+        FOPEN(&file, file_path, "rb");
+        if(file == NULL) {
+            RAISE_ERROR_F(
+                RUNTIME_EXCEPTION_ERROR_CODE,
+                (unsigned char *) "Problem opening file %s",
+                file_path
+            );
+        }
+
+        /* parses the complete file (the range is unbounded) */
+        return_value = parse_range(parser, file, file_path, (size_t) -1, TRUE);
+        fclose(file);
+        if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+    }
+
+    /* closes the last data element (in case the file ends
+    in the data section) setting its final size */
+    return_value = close_element(parser);
+    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+
+    /* resolves the absolute target of every branch instruction to
+    a label of the unit, the remaining ones are its relocations */
+    return_value = resolve_targets(parser);
+    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+
+    /* raises no error */
+    RAISE_NO_ERROR;
+}
+
+unsigned long long hash_word(unsigned long long hash, unsigned long long word) {
+    /* mixes the word into the hash (multiply and rotate,
+    as the block step of the murmur family of hashes) */
+    hash ^= word * 0x87c37b91114253d5ULL;
+    hash = (hash << 31) | (hash >> 33);
+    return hash * 0x4cf5ad432745937fULL;
+}
+
+ERROR_CODE hash_file(char *file_path, unsigned long long *hash, unsigned long long *size) {
+    size_t index;
+    size_t count;
+    unsigned long long word;
+    unsigned long long value;
+    char *buffer;
+    FILE *file;
+
+    /* opens the source file in binary mode, the same
+    error as when assembling in case it can't be opened */
+    FOPEN(&file, file_path, "rb");
+    if(file == NULL) {
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem opening file %s",
+            file_path
+        );
+    }
+
+    /* hashes the file in chunks, eight bytes at a time with the
+    remaining bytes of the (last) chunk mixed one at a time, the
+    version of the unit files is part of the hash so that a new
+    version never loads the units of a previous one */
+    buffer = (char *) MALLOC(MINGUS_CHUNK_SIZE);
+    value = MINGUS_UNIT_VERSION;
+    *size = 0;
+    while((count = fread(buffer, 1, MINGUS_CHUNK_SIZE, file)) > 0) {
+        for(index = 0; index + 8 <= count; index += 8) {
+            memcpy(&word, buffer + index, 8);
+            value = hash_word(value, word);
+        }
+        for(; index < count; index++) { value = hash_word(value, (unsigned char) buffer[index]); }
+        *size += count;
+    }
+    FREE(buffer);
+    if(ferror(file)) {
+        fclose(file);
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem reading file %s",
+            file_path
+        );
+    }
+    fclose(file);
+
+    /* mixes the size into the hash and avalanches it (so
+    that every bit of the input affects every bit of it) */
+    value ^= *size;
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    *hash = value;
+
+    /* raises no error */
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE save_unit(
+    struct mingus_parser_t *parser,
+    char *unit_path,
+    unsigned long long hash,
+    unsigned long long size
+) {
+    size_t index;
+    char *temporary_path;
+    struct unit_header_t header;
+    struct unit_instruction_t instruction;
+    struct unit_data_t data;
+    struct unit_symbol_t symbol;
+    FILE *file;
+
+    /* populates the header of the unit file computing its layout,
+    every section starts at an aligned offset (as in the object
+    file) with the code, data, values, names, symbols, relocations
+    and the strings of the symbols and relocations, in this order */
+    memset(&header, 0, sizeof(struct unit_header_t));
+    memcpy(header.magic, "MINU", 4);
+    header.version = MINGUS_UNIT_VERSION;
+    header.hash = hash;
+    header.size = size;
+    header.code_count = (unsigned int) parser->instruction_count;
+    header.data_count = (unsigned int) parser->data_element_count;
+    header.value_size = (unsigned int) parser->values.size;
+    header.name_size = (unsigned int) parser->names.size;
+    header.symbol_count = (unsigned int) parser->definition_count;
+    header.relocation_count = (unsigned int) parser->fixup_count;
+    header.string_size = (unsigned int) parser->references.size;
+    header.code_offset = MINGUS_ALIGN(sizeof(struct unit_header_t));
+    header.data_offset = MINGUS_ALIGN(header.code_offset + header.code_count * sizeof(struct unit_instruction_t));
+    header.value_offset = MINGUS_ALIGN(header.data_offset + header.data_count * sizeof(struct unit_data_t));
+    header.name_offset = MINGUS_ALIGN(header.value_offset + header.value_size);
+    header.symbol_offset = MINGUS_ALIGN(header.name_offset + header.name_size);
+    header.relocation_offset = MINGUS_ALIGN(header.symbol_offset + header.symbol_count * sizeof(struct unit_symbol_t));
+    header.string_offset = MINGUS_ALIGN(header.relocation_offset + header.relocation_count * sizeof(struct unit_symbol_t));
+
+    /* opens the (temporary) unit file, unique to the process (the
+    cache is shared by concurrent builds) and renamed into place once
+    complete so that a concurrent build never reads a partial unit */
+    temporary_path = (char *) MALLOC(strlen(unit_path) + 32);
+    SPRINTF(temporary_path, strlen(unit_path) + 32, "%s.%lu.tmp", unit_path, (unsigned long) getpid());
+    FOPEN(&file, temporary_path, "wb");
+    if(file == NULL) {
+        FREE(temporary_path);
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem opening unit file %s",
+            unit_path
+        );
+    }
+
+    /* outputs the header followed by the instructions (with the
+    targets of the branches) and the data elements of the unit */
+    put_buffer((char *) &header, sizeof(struct unit_header_t), file);
+    put_padding(sizeof(struct unit_header_t), file);
+    for(index = 0; index < parser->instruction_count; index++) {
+        instruction.opcode = (unsigned char) parser->instructions[index].opcode;
+        instruction.arg1 = (unsigned char) parser->instructions[index].arg1;
+        instruction.arg2 = (unsigned char) parser->instructions[index].arg2;
+        instruction.arg3 = (unsigned char) parser->instructions[index].arg3;
+        instruction.immediate = parser->instructions[index].immediate;
+        instruction.target = (unsigned int) parser->targets[index];
+        put_buffer((char *) &instruction, sizeof(struct unit_instruction_t), file);
+    }
+    put_padding(header.code_offset + header.code_count * sizeof(struct unit_instruction_t), file);
+    for(index = 0; index < parser->data_element_count; index++) {
+        data.type = (unsigned int) parser->data_elements[index].type;
+        data.offset = parser->data_elements[index].offset;
+        data.size = parser->data_elements[index].size;
+        data.name = parser->data_elements[index].name;
+        put_buffer((char *) &data, sizeof(struct unit_data_t), file);
+    }
+    put_padding(header.data_offset + header.data_count * sizeof(struct unit_data_t), file);
+
+    /* outputs the values and names of the data elements and the
+    symbol table and relocations with the strings of their names */
+    put_buffer(parser->values.pointer, parser->values.size, file);
+    put_padding(header.value_offset + header.value_size, file);
+    put_buffer(parser->names.pointer, parser->names.size, file);
+    put_padding(header.name_offset + header.name_size, file);
+    for(index = 0; index < parser->definition_count; index++) {
+        symbol.name = (unsigned int) parser->definitions[index].name;
+        symbol.instruction = (unsigned int) parser->definitions[index].instruction;
+        put_buffer((char *) &symbol, sizeof(struct unit_symbol_t), file);
+    }
+    put_padding(header.symbol_offset + header.symbol_count * sizeof(struct unit_symbol_t), file);
+    for(index = 0; index < parser->fixup_count; index++) {
+        symbol.name = (unsigned int) parser->fixups[index].name;
+        symbol.instruction = (unsigned int) parser->fixups[index].instruction;
+        put_buffer((char *) &symbol, sizeof(struct unit_symbol_t), file);
+    }
+    put_padding(header.relocation_offset + header.relocation_count * sizeof(struct unit_symbol_t), file);
+    put_buffer(parser->references.pointer, parser->references.size, file);
+
+    /* closes the unit file and moves it into its path
+    (replacing a previous one) */
+    fclose(file);
+#ifdef _WIN32
+    remove(unit_path);
+#endif
+    if(rename(temporary_path, unit_path) != 0) {
+        FREE(temporary_path);
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem writing unit file %s",
+            unit_path
+        );
+    }
+    FREE(temporary_path);
+
+    /* raises no error */
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE load_unit(
+    struct mingus_parser_t *parser,
+    char *unit_path,
+    unsigned long long *hash,
+    unsigned long long *size
+) {
+    size_t index;
+    size_t length;
+    char valid;
+    char *buffer;
+    char *name;
+    struct unit_header_t *header;
+    struct unit_instruction_t *instructions;
+    struct unit_data_t *data;
+    struct unit_symbol_t *symbols;
+    struct unit_symbol_t *relocations;
+    FILE *file;
+
+    /* reads the complete unit file into memory, in case there's
+    no unit file for the source (not in the cache) raises an error */
+    FOPEN(&file, unit_path, "rb");
+    if(file == NULL) {
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "No unit file %s",
+            unit_path
+        );
+    }
+    fseek(file, 0, SEEK_END);
+    length = (size_t) ftell(file);
+    fseek(file, 0, SEEK_SET);
+    buffer = (char *) MALLOC(length + 1);
+    valid = fread(buffer, 1, length, file) == length;
+    fclose(file);
+
+    /* verifies that the unit file was assembled from the same source
+    (hash and size, unless any source is accepted as for an object)
+    by the same version and that all of its sections, symbols and
+    relocations are inside of the file */
+    header = (struct unit_header_t *) buffer;
+    valid = valid && length >= sizeof(struct unit_header_t) &&
+        memcmp(header->magic, "MINU", 4) == 0 &&
+        header->version == MINGUS_UNIT_VERSION &&
+        (hash == NULL || (header->hash == *hash && header->size == *size)) &&
+        MINGUS_UNIT_VALID(header->code_offset, (size_t) header->code_count * sizeof(struct unit_instruction_t), length) &&
+        MINGUS_UNIT_VALID(header->data_offset, (size_t) header->data_count * sizeof(struct unit_data_t), length) &&
+        MINGUS_UNIT_VALID(header->value_offset, header->value_size, length) &&
+        MINGUS_UNIT_VALID(header->name_offset, header->name_size, length) &&
+        MINGUS_UNIT_VALID(header->symbol_offset, (size_t) header->symbol_count * sizeof(struct unit_symbol_t), length) &&
+        MINGUS_UNIT_VALID(header->relocation_offset, (size_t) header->relocation_count * sizeof(struct unit_symbol_t), length) &&
+        MINGUS_UNIT_VALID(header->string_offset, header->string_size, length) &&
+        (header->string_size == 0 || buffer[header->string_offset + header->string_size - 1] == '\0');
+    if(valid) {
+        symbols = (struct unit_symbol_t *) (buffer + header->symbol_offset);
+        relocations = (struct unit_symbol_t *) (buffer + header->relocation_offset);
+        for(index = 0; index < header->symbol_count && valid; index++) {
+            valid = symbols[index].name < header->string_size && symbols[index].instruction <= header->code_count;
+        }
+        for(index = 0; index < header->relocation_count && valid; index++) {
+            valid = relocations[index].name < header->string_size && relocations[index].instruction < header->code_count;
+        }
+    }
+    if(!valid) {
+        FREE(buffer);
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Invalid unit file %s",
+            unit_path
+        );
+    }
+
+    /* populates the parser with the instructions (and targets)
+    and the data elements, values and names of the unit */
+    instructions = (struct unit_instruction_t *) (buffer + header->code_offset);
+    data = (struct unit_data_t *) (buffer + header->data_offset);
+    parser->instruction_count = header->code_count;
+    parser->instruction_capacity = header->code_count;
+    if(header->code_count > 0) {
+        parser->instructions = (struct instructionf_t *) MALLOC(header->code_count * sizeof(struct instructionf_t));
+        parser->targets = (size_t *) MALLOC(header->code_count * sizeof(size_t));
+    }
+    for(index = 0; index < header->code_count; index++) {
+        parser->instructions[index].opcode = (enum opcodes_e) instructions[index].opcode;
+        parser->instructions[index].arg1 = (char) instructions[index].arg1;
+        parser->instructions[index].arg2 = (char) instructions[index].arg2;
+        parser->instructions[index].arg3 = (char) instructions[index].arg3;
+        parser->instructions[index].immediate = instructions[index].immediate;
+        parser->targets[index] = instructions[index].target;
+    }
+    parser->data_element_count = header->data_count;
+    parser->data_element_capacity = header->data_count;
+    if(header->data_count > 0) {
+        parser->data_elements = (struct data_elementf_t *) MALLOC(header->data_count * sizeof(struct data_elementf_t));
+    }
+    for(index = 0; index < header->data_count; index++) {
+        parser->data_elements[index].type = (enum data_types_e) data[index].type;
+        parser->data_elements[index].offset = data[index].offset;
+        parser->data_elements[index].size = data[index].size;
+        parser->data_elements[index].name = data[index].name;
+    }
+    append_section(&parser->values, buffer + header->value_offset, header->value_size);
+    append_section(&parser->names, buffer + header->name_offset, header->name_size);
+
+    /* populates the symbol table (the labels) and the relocations
+    of the unit, the names are kept in the references */
+    append_section(&parser->references, buffer + header->string_offset, header->string_size);
+    parser->definition_count = header->symbol_count;
+    parser->definition_capacity = header->symbol_count;
+    if(header->symbol_count > 0) {
+        parser->definitions = (struct fixup_t *) MALLOC(header->symbol_count * sizeof(struct fixup_t));
+    }
+    for(index = 0; index < header->symbol_count; index++) {
+        parser->definitions[index].name = symbols[index].name;
+        parser->definitions[index].instruction = symbols[index].instruction;
+        name = parser->references.pointer + symbols[index].name;
+        set_value_string_hash_map(parser->labels, (unsigned char *) name, (void *) ((size_t) symbols[index].instruction + 1));
+    }
+    parser->fixup_count = header->relocation_count;
+    parser->fixup_capacity = header->relocation_count;
+    if(header->relocation_count > 0) {
+        parser->fixups = (struct fixup_t *) MALLOC(header->relocation_count * sizeof(struct fixup_t));
+    }
+    for(index = 0; index < header->relocation_count; index++) {
+        parser->fixups[index].name = relocations[index].name;
+        parser->fixups[index].instruction = relocations[index].instruction;
+    }
+
+    /* releases the contents of the unit file
+    and returns with no error */
+    FREE(buffer);
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE assemble_unit(
+    struct mingus_parser_t *parser,
+    char *file_path,
+    size_t jobs,
+    char *cache_path,
+    char *cached
+) {
     /* allocates the value to be used to verify the
     existence of error from the function */
     ERROR_CODE return_value;
 
-    /* allocates space for the byte to be used
-    durring the parsing of the file */
-    char byte;
+    unsigned long long hash;
+    unsigned long long size;
+    size_t length;
+    char *unit_path;
+
+    /* initializes the parser of the unit and in case there's
+    no cache the unit is parsed directly from its source */
+    init_parser(parser);
+    *cached = FALSE;
+    if(cache_path == NULL) {
+        return_value = parse_unit(parser, file_path, jobs);
+        if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+        RAISE_NO_ERROR;
+    }
 
-    char is_final;
+    /* identifies the unit by the hash of its source and loads
+    its unit file from the cache (the source is not parsed) */
+    return_value = hash_file(file_path, &hash, &size);
+    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+    length = strlen(cache_path) + 22;
+    unit_path = (char *) MALLOC(length);
+    SPRINTF(unit_path, length, "%s/%016llx.miu", cache_path, hash);
+    return_value = load_unit(parser, unit_path, &hash, &size);
+    if(!IS_ERROR_CODE(return_value)) {
+        V_DEBUG_F("unit '%s' loaded from '%s'\n", file_path, unit_path);
+        FREE(unit_path);
+        *cached = TRUE;
+        RAISE_NO_ERROR;
+    }
 
-    size_t index;
-    size_t file_size;
+    /* otherwise (a new or changed source) the unit is parsed
+    and its unit file is stored in the cache */
+    return_value = parse_unit(parser, file_path, jobs);
+    if(IS_ERROR_CODE(return_value)) {
+        FREE(unit_path);
+        RAISE_AGAIN(return_value);
+    }
+    MINGUS_MKDIR(cache_path);
+    return_value = save_unit(parser, unit_path, hash, size);
+    FREE(unit_path);
+    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
 
-    char *buffer;
-    char *pointer;
-    char *token_end_mark;
-    char *comment_end_mark;
-    char *string_end_mark;
+    /* raises no error */
+    RAISE_NO_ERROR;
+}
 
+ERROR_CODE link_units(struct mingus_parser_t *units, size_t count) {
+    size_t index;
+    size_t position;
+    size_t base;
+    size_t total;
+    size_t elements;
+    size_t values;
+    size_t names;
     size_t address;
+    size_t value;
+    char *name;
+    struct mingus_parser_t *program = &units[0];
+    struct mingus_parser_t *unit;
+    struct fixup_t *fixup;
     struct instructionf_t *instruction;
+    struct data_elementf_t *element;
+    struct hash_map_t *ambiguous;
+
+    /* merges the symbol tables of the other units into the labels of
+    the first one (the program) rebased to the start of each unit, a
+    label defined by more than one unit is ambiguous (only an error in
+    case it's referenced by a unit that does not define it) */
+    create_hash_map(&ambiguous, 0);
+    for(index = 1, total = program->instruction_count; index < count; index++) {
+        unit = &units[index];
+        for(position = 0; position < unit->definition_count; position++) {
+            fixup = &unit->definitions[position];
+            name = unit->references.pointer + fixup->name;
+            if(get_label(program, name, &address)) {
+                set_value_string_hash_map(ambiguous, (unsigned char *) name, (void *) 1);
+                continue;
+            }
+            set_value_string_hash_map(program->labels, (unsigned char *) name, (void *) (total + fixup->instruction + 1));
+        }
+        total += unit->instruction_count;
+    }
 
-    struct code_t code;
+    /* grows the instructions of the program to hold the
+    instructions of all of the units */
+    if(total > program->instruction_capacity) {
+        program->instruction_capacity = total;
+        program->instructions = (struct instructionf_t *) REALLOC(
+            program->instructions,
+            program->instruction_capacity * sizeof(struct instructionf_t)
+        );
+        program->targets = (size_t *) REALLOC(
+            program->targets,
+            program->instruction_capacity * sizeof(size_t)
+        );
+    }
 
-    /* creates the parser structure, considered to be
-    the major one for the creation of the output code */
-    struct mingus_parser_t parser;
+    /* iterates over the units appending them (in order) to the
+    program, the first unit is the program itself (in place) */
+    for(index = 0, base = 0; index < count; index++) {
+        unit = &units[index];
+        if(index > 0) {
+            /* appends the values of the unit (aligned so that the
+            values keep the alignment of their types) and the names
+            and data elements of the unit, rebased */
+            append_section(&program->values, NULL, MINGUS_ALIGN(program->values.size) - program->values.size);
+            values = program->values.size;
+            names = program->names.size;
+            elements = program->data_element_count;
+            append_section(&program->values, unit->values.pointer, unit->values.size);
+            append_section(&program->names, unit->names.pointer, unit->names.size);
+            if(unit->data_element_count > 0) {
+                program->data_element_capacity = elements + unit->data_element_count;
+                program->data_elements = (struct data_elementf_t *) REALLOC(
+                    program->data_elements,
+                    program->data_element_capacity * sizeof(struct data_elementf_t)
+                );
+            }
+            for(position = 0; position < unit->data_element_count; position++) {
+                element = &program->data_elements[elements + position];
+                *element = unit->data_elements[position];
+                element->offset += (unsigned int) values;
+                element->name += (unsigned int) names;
+            }
+            program->data_element_count = elements + unit->data_element_count;
+
+            /* copies the instructions of the unit rebasing the targets
+            of its branches (unit relative) and its data elements */
+            for(position = 0; position < unit->instruction_count; position++) {
+                instruction = &program->instructions[base + position];
+                *instruction = unit->instructions[position];
+                program->targets[base + position] = unit->targets[position];
+                if(is_branch(instruction->opcode)) { program->targets[base + position] += base; }
+                if(instruction->opcode == LOAD || instruction->opcode == RLOAD) {
+                    instruction->immediate += (int) elements;
+                }
+            }
+        }
 
-    /* allocates space for the file structure to
-    hold the reference to be assembled */
-    FILE *file;
+        /* resolves the relocations of the unit (its references to
+        labels of other units) with the labels of all of the units */
+        for(position = 0; position < unit->fixup_count; position++) {
+            fixup = &unit->fixups[position];
+            name = unit->references.pointer + fixup->name;
+            get_value_string_hash_map(ambiguous, (unsigned char *) name, (void **) &value);
+            if(value != (size_t) NULL) {
+                delete_hash_map(ambiguous);
+                RAISE_ERROR_F(
+                    RUNTIME_EXCEPTION_ERROR_CODE,
+                    (unsigned char *) "Ambiguous label %s",
+                    name
+                );
+            }
+            if(!get_label(program, name, &address)) {
+                delete_hash_map(ambiguous);
+                RAISE_ERROR_F(
+                    RUNTIME_EXCEPTION_ERROR_CODE,
+                    (unsigned char *) "Undefined label %s",
+                    name
+                );
+            }
+            program->targets[base + fixup->instruction] = address;
+        }
+        base += index == 0 ? program->instruction_count : unit->instruction_count;
+    }
+    program->instruction_count = total;
+    program->fixup_count = 0;
+    delete_hash_map(ambiguous);
 
-    /* allocates space for the file that is going
-    to be used as the output of the bytecode */
-    FILE *out;
+    /* raises no error */
+    RAISE_NO_ERROR;
+}
 
-    /* in case the provided file path is not valid raises
-    and error indicating the problem */
-    if(file_path == NULL) {
-        RAISE_ERROR_M(
-            RUNTIME_EXCEPTION_ERROR_CODE,
-            (unsigned char *) "No input file"
-        );
-    }
+size_t is_terminal(enum opcodes_e opcode) {
+    switch(opcode) {
+        case HALT:
+        case JMP:
+        case JMP_ABS:
+        case RET:
+            return TRUE;
 
-    /* counts the number of bytes in the asm file
-    and then opens the asm file to be assembled in
-    binary mode (required for parsing) */
-    return_value = count_file(file_path, &file_size);
-    if(IS_ERROR_CODE(return_value)) {
-        RAISE_ERROR_F(
-            RUNTIME_EXCEPTION_ERROR_CODE,
-            (unsigned char *) "Problem counting file %s",
-            file_path
-        );
+        default:
+            return FALSE;
     }
+}
 
-    /* tries to read the file contents and in case there's
-    an issue with the reading raises an error */
-    FOPEN(&file, file_path, "rb");
+int compare_heat(const void *first, const void *second) {
+    /* orders the functions by decreasing heat, the ones with
+    the same heat keep their order (by rank) */
+    struct heat_t *first_heat = (struct heat_t *) first;
+    struct heat_t *second_heat = (struct heat_t *) second;
+    if(first_heat->heat != second_heat->heat) { return first_heat->heat > second_heat->heat ? -1 : 1; }
+    if(first_heat->rank != second_heat->rank) { return first_heat->rank < second_heat->rank ? -1 : 1; }
+    return 0;
+}
+
+ERROR_CODE read_profile(
+    char *profile_path,
+    size_t *located,
+    size_t count,
+    unsigned long long *heats
+) {
+    size_t length;
+    size_t address;
+    char *buffer;
+    char *line;
+    char *end;
+    char *leaf;
+    char *weight;
+    FILE *file;
+
+    /* reads the complete folded stacks file into memory (null
+    terminated) so that its lines are parsed in place */
+    FOPEN(&file, profile_path, "rb");
     if(file == NULL) {
         RAISE_ERROR_F(
             RUNTIME_EXCEPTION_ERROR_CODE,
-            (unsigned char *) "Problem opening file %s",
-            file_path
+            (unsigned char *) "Problem opening profile file %s",
+            profile_path
         );
     }
+    fseek(file, 0, SEEK_END);
+    length = (size_t) ftell(file);
+    fseek(file, 0, SEEK_SET);
+    buffer = (char *) MALLOC(length + 1);
+    length = fread(buffer, 1, length, file);
+    buffer[length] = '\0';
+    fclose(file);
 
-    /* tries to open the output file in writing mode,
-    this is the file to old the assembled code and in
-    case there's an issue with the opening raises an error*/
-    FOPEN(&out, output_path, "wb");
-    if(out == NULL) {
-        RAISE_ERROR_F(
-            RUNTIME_EXCEPTION_ERROR_CODE,
-            (unsigned char *) "Problem opening output file %s",
-            file_path
-        );
+    /* iterates over the lines of the file (eg: main;#00000006 1182),
+    the weight of each stack is added to the heat of the function of
+    its leaf frame (the exclusive time of the function), the frames
+    outside of the code or of unknown format are ignored */
+    for(line = buffer; *line != '\0'; line = end) {
+        end = strchr(line, '\n');
+        if(end == NULL) { end = line + strlen(line); }
+        else { *end++ = '\0'; }
+        weight = strrchr(line, ' ');
+        if(weight == NULL) { continue; }
+        *weight++ = '\0';
+        leaf = strrchr(line, ';');
+        leaf = leaf == NULL ? line : leaf + 1;
+        if(strcmp(leaf, "main") == 0) { address = 0; }
+        else if(leaf[0] == '#') { address = (size_t) strtoul(leaf + 1, NULL, 16); }
+        else { continue; }
+        if(address >= count) { continue; }
+        heats[located[address]] += strtoull(weight, NULL, 10);
     }
 
-    /* allocates the required size to read the complete file
-    and then reads it completely */
-    buffer = (char *) MALLOC(file_size);
-    fread(buffer, 1, file_size, file);
-
-    /* sets the initial pointer position to the position of
-    the begining of the buffer */
-    pointer = buffer;
-
-    /* updates the parser structure setting the appropriate
-    output file (buffer) and the initial opcode value */
-    parser.state = NORMAL;
-    parser.section = TEXT;
-    parser.output = out;
-    parser.instruction = NULL;
-    parser.instruction_count = 0;
-    parser.data_element = NULL;
-    parser.data_element_count = 0;
+    /* releases the contents of the file
+    and returns with no error */
+    FREE(buffer);
+    RAISE_NO_ERROR;
+}
 
-    /* creates the hash map to hold the various labels */
-    create_hash_map(&parser.labels, 0);
+ERROR_CODE layout_program(
+    struct mingus_parser_t *parser,
+    char keep,
+    char *profile_path,
+    size_t *stripped,
+    size_t *hot
+) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
 
-    create_hash_map(&parser.elements, 0);
+    size_t index;
+    size_t position;
+    size_t range;
+    size_t chain;
+    size_t target;
+    size_t count;
+    size_t range_count;
+    size_t chain_count;
+    size_t order_count;
+    size_t stack_count;
+    size_t placed_count;
+    size_t previous;
+    size_t *starts;
+    size_t *owners;
+    size_t *chains;
+    size_t *begins;
+    size_t *ends;
+    size_t *cursors;
+    size_t *orders;
+    size_t *stack;
+    size_t *moved;
+    size_t *targets;
+    char *live;
+    char *placed;
+    unsigned long long *heats;
+    struct heat_t *sorted;
+    struct instructionf_t *instructions;
+
+    /* splits the code into ranges (basic blocks) starting at the
+    entry, at the target of every branch and after every instruction
+    with no fall through (the end of every function) */
+    count = parser->instruction_count;
+    live = (char *) MALLOC(count + 1);
+    memset(live, 0, count + 1);
+    live[0] = TRUE;
+    for(index = 0; index < count; index++) {
+        if(is_terminal(parser->instructions[index].opcode)) { live[index + 1] = TRUE; }
+        if(!is_branch(parser->instructions[index].opcode)) { continue; }
+        if(parser->targets[index] >= count) {
+            FREE(live);
+            RAISE_ERROR_F(
+                RUNTIME_EXCEPTION_ERROR_CODE,
+                (unsigned char *) "Invalid branch target at #%08x",
+                (unsigned int) index
+            );
+        }
+        live[parser->targets[index]] = TRUE;
+    }
+    starts = (size_t *) MALLOC((count + 1) * sizeof(size_t));
+    owners = (size_t *) MALLOC(count * sizeof(size_t));
+    for(index = 0, range_count = 0; index < count; index++) {
+        if(live[index]) { starts[range_count++] = index; }
+        owners[index] = range_count - 1;
+    }
+    starts[range_count] = count;
+
+    /* marks the ranges reachable from the entry (the live ones),
+    following the branches (and calls) and the fall through of the
+    ranges, the remaining ones are never executed (dead code) */
+    memset(live, 0, range_count);
+    stack = (size_t *) MALLOC(range_count * sizeof(size_t));
+    stack[0] = 0;
+    stack_count = 1;
+    live[0] = TRUE;
+    while(stack_count > 0) {
+        range = stack[--stack_count];
+        for(index = starts[range]; index < starts[range + 1]; index++) {
+            if(!is_branch(parser->instructions[index].opcode)) { continue; }
+            target = owners[parser->targets[index]];
+            if(live[target]) { continue; }
+            live[target] = TRUE;
+            stack[stack_count++] = target;
+        }
+        if(is_terminal(parser->instructions[starts[range + 1] - 1].opcode)) { continue; }
+        if(range + 1 == range_count || live[range + 1]) { continue; }
+        live[range + 1] = TRUE;
+        stack[stack_count++] = range + 1;
+    }
 
-    /* unsets the is final variable as the first cycle is
-    never the final one */
-    is_final = FALSE;
+    /* groups the kept ranges (the live ones unless the dead code
+    is kept) into chains of ranges that fall through into the next
+    one, the chains are moved as a whole (the functions) */
+    chains = (size_t *) MALLOC(range_count * sizeof(size_t));
+    begins = (size_t *) MALLOC(range_count * sizeof(size_t));
+    ends = (size_t *) MALLOC(range_count * sizeof(size_t));
+    for(range = 0, chain_count = 0, previous = range_count; range < range_count; range++) {
+        if(!live[range] && !keep) { continue; }
+        if(previous + 1 != range || is_terminal(parser->instructions[starts[range] - 1].opcode)) {
+            begins[chain_count++] = starts[range];
+        }
+        chains[range] = chain_count - 1;
+        ends[chain_count - 1] = starts[range + 1];
+        previous = range;
+    }
 
-    /* iterates continuously over the file buffer to
-    parse the file and generate the output */
-    while(1) {
-        /* in case the is final flag as been set in the current iteration
-        breaks the current loop as the EOF character has been consumed */
-        if(is_final == TRUE) {
-            break;
+    /* orders the chains by a depth first traversal of the branches
+    from the entry, every function is placed right after the first
+    of its callers (in the order of the calls), the unreachable chains
+    (only in case they're kept) follow in their original order */
+    placed = (char *) MALLOC(chain_count);
+    memset(placed, 0, chain_count);
+    cursors = (size_t *) MALLOC(chain_count * sizeof(size_t));
+    orders = (size_t *) MALLOC(chain_count * sizeof(size_t));
+    orders[0] = 0;
+    order_count = 1;
+    placed[0] = TRUE;
+    cursors[0] = begins[0];
+    stack[0] = 0;
+    stack_count = 1;
+    while(stack_count > 0) {
+        chain = stack[stack_count - 1];
+        index = cursors[chain]++;
+        if(index == ends[chain]) {
+            stack_count--;
+            continue;
         }
+        if(!is_branch(parser->instructions[index].opcode)) { continue; }
+        target = chains[owners[parser->targets[index]]];
+        if(placed[target]) { continue; }
+        placed[target] = TRUE;
+        cursors[target] = begins[target];
+        orders[order_count++] = target;
+        stack[stack_count++] = target;
+    }
+    for(chain = 0; chain < chain_count; chain++) {
+        if(!placed[chain]) { orders[order_count++] = chain; }
+    }
 
-        /* checks if the pointer did not overflow the
-        current buffer iteration, in that case the is final
-        flag must be set for break in next cycle */
-        if(pointer == buffer + file_size) {
-            is_final = TRUE;
-        } else {
-            is_final = FALSE;
+    /* in case there's a profile (folded stacks of a run of the
+    program linked with no profile, the current order) places the
+    hot functions right after the entry by decreasing heat */
+    *hot = 0;
+    if(profile_path != NULL) {
+        moved = (size_t *) MALLOC(count * sizeof(size_t));
+        heats = (unsigned long long *) MALLOC(chain_count * sizeof(unsigned long long));
+        memset(heats, 0, chain_count * sizeof(unsigned long long));
+        for(index = 0, position = 0; index < order_count; index++) {
+            chain = orders[index];
+            for(target = begins[chain]; target < ends[chain]; target++) {
+                moved[position++] = chain;
+            }
+        }
+        return_value = read_profile(profile_path, moved, position, heats);
+        FREE(moved);
+        if(IS_ERROR_CODE(return_value)) {
+            FREE(heats); FREE(orders); FREE(cursors); FREE(placed);
+            FREE(ends); FREE(begins); FREE(chains); FREE(stack); FREE(owners);
+            FREE(starts); FREE(live);
+            RAISE_AGAIN(return_value);
+        }
+        sorted = (struct heat_t *) MALLOC(order_count * sizeof(struct heat_t));
+        for(index = 1, placed_count = 0; index < order_count; index++) {
+            if(heats[orders[index]] == 0) { continue; }
+            sorted[placed_count].heat = heats[orders[index]];
+            sorted[placed_count].rank = index;
+            sorted[placed_count].chain = orders[index];
+            placed_count++;
+        }
+        qsort(sorted, placed_count, sizeof(struct heat_t), compare_heat);
+        for(index = 1, position = 1 + placed_count; index < order_count; index++) {
+            if(heats[orders[index]] == 0) { stack[position++] = orders[index]; }
         }
+        for(index = 0; index < placed_count; index++) { stack[index + 1] = sorted[index].chain; }
+        memcpy(orders + 1, stack + 1, (order_count - 1) * sizeof(size_t));
+        *hot = placed_count;
+        FREE(sorted);
+        FREE(heats);
+    }
 
-        /* retrieves the proper byte value taking into account if this is
-        the final interation or not */
-        if(is_final == TRUE) {
-            byte = '\0';
-        } else {
-            byte = *pointer;
+    /* moves the instructions of the chains into their new positions
+    (the dead ones are dropped) and retargets all of the branches */
+    instructions = (struct instructionf_t *) MALLOC(count * sizeof(struct instructionf_t));
+    targets = (size_t *) MALLOC(count * sizeof(size_t));
+    moved = (size_t *) MALLOC(count * sizeof(size_t));
+    for(index = 0, position = 0; index < order_count; index++) {
+        chain = orders[index];
+        for(target = begins[chain]; target < ends[chain]; target++) {
+            instructions[position] = parser->instructions[target];
+            targets[position] = parser->targets[target];
+            moved[target] = position++;
         }
+    }
+    for(index = 0; index < position; index++) {
+        if(is_branch(instructions[index].opcode)) { targets[index] = moved[targets[index]]; }
+    }
+    FREE(parser->instructions);
+    FREE(parser->targets);
+    parser->instructions = instructions;
+    parser->targets = targets;
+    parser->instruction_count = position;
+    parser->instruction_capacity = count;
+    *stripped = count - position;
+
+    /* releases the structures of the layout
+    and returns with no error */
+    FREE(moved);
+    FREE(orders);
+    FREE(cursors);
+    FREE(placed);
+    FREE(ends);
+    FREE(begins);
+    FREE(chains);
+    FREE(stack);
+    FREE(owners);
+    FREE(starts);
+    FREE(live);
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE emit_program(
+    struct mingus_parser_t *parser,
+    char *output_path,
+    char registers,
+    char strip
+) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
 
-        /* switches over the current state of the parser
-        to operate accordingly over the current buffer */
-        switch(parser.state) {
-            case NORMAL:
-                switch(byte) {
-                    case ';':
-                        parser.state = COMMENT;
+    size_t index;
 
-                        MINGUS_MARK(comment_end);
+    struct instructionf_t *instruction;
 
-                        /* breaks the switch */
-                        break;
+    struct code_t code;
+    struct data_entry_t entry;
+    char *temporary_path;
 
-                    case '"':
-                        parser.state = STRING;
+    /* allocates space for the file that is going
+    to be used as the output of the bytecode */
+    FILE *out;
 
-                        MINGUS_MARK(string_end);
+    /* in case the register mode is requested translates the stack
+    based code into the equivalent register based code */
+    if(registers) {
+        return_value = translate_registers(parser);
+        if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+    }
 
-                        /* breaks the switch */
-                        break;
+    /* iterates over the complete set of instructions to run a series
+    of post-processing operations on all of them, this is especially
+    important for the JMP and CALL related operations */
+    for(index = 0; index < parser->instruction_count; index++) {
+        instruction = &parser->instructions[index];
+        if(!is_branch(instruction->opcode)) { continue; }
+        if(is_relative(instruction->opcode)) {
+            instruction->immediate = (int) parser->targets[index] - (int) (index + 1);
+        } else {
+            instruction->immediate = (int) parser->targets[index];
+        }
+    }
 
-                    case ' ':
-                    case '\r':
-                    case '\n':
-                    case '\0':
-                        /* breaks the switch */
-                        break;
+    /* computes the maximum stack depth of the program entry and
+    of each of the functions, so that the virtual machine only
+    verifies the bounds of the stacks once per call (before the
+    calls to far targets become pooled calls) */
+    return_value = compute_frames(parser);
+    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
 
-                    default:
-                        /* sets the current parsing state as
-                        token to be used in the parsing loop */
-                        parser.state = TOKEN;
+    /* moves the large immediate values (and far call targets)
+    into the constant pool and verifies the range of the
+    remaining ones */
+    return_value = encode_immediates(parser);
+    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
 
-                        /* marks the beggining of the token
-                        to be used latter in the callback */
-                        MINGUS_MARK(token_end);
+    /* copies the magic symbol to the beginning  of the code and
+    then sets a series of default values on the global header */
+    memset(&code.header, 0, sizeof(struct code_header_t));
+    memcpy(code.header.magic, "MING", 4);
+    code.header.version = MINGUS_CODE_VERSION;
+    code.header.data_count = parser->data_element_count;
+    code.header.code_count = parser->instruction_count;
+    code.header.data_size = parser->data_element_count * sizeof(struct data_entry_t);
+    code.header.code_size = parser->instruction_count * sizeof(int);
+    code.header.const_count = parser->constant_count;
+    code.header.const_size = parser->constant_count * sizeof(int);
+    code.header.frame_count = (unsigned int) parser->frame_count;
+    code.header.frame_size = (unsigned int) (parser->frame_count * sizeof(struct frame_entry_t));
+    code.header.value_size = (unsigned int) parser->values.size;
+    code.header.debug_size = strip ? 0 : (unsigned int) parser->names.size;
+
+    /* computes the layout of the file, every section starts at
+    an aligned offset so that it may be used directly from a
+    memory mapping of the file (header, data, constants, code,
+    frames, values and the optional debug names, in this order) */
+    code.header.data_offset = MINGUS_ALIGN(sizeof(struct code_header_t));
+    code.header.const_offset = MINGUS_ALIGN(code.header.data_offset + code.header.data_size);
+    code.header.code_offset = MINGUS_ALIGN(code.header.const_offset + code.header.const_size);
+    code.header.frame_offset = MINGUS_ALIGN(code.header.code_offset + code.header.code_size);
+    code.header.value_offset = MINGUS_ALIGN(code.header.frame_offset + code.header.frame_size);
+    code.header.debug_offset = MINGUS_ALIGN(code.header.value_offset + code.header.value_size);
+
+    /* tries to open the (temporary) output file in writing mode,
+    this is the file to hold the assembled code and in case
+    there's an issue with the opening raises an error, the file
+    is only renamed into the output path once complete so that
+    a running virtual machine never maps a truncated file */
+    temporary_path = (char *) MALLOC(strlen(output_path) + 5);
+    memcpy(temporary_path, output_path, strlen(output_path));
+    memcpy(temporary_path + strlen(output_path), ".tmp", 5);
+    FOPEN(&out, temporary_path, "wb");
+    if(out == NULL) {
+        FREE(temporary_path);
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem opening output file %s",
+            output_path
+        );
+    }
+    parser->output = out;
+
+    /* outputs the header structure directly to the parser output
+    buffer followed by the data entries and the constant pool */
+    put_buffer((char *) &code.header, sizeof(struct code_header_t), parser->output);
+    put_padding(sizeof(struct code_header_t), parser->output);
+    for(index = 0; index < parser->data_element_count; index++) {
+        entry.type = (unsigned int) parser->data_elements[index].type;
+        entry.offset = parser->data_elements[index].offset;
+        entry.size = parser->data_elements[index].size;
+        put_buffer((char *) &entry, sizeof(struct data_entry_t), parser->output);
+    }
+    put_padding(code.header.data_offset + code.header.data_size, parser->output);
+    put_buffer((char *) parser->constants, code.header.const_size, parser->output);
+    put_padding(code.header.const_offset + code.header.const_size, parser->output);
 
-                        /* breaks the switch */
-                        break;
-                }
+    /* iterates over the complete set of instructions to ouput the code
+    of it into the output buffer (directly from structure) */
+    for(index = 0; index < parser->instruction_count; index++) {
+        put_code(build_code(&parser->instructions[index]), parser->output);
+    }
+    put_padding(code.header.code_offset + code.header.code_size, parser->output);
+    put_buffer((char *) parser->frames, code.header.frame_size, parser->output);
+    put_padding(code.header.frame_offset + code.header.frame_size, parser->output);
+
+    /* outputs the value section with the packed values of the
+    data elements and the debug section with their names */
+    put_buffer(parser->values.pointer, parser->values.size, parser->output);
+    if(code.header.debug_size > 0) {
+        put_padding(code.header.value_offset + code.header.value_size, parser->output);
+        put_buffer(parser->names.pointer, parser->names.size, parser->output);
+    }
 
-                /* breaks the switch */
-                break;
+    /* prints a logging message indicating the results
+    of the assembling, for debugging purposes */
+    PRINTF_F("Processed %d data elements...\n", (int) parser->data_element_count);
+    PRINTF_F("Processed %d constants...\n", (int) parser->constant_count);
+    PRINTF_F("Processed %d instructions...\n", (int) parser->instruction_count);
 
-            case TOKEN:
-                switch(byte) {
-                    case ' ':
-                    case '\r':
-                    case '\n':
-                    case '\0':
-                        parser.state = NORMAL;
+    /* closes the output file (the input is closed once parsed)
+    as the output has been generated and moves it into the
+    final output path (replacing the previous one) */
+    fclose(out);
+#ifdef _WIN32
+    remove(output_path);
+#endif
+    if(rename(temporary_path, output_path) != 0) {
+        FREE(temporary_path);
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem writing output file %s",
+            output_path
+        );
+    }
+    FREE(temporary_path);
 
-                        MINGUS_CALLBACK_DATA(token_end);
+    /* retuns with no error (normal return) */
+    RAISE_NO_ERROR;
+}
 
-                        /* breaks the switch */
-                        break;
+#ifndef MINGUS_LINKER
+
+ERROR_CODE run(
+    char **file_paths,
+    size_t file_count,
+    char *output_path,
+    char registers,
+    char strip,
+    char object,
+    size_t jobs,
+    char *cache_path
+) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
 
-                    default:
-                        /* breaks the switch */
-                        break;
-                }
+    size_t index;
 
-                /* breaks the switch */
-                break;
+    /* flag set in case a unit was loaded from the
+    cache and the number of units loaded from it */
+    char cached;
+    size_t cached_count;
 
-            case COMMENT:
-                switch(byte) {
-                    case '\r':
-                    case '\n':
-                    case '\0':
-                        parser.state = NORMAL;
+    /* the hash and size of the source of an object */
+    unsigned long long hash;
+    unsigned long long size;
 
-                        MINGUS_CALLBACK_DATA(comment_end);
+    /* creates the parser structure, considered to be
+    the major one for the creation of the output code */
+    struct mingus_parser_t parser;
 
-                        /* breaks the switch */
-                        break;
+    /* allocates space for the (translation) units, one
+    per input file, linked into the program */
+    struct mingus_parser_t *units;
 
-                    default:
-                        /* breaks the switch */
-                        break;
-                }
+    /* in case the provided file paths are not valid raises
+    and error indicating the problem */
+    if(file_count == 0 || output_path == NULL) {
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "No input or output file"
+        );
+    }
 
-                /* breaks the switch */
-                break;
+    /* fills the perfect hash table of the mnemonics, used
+    to identify the instructions while parsing */
+    return_value = init_mnemonics();
+    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+
+    /* in case an object is requested the (single) input file is
+    assembled as a unit written to the output path, its symbols
+    (exports) and relocations (imports) resolved by the linker */
+    if(object) {
+        if(file_count > 1) {
+            RAISE_ERROR_M(
+                RUNTIME_EXCEPTION_ERROR_CODE,
+                (unsigned char *) "Multiple input files for an object"
+            );
+        }
+        return_value = assemble_unit(&parser, file_paths[0], jobs, cache_path, &cached);
+        if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+        return_value = hash_file(file_paths[0], &hash, &size);
+        if(!IS_ERROR_CODE(return_value)) { return_value = save_unit(&parser, output_path, hash, size); }
+        if(!IS_ERROR_CODE(return_value)) {
+            PRINTF_F("Processed %d instructions...\n", (int) parser.instruction_count);
+            PRINTF_F("Processed %d symbols...\n", (int) parser.definition_count);
+            PRINTF_F("Processed %d relocations...\n", (int) parser.fixup_count);
+        }
+        release_parser(&parser);
+        if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+        RAISE_NO_ERROR;
+    }
 
-            case STRING:
-                switch(byte) {
-                    case '"':
-                        parser.state = NORMAL;
+    /* assembles each of the input files as a translation unit
+    (loaded from the cache when its source is unchanged) and
+    links the units into the program, the first unit, whose
+    parser is the one of the program */
+    units = (struct mingus_parser_t *) MALLOC(file_count * sizeof(struct mingus_parser_t));
+    for(index = 0, cached_count = 0; index < file_count; index++) {
+        return_value = assemble_unit(&units[index], file_paths[index], jobs, cache_path, &cached);
+        if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+        if(cached) { cached_count++; }
+    }
+    return_value = link_units(units, file_count);
+    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+    parser = units[0];
+    for(index = 1; index < file_count; index++) { release_parser(&units[index]); }
+    FREE(units);
 
-                        MINGUS_CALLBACK_DATA(string_end);
+    /* adds the "final" halt instruction to the output so that
+    the virtual machine is always returned on the final stage */
+    add_instruction(&parser, HALT, _UNDEFINED, _UNDEFINED, _UNDEFINED, _UNDEFINED_IMMEDIATE);
+
+    /* generates the object file of the program and prints
+    the number of units (in case there's more than one) */
+    return_value = emit_program(&parser, output_path, registers, strip);
+    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+    if(file_count > 1 || cache_path != NULL) {
+        PRINTF_F("Processed %d units (%d cached)...\n", (int) file_count, (int) cached_count);
+    }
 
-                        /* breaks the switch */
-                        break;
+    /* releases the parser, to avoid any memory leaking */
+    release_parser(&parser);
 
-                    default:
-                        /* breaks the switch */
-                        break;
-                }
+    /* retuns with no error (normal return) */
+    RAISE_NO_ERROR;
+}
 
-                /* breaks the switch */
-                break;
-        }
+int main(int argc, const char *argv[]) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
 
+    /* allocates space for the paths of the input files
+    (the translation units) followed by the output path,
+    the last of the paths, and for the options */
+    char **paths = (char **) MALLOC(argc * sizeof(char *));
+    size_t count = 0;
+    char *cache_path = NULL;
+    char registers = FALSE;
+    char strip = FALSE;
+    char object = FALSE;
+    size_t jobs = 1;
+    int index;
+
+    /* iterates over the arguments, the options are identified
+    by the double dash prefix and the remaining ones are the
+    input paths and the output path (in this order) */
+    for(index = 1; index < argc; index++) {
+        if(strcmp(argv[index], "--registers") == 0) { registers = TRUE; }
+        else if(strcmp(argv[index], "--strip") == 0) { strip = TRUE; }
+        else if(strcmp(argv[index], "--object") == 0) { object = TRUE; }
+        else if(strcmp(argv[index], "--jobs") == 0 && index + 1 < argc) { jobs = (size_t) atol(argv[++index]); }
+        else if(strcmp(argv[index], "--cache") == 0 && index + 1 < argc) { cache_path = (char *) argv[++index]; }
+        else { paths[count++] = (char *) argv[index]; }
+    }
 
-        /* increments the current buffer pointer
-        iteration end operation */
-        pointer++;
+    /* runs the assembler and verifies if an error
+    as occurred, if that's the case prints it */
+    return_value = run(
+        paths,
+        count > 1 ? count - 1 : 0,
+        count > 1 ? paths[count - 1] : NULL,
+        registers,
+        strip,
+        object,
+        jobs,
+        cache_path
+    );
+    FREE(paths);
+    if(IS_ERROR_CODE(return_value)) {
+        V_ERROR_F("Fatal error (%s)\n", (char *) GET_ERROR());
+        RAISE_AGAIN(return_value);
     }
 
-    /* adds the "final" halt instruction to the output so that
-    the virtual machine is always returned on the final stage */
-    add_instruction(&parser, HALT, _UNDEFINED, _UNDEFINED, _UNDEFINED, _UNDEFINED);
+    /* returns with no error */
+    return 0;
+}
 
-    /* iterates over the complete set of instructions to run a series
-    of post-processing operations on all of them, this is especially
-    important for the JMP and CALL related operations */
-    for(index = 0; index < parser.instruction_count; index++) {
-        instruction = &parser.instructions[index];
-        switch(instruction->opcode) {
-            case JMP:
-            case JMP_EQ:
-            case JMP_NEQ:
-                get_value_string_hash_map(parser.labels, (unsigned char *) instruction->string, (void **) &address);
-                if(address != (size_t) NULL) {
-                    instruction->immediate = address - instruction->position;
-                    instruction->code |= (unsigned char) instruction->immediate;
-                }
-                break;
+#else
 
-            case JMP_ABS:
-            case CALL:
-                get_value_string_hash_map(parser.labels, (unsigned char *) instruction->string, (void **) &address);
-                if(address != (size_t) NULL) {
-                    instruction->immediate = address;
-                }
-                break;
+ERROR_CODE run(
+    char **file_paths,
+    size_t file_count,
+    char *output_path,
+    char registers,
+    char strip,
+    char keep,
+    char *profile_path
+) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
 
-            default:
-                break;
-        }
-    }
+    size_t index;
 
-    /* copies the magic symbol to the beginning  of the code and
-    then sets a series of default values on the global header */
-    memcpy(code.header.magic, "MING", 4);
-    code.header.version = MINGUS_CODE_VERSION;
-    code.header.data_count = parser.data_element_count;
-    code.header.code_count = parser.instruction_count;
-    code.header.data_size = parser.data_element_count * sizeof(struct data_elementf_t);
-    code.header.code_size = parser.instruction_count * sizeof(int);
+    /* the number of instructions removed as dead code and
+    the number of (hot) functions placed by the profile */
+    size_t stripped;
+    size_t hot;
+
+    /* creates the parser structure, considered to be
+    the major one for the creation of the output code */
+    struct mingus_parser_t parser;
 
-    /* retrieves the reference to the header structure and outputs it
-    directly to the parser output buffer */
-    put_buffer((char *) &code.header, sizeof(struct code_header_t), parser.output);
+    /* allocates space for the units, one per object
+    file, linked into the program */
+    struct mingus_parser_t *units;
 
-    /* iterates over the complete set of data elements to output their
-    respective elements to the output buffer */
-    for(index = 0; index < parser.data_element_count; index++) {
-        put_buffer(
-            (char *) &parser.data_elements[index],
-            sizeof(struct data_elementf_t),
-            parser.output
+    /* in case the provided file paths are not valid raises
+    and error indicating the problem */
+    if(file_count == 0 || output_path == NULL) {
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "No input or output file"
         );
     }
 
-    /* iterates over the complete set of instructions to ouput the code
-    of it into the output buffer (directly from structure) */
-    for(index = 0; index < parser.instruction_count; index++) {
-        /* sets the current instruction pointer in the
-        parser for correct execution */
-        instruction = &parser.instructions[index];
-        build_code(instruction);
-        put_code(instruction->code, parser.output);
+    /* loads each of the object files (units assembled with the
+    object flag) and links them into the program, the first of
+    them is the entry of the program */
+    units = (struct mingus_parser_t *) MALLOC(file_count * sizeof(struct mingus_parser_t));
+    for(index = 0; index < file_count; index++) {
+        init_parser(&units[index]);
+        return_value = load_unit(&units[index], file_paths[index], NULL, NULL);
+        if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
     }
-
-    /* prints a logging message indicating the results
-    of the assembling, for debugging purposes */
-    PRINTF_F("Processed %d data elements...\n", (int) parser.data_element_count);
-    PRINTF_F("Processed %d instructions...\n", (int) parser.instruction_count);
-
-    /* releases the buffer, to avoid any memory leaking */
-    FREE(buffer);
-
-    /* closes both the input and output files (all the parsing
-    has been done) the output has been generated */
-    fclose(out);
-    fclose(file);
+    return_value = link_units(units, file_count);
+    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+    parser = units[0];
+    for(index = 1; index < file_count; index++) { release_parser(&units[index]); }
+    FREE(units);
+
+    /* adds the "final" halt instruction (before the layout, so
+    that the code falling through the end of the program keeps
+    it), removes the dead code and lays out the functions */
+    add_instruction(&parser, HALT, _UNDEFINED, _UNDEFINED, _UNDEFINED, _UNDEFINED_IMMEDIATE);
+    return_value = layout_program(&parser, keep, profile_path, &stripped, &hot);
+    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+
+    /* generates the object file of the program and prints
+    the results of the linking */
+    return_value = emit_program(&parser, output_path, registers, strip);
+    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+    PRINTF_F("Linked %d units...\n", (int) file_count);
+    PRINTF_F("Stripped %d instructions...\n", (int) stripped);
+    if(profile_path != NULL) { PRINTF_F("Placed %d hot functions...\n", (int) hot); }
+
+    /* releases the parser, to avoid any memory leaking */
+    release_parser(&parser);
 
     /* retuns with no error (normal return) */
     RAISE_NO_ERROR;
@@ -788,18 +3911,40 @@ int main(int argc, const char *argv[]) {
     existence of error from the function */
     ERROR_CODE return_value;
 
-    /* allocates and starts the pointer to the path
-    of the file to be interpreted, checks if the number
-    of arguments is greater than one and in case it is
-    updates the file path with the second argument */
-    char *file_path = NULL;
-    char *output_path = NULL;
-    if(argc > 1) { file_path = (char *) argv[1]; }
-    if(argc > 2) { output_path = (char *) argv[2]; }
+    /* allocates space for the paths of the object files
+    followed by the output path, the last of the paths,
+    and for the options */
+    char **paths = (char **) MALLOC(argc * sizeof(char *));
+    size_t count = 0;
+    char *profile_path = NULL;
+    char registers = FALSE;
+    char strip = FALSE;
+    char keep = FALSE;
+    int index;
+
+    /* iterates over the arguments, the options are identified
+    by the double dash prefix and the remaining ones are the
+    object paths and the output path (in this order) */
+    for(index = 1; index < argc; index++) {
+        if(strcmp(argv[index], "--registers") == 0) { registers = TRUE; }
+        else if(strcmp(argv[index], "--strip") == 0) { strip = TRUE; }
+        else if(strcmp(argv[index], "--keep") == 0) { keep = TRUE; }
+        else if(strcmp(argv[index], "--profile") == 0 && index + 1 < argc) { profile_path = (char *) argv[++index]; }
+        else { paths[count++] = (char *) argv[index]; }
+    }
 
-    /* runs the virtual machine and verifies if an error
+    /* runs the linker and verifies if an error
     as occurred, if that's the case prints it */
-    return_value = run(file_path, output_path);
+    return_value = run(
+        paths,
+        count > 1 ? count - 1 : 0,
+        count > 1 ? paths[count - 1] : NULL,
+        registers,
+        strip,
+        keep,
+        profile_path
+    );
+    FREE(paths);
     if(IS_ERROR_CODE(return_value)) {
         V_ERROR_F("Fatal error (%s)\n", (char *) GET_ERROR());
         RAISE_AGAIN(return_value);
@@ -808,3 +3953,5 @@ int main(int argc, const char *argv[]) {
     /* returns with no error */
     return 0;
 }
+
+#endif
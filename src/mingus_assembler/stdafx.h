@@ -31,6 +31,20 @@
 
 #include <stdio.h>
 
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#else
+#include <direct.h>
+#include <process.h>
+#define getpid _getpid
+#endif
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
 #include <viriatum/viriatum.h>
 
 #include "../mingus/mingus.h"
@@ -0,0 +1,399 @@
+/*
+ Mingus Virtual Machine
+ Copyright (c) 2008-2020 Hive Solutions Lda.
+
+ This file is part of Mingus Virtual Machine.
+
+ Mingus Virtual Machine is free software: you can redistribute it and/or modify
+ it under the terms of the Apache License as published by the Apache
+ Foundation, either version 2.0 of the License, or (at your option) any
+ later version.
+
+ Mingus Virtual Machine is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ Apache License for more details.
+
+ You should have received a copy of the Apache License along with
+ Mingus Virtual Machine. If not, see <http://www.apache.org/licenses/>.
+
+ __author__    = João Magalhães <joamag@hive.pt>
+ __version__   = 1.0.0
+ __revision__  = $LastChangedRevision$
+ __date__      = $LastChangedDate$
+ __copyright__ = Copyright (c) 2008-2020 João Magalhães
+ __license__   = Apache License, Version 2.0
+*/
+
+#include "stdafx.h"
+
+#include "../mingus/cache.h"
+#include "../mingus/scheduler.h"
+
+/* starts the memory structures */
+START_MEMORY;
+
+/**
+ * The default number of scripts to be run for
+ * each of the thread counts in the benchmark.
+ */
+#define BENCH_SCRIPTS 100000
+
+/**
+ * Structure describing the work of a benchmark
+ * thread, the module to be run and the results.
+ */
+typedef struct bench_worker_t {
+    /**
+     * The buffer with the module (object file) to be
+     * loaded by each script, shared by all threads.
+     */
+    unsigned char *buffer;
+
+    /**
+     * The size in bytes of the module buffer.
+     */
+    size_t size;
+
+    /**
+     * The path to the module, used to retrieve it from
+     * the module cache (when in use).
+     */
+    char *path;
+
+    /**
+     * The shared module cache, in case it's unset each
+     * script loads (and decodes) the module buffer.
+     */
+    struct cache_t *cache;
+
+    /**
+     * The number of scripts to be run by the thread.
+     */
+    size_t scripts;
+
+    /**
+     * The number of scripts that failed (error or
+     * exhausted budget) in the thread.
+     */
+    size_t failures;
+
+#ifndef _WIN32
+    /**
+     * The identifier of the thread running the work.
+     */
+    pthread_t thread;
+#endif
+} bench_worker;
+
+double bench_time() {
+    struct timespec value;
+    clock_gettime(CLOCK_MONOTONIC, &value);
+    return (double) value.tv_sec + (double) value.tv_nsec / 1e9;
+}
+
+void *bench_thread(void *arguments) {
+    /* allocates space for the index of the script and
+    for the state that is going to run each of them */
+    size_t index;
+    ERROR_CODE return_value;
+    struct state_t *state;
+    struct module_t *module;
+    struct bench_worker_t *worker = (struct bench_worker_t *) arguments;
+
+    /* runs each script in a new state, from the creation of
+    the state until its deletion, so that the complete cost
+    of hosting a script is measured, the module is either
+    shared through the cache or loaded for each script */
+    for(index = 0; index < worker->scripts; index++) {
+        if(IS_ERROR_CODE(mingus_create(&state))) { worker->failures++; continue; }
+        if(worker->cache != NULL) {
+            return_value = mingus_cache_get(worker->cache, worker->path, &module);
+            if(!IS_ERROR_CODE(return_value)) {
+                return_value = mingus_attach(state, module);
+                mingus_module_release(module);
+            }
+        } else {
+            return_value = mingus_load_module(state, worker->buffer, worker->size, TRUE);
+        }
+        if(IS_ERROR_CODE(return_value) ||
+            IS_ERROR_CODE(mingus_execute(state, MINGUS_BUDGET_UNLIMITED)) ||
+            state->running == TRUE) {
+            worker->failures++;
+        }
+        mingus_delete(state);
+    }
+
+    return NULL;
+}
+
+#ifndef _WIN32
+
+ERROR_CODE bench_run(struct bench_worker_t *base, size_t threads, size_t scripts, double *rate) {
+    /* allocates space for the index of the thread, for the
+    number of failures and for the time of the run */
+    size_t index;
+    size_t failures = 0;
+    double start;
+    double elapsed;
+
+    /* allocates the workers, one per thread, and splits the
+    scripts among them (remainder goes to the first ones) */
+    struct bench_worker_t *workers = (struct bench_worker_t *) MALLOC(
+        threads * sizeof(struct bench_worker_t)
+    );
+    for(index = 0; index < threads; index++) {
+        workers[index] = *base;
+        workers[index].scripts = scripts / threads + (index < scripts % threads ? 1 : 0);
+        workers[index].failures = 0;
+    }
+
+    /* starts all the threads and waits for them to finish,
+    measuring the (wall clock) time of the complete run */
+    start = bench_time();
+    for(index = 0; index < threads; index++) {
+        pthread_create(&workers[index].thread, NULL, bench_thread, &workers[index]);
+    }
+    for(index = 0; index < threads; index++) {
+        pthread_join(workers[index].thread, NULL);
+        failures += workers[index].failures;
+    }
+    elapsed = bench_time() - start;
+    FREE(workers);
+
+    /* verifies that all of the scripts have run to completion,
+    as otherwise the measurement would not be valid */
+    if(failures > 0) {
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "%lu scripts failed",
+            (unsigned long) failures
+        );
+    }
+
+    /* calculates the rate of scripts per second */
+    *rate = (double) scripts / elapsed;
+    RAISE_NO_ERROR;
+}
+
+#else
+
+ERROR_CODE bench_run(struct bench_worker_t *base, size_t threads, size_t scripts, double *rate) {
+    RAISE_ERROR_M(
+        RUNTIME_EXCEPTION_ERROR_CODE,
+        (unsigned char *) "Threads benchmark not available"
+    );
+}
+
+#endif
+
+ERROR_CODE bench_multiplex(struct bench_worker_t *base, size_t scripts, double *rate, double *latency) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value = 0;
+
+    /* allocates space for the index of the script, for the
+    number of failures and for the time of the run */
+    size_t index;
+    size_t failures = 0;
+    double start;
+    double elapsed;
+
+    /* allocates space for the scheduler, the (possibly) failed
+    state of a run and for the module of the scripts */
+    struct scheduler_t *scheduler;
+    struct state_t *failed;
+    struct module_t *module;
+
+    /* allocates the array of states, one per script, that are
+    all going to be multiplexed in the same (current) thread */
+    struct state_t **states = (struct state_t **) MALLOC(scripts * sizeof(struct state_t *));
+    memset(states, 0, scripts * sizeof(struct state_t *));
+
+    /* creates the scheduler and a state per script with the module
+    attached (shared through the cache or loaded by each script) */
+    mingus_scheduler_create(&scheduler, MINGUS_SCHEDULER_SLICE);
+    for(index = 0; index < scripts; index++) {
+        return_value = mingus_create(&states[index]);
+        if(IS_ERROR_CODE(return_value)) { break; }
+        if(base->cache != NULL) {
+            return_value = mingus_cache_get(base->cache, base->path, &module);
+            if(!IS_ERROR_CODE(return_value)) {
+                return_value = mingus_attach(states[index], module);
+                mingus_module_release(module);
+                if(IS_ERROR_CODE(return_value)) { return_value = mingus_raise(states[index], return_value); }
+            }
+        } else {
+            return_value = mingus_load_module(states[index], base->buffer, base->size, TRUE);
+            if(IS_ERROR_CODE(return_value)) { return_value = mingus_raise(states[index], return_value); }
+        }
+        if(!IS_ERROR_CODE(return_value)) { return_value = mingus_scheduler_add(scheduler, states[index]); }
+        if(IS_ERROR_CODE(return_value)) { break; }
+    }
+
+    /* runs all the states in turns until all of them have halted,
+    resuming the run after a failed state (still running) */
+    start = bench_time();
+    while(!IS_ERROR_CODE(return_value) &&
+        IS_ERROR_CODE(mingus_scheduler_run(scheduler, 0, &failed))) {}
+    elapsed = bench_time() - start;
+    *latency = (double) scheduler->latency / 1e9;
+
+    /* releases the states (counting the ones that have not
+    run to completion) and the scheduler */
+    for(index = 0; index < scripts; index++) {
+        if(states[index] == NULL) { continue; }
+        if(states[index]->running == TRUE) { failures++; }
+        mingus_delete(states[index]);
+    }
+    FREE(states);
+    mingus_scheduler_delete(scheduler);
+    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+
+    /* verifies that all of the scripts have run to completion,
+    as otherwise the measurement would not be valid */
+    if(failures > 0) {
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "%lu scripts failed",
+            (unsigned long) failures
+        );
+    }
+
+    /* calculates the rate of scripts per second */
+    *rate = (double) scripts / elapsed;
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE run(char *file_path, size_t threads, size_t scripts, unsigned char cached, unsigned char multiplex) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* allocates space for the number of threads in the
+    current step and for the rates of scripts per second */
+    size_t count;
+    double rate;
+    double latency;
+    double reference = 0.0;
+
+    /* allocates space for the worker template, the values
+    shared by all the workers of the benchmark */
+    struct bench_worker_t base;
+
+    /* in case the provided file path is not valid raises
+    and error indicating the problem */
+    if(file_path == NULL) {
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "No input file"
+        );
+    }
+
+    /* populates the worker template, in the cached mode the
+    module is shared through the module cache, otherwise the
+    file is read once and decoded by each of the scripts */
+    base.buffer = NULL;
+    base.size = 0;
+    base.path = file_path;
+    base.cache = NULL;
+    base.scripts = 0;
+    base.failures = 0;
+    if(cached == TRUE) {
+        return_value = mingus_cache_create(&base.cache, TRUE);
+    } else {
+        return_value = read_file(file_path, &base.buffer, &base.size);
+    }
+    if(IS_ERROR_CODE(return_value)) {
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem reading file %s",
+            file_path
+        );
+    }
+
+    /* in case the multiplex mode is requested runs all the
+    scripts in the same thread (round robin scheduler), the
+    latency is the longest turn of a script */
+    if(multiplex == TRUE) {
+        return_value = bench_multiplex(&base, scripts, &rate, &latency);
+        if(!IS_ERROR_CODE(return_value)) {
+            PRINTF_F(
+                "%lu states %12.0f scripts/s %8.2f us max turn\n",
+                (unsigned long) scripts, rate, 1e6 * latency
+            );
+        }
+    } else {
+        /* runs the benchmark doubling the number of threads from
+        one up to the requested number (always included), the
+        latency is the time each script takes in its thread */
+        count = 1;
+        while(TRUE) {
+            return_value = bench_run(&base, count, scripts, &rate);
+            if(IS_ERROR_CODE(return_value)) { break; }
+            if(count == 1) { reference = rate; }
+            PRINTF_F(
+                "%3lu threads %12.0f scripts/s %6.2fx %8.2f us/script\n",
+                (unsigned long) count, rate, rate / reference, 1e6 * (double) count / rate
+            );
+            if(count == threads) { break; }
+            count = count * 2 > threads ? threads : count * 2;
+        }
+    }
+
+    /* releases the module cache or buffer and returns
+    with the result of the benchmark */
+    if(base.cache != NULL) { mingus_cache_delete(base.cache); }
+    if(base.buffer != NULL) { FREE(base.buffer); }
+    if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+    RAISE_NO_ERROR;
+}
+
+int main(int argc, const char *argv[]) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* allocates space for the index of the argument being
+    parsed and for the benchmark options, the number of
+    threads defaults to the number of processors */
+    int index;
+    char *file_path = NULL;
+    size_t scripts = BENCH_SCRIPTS;
+    unsigned char cached = TRUE;
+    unsigned char multiplex = FALSE;
+#ifndef _WIN32
+    size_t threads = (size_t) sysconf(_SC_NPROCESSORS_ONLN);
+#else
+    size_t threads = 1;
+#endif
+
+    /* iterates over the complete set of arguments, flags
+    change the options and any other argument is considered
+    to be the path of the module to be run */
+    for(index = 1; index < argc; index++) {
+        if(strcmp(argv[index], "--threads") == 0 && index + 1 < argc) {
+            threads = (size_t) atoi(argv[++index]);
+        } else if(strcmp(argv[index], "--scripts") == 0 && index + 1 < argc) {
+            scripts = (size_t) atoi(argv[++index]);
+        } else if(strcmp(argv[index], "--no-cache") == 0) {
+            cached = FALSE;
+        } else if(strcmp(argv[index], "--multiplex") == 0) {
+            multiplex = TRUE;
+        } else {
+            file_path = (char *) argv[index];
+        }
+    }
+    if(threads < 1) { threads = 1; }
+
+    /* runs the benchmark and verifies if an error as
+    occurred, if that's the case prints it */
+    return_value = run(file_path, threads, scripts, cached, multiplex);
+    if(IS_ERROR_CODE(return_value)) {
+        V_ERROR_F("Fatal error (%s)\n", (char *) GET_ERROR());
+        RAISE_AGAIN(return_value);
+    }
+
+    /* returns with no error */
+    return 0;
+}
@@ -0,0 +1,375 @@
+/*
+ Mingus Virtual Machine
+ Copyright (c) 2008-2020 Hive Solutions Lda.
+
+ This file is part of Mingus Virtual Machine.
+
+ Mingus Virtual Machine is free software: you can redistribute it and/or modify
+ it under the terms of the Apache License as published by the Apache
+ Foundation, either version 2.0 of the License, or (at your option) any
+ later version.
+
+ Mingus Virtual Machine is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ Apache License for more details.
+
+ You should have received a copy of the Apache License along with
+ Mingus Virtual Machine. If not, see <http://www.apache.org/licenses/>.
+
+ __author__    = João Magalhães <joamag@hive.pt>
+ __version__   = 1.0.0
+ __revision__  = $LastChangedRevision$
+ __date__      = $LastChangedDate$
+ __copyright__ = Copyright (c) 2008-2020 João Magalhães
+ __license__   = Apache License, Version 2.0
+*/
+
+#include "stdafx.h"
+
+/* starts the memory structures */
+START_MEMORY;
+
+/**
+ * The default number of (measured) runs of each
+ * command of the benchmark suite.
+ */
+#define HARNESS_RUNS 5
+
+/**
+ * The maximum length of the paths (commands and
+ * object files) used by the harness.
+ */
+#define HARNESS_PATH_SIZE 1024
+
+/**
+ * Structure describing the statistical summary of the
+ * repeated runs of a command, the times in seconds and
+ * the peak resident set size (the largest of the runs).
+ */
+typedef struct harness_stats_t {
+    double minimum;
+    double median;
+    double mean;
+    double deviation;
+    long rss;
+} harness_stats;
+
+/**
+ * Structure describing a build under measurement, the
+ * paths to its virtual machine and to its assembler.
+ */
+typedef struct harness_build_t {
+    /**
+     * The name of the build, used in the report and in the
+     * name of the object files assembled by the build.
+     */
+    char *name;
+
+    /**
+     * The paths to the virtual machine and to the
+     * assembler executables of the build.
+     */
+    char vm[HARNESS_PATH_SIZE];
+    char assembler[HARNESS_PATH_SIZE];
+
+    /**
+     * The statistics of the last workload, for both the
+     * assembler and the virtual machine runs.
+     */
+    struct harness_stats_t assemble;
+    struct harness_stats_t run;
+} harness_build;
+
+static int compare_times(const void *first, const void *second) {
+    double first_time = *((double *) first);
+    double second_time = *((double *) second);
+    if(first_time == second_time) { return 0; }
+    return first_time < second_time ? -1 : 1;
+}
+
+ERROR_CODE harness_command(char **arguments, double *elapsed, long *rss, unsigned long long *steps) {
+    /* allocates space for the identifier of the child process,
+    for its status and resource usage and for the start time */
+    pid_t pid;
+    int status;
+    int descriptor;
+    struct rusage usage;
+    unsigned long long start;
+
+    /* allocates space for the pipe of the error output of the
+    child (in case its steps are requested) and for its contents */
+    int pipes[2];
+    char buffer[256];
+    char discard[256];
+    size_t size = 0;
+    ssize_t count;
+
+    /* forks the process running the command in the child with
+    its outputs discarded, so that only the command is measured,
+    the error output is kept in case the child reports the number
+    of operations it dispatched (during the measured run) */
+    if(steps != NULL && pipe(pipes) != 0) {
+        RAISE_ERROR_M(RUNTIME_EXCEPTION_ERROR_CODE, (unsigned char *) "Problem creating pipe");
+    }
+    start = mingus_time();
+    pid = fork();
+    if(pid < 0) {
+        if(steps != NULL) { close(pipes[0]); close(pipes[1]); }
+        RAISE_ERROR_M(RUNTIME_EXCEPTION_ERROR_CODE, (unsigned char *) "Problem forking process");
+    }
+    if(pid == 0) {
+        descriptor = open("/dev/null", O_WRONLY);
+        dup2(descriptor, 1);
+        dup2(steps != NULL ? pipes[1] : descriptor, 2);
+        if(steps != NULL) { close(pipes[0]); close(pipes[1]); }
+        execv(arguments[0], arguments);
+        _exit(127);
+    }
+
+    /* reads the error output of the child (until it's closed) so
+    that the child never blocks on it, only its start is kept */
+    if(steps != NULL) {
+        close(pipes[1]);
+        while(TRUE) {
+            if(size < sizeof(buffer) - 1) { count = read(pipes[0], buffer + size, sizeof(buffer) - 1 - size); }
+            else { count = read(pipes[0], discard, sizeof(discard)); }
+            if(count < 0 && errno == EINTR) { continue; }
+            if(count <= 0) { break; }
+            if(size < sizeof(buffer) - 1) { size += (size_t) count; }
+        }
+        close(pipes[0]);
+        buffer[size] = '\0';
+    }
+
+    /* waits for the child process retrieving its resource usage
+    (peak resident set size) and the elapsed (wall clock) time */
+    if(wait4(pid, &status, 0, &usage) < 0) {
+        RAISE_ERROR_M(RUNTIME_EXCEPTION_ERROR_CODE, (unsigned char *) "Problem waiting process");
+    }
+    *elapsed = (double) (mingus_time() - start) / 1e9;
+    *rss = usage.ru_maxrss;
+    if(!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Command %s failed",
+            arguments[0]
+        );
+    }
+    if(steps != NULL && sscanf(buffer, "Dispatched %llu operations", steps) != 1) {
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Command %s reported no steps",
+            arguments[0]
+        );
+    }
+
+    /* returns with no error */
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE harness_measure(char **arguments, size_t runs, struct harness_stats_t *stats, unsigned long long *steps) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value = 0;
+
+    /* allocates space for the index of the run, for the
+    times of the runs and for the values of a single run */
+    size_t index;
+    double *times;
+    double elapsed;
+    long rss;
+
+    /* runs the command once (warm up) and then the requested
+    number of times storing the time of each of the runs, the
+    steps (if requested) are the ones of the measured runs */
+    times = (double *) MALLOC(runs * sizeof(double));
+    stats->rss = 0;
+    return_value = harness_command(arguments, &elapsed, &rss, NULL);
+    for(index = 0; index < runs && !IS_ERROR_CODE(return_value); index++) {
+        return_value = harness_command(arguments, &times[index], &rss, steps);
+        if(rss > stats->rss) { stats->rss = rss; }
+    }
+    if(IS_ERROR_CODE(return_value)) { FREE(times); RAISE_AGAIN(return_value); }
+
+    /* computes the summary of the runs, the median is the
+    reference value as it's the most robust to outliers */
+    qsort(times, runs, sizeof(double), compare_times);
+    stats->minimum = times[0];
+    stats->median = runs % 2 ? times[runs / 2] : (times[runs / 2 - 1] + times[runs / 2]) / 2.0;
+    stats->mean = 0.0;
+    for(index = 0; index < runs; index++) { stats->mean += times[index]; }
+    stats->mean /= (double) runs;
+    stats->deviation = 0.0;
+    for(index = 0; index < runs; index++) {
+        stats->deviation += (times[index] - stats->mean) * (times[index] - stats->mean);
+    }
+    stats->deviation = runs > 1 ? sqrt(stats->deviation / (double) (runs - 1)) : 0.0;
+    FREE(times);
+    RAISE_NO_ERROR;
+}
+
+ERROR_CODE harness_workload(char *path, char *output, struct harness_build_t *builds, size_t count, size_t runs, char vm) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* allocates space for the index of the build, for the name
+    of the workload, for the path of the object file and for
+    the arguments of the commands */
+    size_t index;
+    char name[256];
+    char object[HARNESS_PATH_SIZE + 512];
+    char *arguments[5];
+    char *pointer;
+    struct stat status;
+    struct harness_build_t *build;
+    unsigned long long instructions = 0;
+    double size;
+
+    /* retrieves the name of the workload, the base name
+    of its path without the extension */
+    pointer = strrchr(path, '/');
+    SPRINTF(name, sizeof(name), "%s", pointer == NULL ? path : pointer + 1);
+    pointer = strrchr(name, '.');
+    if(pointer != NULL) { *pointer = '\0'; }
+    if(stat(path, &status) != 0) {
+        RAISE_ERROR_F(RUNTIME_EXCEPTION_ERROR_CODE, (unsigned char *) "Problem accessing file %s", path);
+    }
+    size = (double) status.st_size;
+
+    /* assembles and runs the workload with each of the builds,
+    each build uses its own object file as the object format
+    may differ between builds, the instructions are the ones
+    dispatched by the measured runs of the first (current) build
+    (the other builds may not be able to report them) */
+    for(index = 0; index < count; index++) {
+        build = &builds[index];
+        SPRINTF(object, sizeof(object), "%s/%s.%s.mic", output, name, build->name);
+        arguments[0] = build->assembler;
+        arguments[1] = path;
+        arguments[2] = object;
+        arguments[3] = NULL;
+        return_value = harness_measure(arguments, runs, &build->assemble, NULL);
+        if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+        if(!vm) { continue; }
+        arguments[0] = build->vm;
+        arguments[1] = index == 0 ? "--steps" : object;
+        arguments[2] = index == 0 ? object : NULL;
+        arguments[3] = NULL;
+        return_value = harness_measure(arguments, runs, &build->run, index == 0 ? &instructions : NULL);
+        if(IS_ERROR_CODE(return_value)) { RAISE_AGAIN(return_value); }
+    }
+
+    /* prints the report of the workload, a line per build for
+    the virtual machine and another for the assembler, the
+    other builds are compared against the first one (the ratio
+    of the medians, above one meaning the first is faster) */
+    if(vm) {
+        PRINTF_F(
+            "%s (%llu instructions, %.0f bytes, %lu runs)\n",
+            name, instructions, size, (unsigned long) runs
+        );
+    } else {
+        PRINTF_F("%s (%.0f bytes, %lu runs)\n", name, size, (unsigned long) runs);
+    }
+    for(index = 0; index < count && vm; index++) {
+        build = &builds[index];
+        PRINTF_F(
+            "  vm  %-8s %10.3f ms %10.3f min %10.3f mean %6.2f%% dev %9.2f Minst/s %7.2f ns/dispatch %8ld KiB",
+            build->name,
+            1e3 * build->run.median,
+            1e3 * build->run.minimum,
+            1e3 * build->run.mean,
+            100.0 * build->run.deviation / build->run.mean,
+            (double) instructions / build->run.median / 1e6,
+            1e9 * build->run.median / (double) (instructions ? instructions : 1),
+            build->run.rss
+        );
+        if(index > 0) { PRINTF_F(" %6.2fx", build->run.median / builds[0].run.median); }
+        PRINTF_F("%s", "\n");
+    }
+    for(index = 0; index < count; index++) {
+        build = &builds[index];
+        PRINTF_F(
+            "  asm %-8s %10.3f ms %10.3f min %10.3f mean %6.2f%% dev %9.2f MB/s %8ld KiB",
+            build->name,
+            1e3 * build->assemble.median,
+            1e3 * build->assemble.minimum,
+            1e3 * build->assemble.mean,
+            100.0 * build->assemble.deviation / build->assemble.mean,
+            size / build->assemble.median / 1e6,
+            build->assemble.rss
+        );
+        if(index > 0) { PRINTF_F(" %6.2fx", build->assemble.median / builds[0].assemble.median); }
+        PRINTF_F("%s", "\n");
+    }
+
+    /* flushes the report so that the progress of the suite
+    is visible and returns with no error */
+    fflush(stdout);
+    RAISE_NO_ERROR;
+}
+
+int main(int argc, const char *argv[]) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* allocates space for the index of the argument being
+    parsed, for the builds being measured, the current one
+    and optionally a baseline, and for the harness options */
+    int index;
+    size_t failures = 0;
+    size_t count = 1;
+    size_t runs = HARNESS_RUNS;
+    char *output = ".";
+    char vm = TRUE;
+    struct harness_build_t builds[2];
+
+    /* populates the current build, by default the executables
+    in the current directory */
+    builds[0].name = "current";
+    SPRINTF(builds[0].vm, HARNESS_PATH_SIZE, "%s", "./mingus");
+    SPRINTF(builds[0].assembler, HARNESS_PATH_SIZE, "%s", "./mingusa");
+    builds[1].name = "baseline";
+
+    /* iterates over the complete set of arguments, flags
+    change the options and any other argument is considered
+    to be the path of a workload, run once the previous
+    arguments have been parsed */
+    for(index = 1; index < argc; index++) {
+        if(strcmp(argv[index], "--runs") == 0 && index + 1 < argc) {
+            runs = (size_t) atoi(argv[++index]);
+            if(runs < 1) { runs = 1; }
+        } else if(strcmp(argv[index], "--vm") == 0 && index + 1 < argc) {
+            SPRINTF(builds[0].vm, HARNESS_PATH_SIZE, "%s", argv[++index]);
+        } else if(strcmp(argv[index], "--assembler") == 0 && index + 1 < argc) {
+            SPRINTF(builds[0].assembler, HARNESS_PATH_SIZE, "%s", argv[++index]);
+        } else if(strcmp(argv[index], "--baseline") == 0 && index + 1 < argc) {
+            SPRINTF(builds[1].vm, HARNESS_PATH_SIZE, "%s/mingus", argv[++index]);
+            SPRINTF(builds[1].assembler, HARNESS_PATH_SIZE, "%s/mingusa", argv[index]);
+            count = 2;
+        } else if(strcmp(argv[index], "--output") == 0 && index + 1 < argc) {
+            output = (char *) argv[++index];
+        } else if(strcmp(argv[index], "--no-vm") == 0) {
+            vm = FALSE;
+        } else {
+            return_value = harness_workload((char *) argv[index], output, builds, count, runs, vm);
+            if(IS_ERROR_CODE(return_value)) {
+                V_ERROR_F("Workload %s failed (%s)\n", argv[index], (char *) GET_ERROR());
+                failures++;
+            }
+        }
+    }
+
+    /* in case any of the workloads failed prints an error
+    and returns with the error code */
+    if(failures > 0) {
+        V_ERROR_F("Fatal error (%lu workloads failed)\n", (unsigned long) failures);
+        return 1;
+    }
+
+    /* returns with no error */
+    return 0;
+}
@@ -0,0 +1,135 @@
+/*
+ Mingus Virtual Machine
+ Copyright (c) 2008-2020 Hive Solutions Lda.
+
+ This file is part of Mingus Virtual Machine.
+
+ Mingus Virtual Machine is free software: you can redistribute it and/or modify
+ it under the terms of the Apache License as published by the Apache
+ Foundation, either version 2.0 of the License, or (at your option) any
+ later version.
+
+ Mingus Virtual Machine is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ Apache License for more details.
+
+ You should have received a copy of the Apache License along with
+ Mingus Virtual Machine. If not, see <http://www.apache.org/licenses/>.
+
+ __author__    = João Magalhães <joamag@hive.pt>
+ __version__   = 1.0.0
+ __revision__  = $LastChangedRevision$
+ __date__      = $LastChangedDate$
+ __copyright__ = Copyright (c) 2008-2020 João Magalhães
+ __license__   = Apache License, Version 2.0
+*/
+
+#include "stdafx.h"
+
+/* starts the memory structures */
+START_MEMORY;
+
+/**
+ * The names of the operations (including the
+ * superinstructions) indexed by their opcode.
+ */
+const char *names[MINGUS_OPERATION_COUNT] = MINGUS_OPERATION_NAMES;
+
+ERROR_CODE run(char *file_path) {
+    /* allocates space for the header of the trace file and
+    for the record that is going to be decoded in each step */
+    struct trace_header_t header;
+    struct trace_record_t record;
+
+    /* allocates space for the index of the record and for
+    the sequence number of the first record in the file */
+    unsigned int index;
+    unsigned long long sequence;
+
+    /* allocates space for the name of the opcode */
+    const char *name;
+
+    /* allocates space for the trace file to be decoded */
+    FILE *file;
+
+    /* in case the provided file path is not valid raises
+    and error indicating the problem */
+    if(file_path == NULL) {
+        RAISE_ERROR_M(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "No input file"
+        );
+    }
+
+    /* opens the trace file and reads its header, verifying
+    that the magic and the version are the expected ones */
+    FOPEN(&file, file_path, "rb");
+    if(file == NULL) {
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Problem opening file %s",
+            file_path
+        );
+    }
+    if(fread(&header, sizeof(struct trace_header_t), 1, file) != 1 ||
+        memcmp(header.magic, "MTRC", 4) != 0 ||
+        header.version != MINGUS_TRACE_VERSION ||
+        header.record_size != sizeof(struct trace_record_t)) {
+        fclose(file);
+        RAISE_ERROR_F(
+            RUNTIME_EXCEPTION_ERROR_CODE,
+            (unsigned char *) "Invalid trace file %s",
+            file_path
+        );
+    }
+
+    /* prints a summary of the trace, notice that only the latest
+    records are kept in the file (ring buffer) */
+    PRINTF_F("Trace with %u of %llu records\n", header.count, header.total);
+    sequence = header.total - header.count;
+
+    /* iterates over the complete set of records in the file
+    printing a human readable line for each of them */
+    for(index = 0; index < header.count; index++) {
+        if(fread(&record, sizeof(struct trace_record_t), 1, file) != 1) { break; }
+        name = record.opcode < MINGUS_OPERATION_COUNT ? names[record.opcode] : "unknown";
+        PRINTF_F(
+            "%10llu %08x %-10s %3u %11d so=%u top=%08x\n",
+            sequence + index,
+            record.pc,
+            name,
+            (unsigned int) record.arg1,
+            record.operand,
+            (unsigned int) record.so,
+            record.top
+        );
+    }
+
+    /* closes the trace file and
+    returns with no error */
+    fclose(file);
+    RAISE_NO_ERROR;
+}
+
+int main(int argc, const char *argv[]) {
+    /* allocates the value to be used to verify the
+    existence of error from the function */
+    ERROR_CODE return_value;
+
+    /* allocates and starts the pointer to the path
+    of the trace file to be decoded */
+    char *file_path = NULL;
+    if(argc > 1) { file_path = (char *) argv[1]; }
+
+    /* decodes the trace file and verifies if an error
+    as occurred, if that's the case prints it */
+    return_value = run(file_path);
+    if(IS_ERROR_CODE(return_value)) {
+        V_ERROR_F("Fatal error (%s)\n", (char *) GET_ERROR());
+        RAISE_AGAIN(return_value);
+    }
+
+    /* returns with no error */
+    return 0;
+}